@@ -0,0 +1,156 @@
+/* Cooperative Async Executor (Stackless Coroutines) */
+
+#include <stdint.h>
+#include "async.h"
+#include "timer.h"
+#include "atomic.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+// Run list of the executing core; tasks are spawned and stepped there only
+static async_task_t *run_head;
+static async_task_t *run_tail;
+
+static inline void send_event(void) {
+    __asm__ volatile("dsb ish\n\tsev" : : : "memory");
+}
+
+static inline void wait_event(void) {
+    __asm__ volatile("wfe" : : : "memory");
+}
+
+void async_event_init(async_event_t *event) {
+    event->status = 0;
+    event->signalled = 0;
+}
+
+void async_event_signal(async_event_t *event, int status) {
+    event->status = status;
+    atomic_store_32(&event->signalled, 1, ATOMIC_RELEASE);
+    // SEV also sets our own event register, so an executor that checked
+    // just before an IRQ signalled it does not sleep through the wakeup
+    send_event();
+}
+
+static void timer_fired(void *arg) {
+    async_event_signal((async_event_t *)arg, 0);
+}
+
+void async_timer_start(async_timer_t *timer, uint64_t microseconds) {
+    async_event_init(&timer->done);
+    timer_event_init(&timer->timer, timer_fired, &timer->done);
+
+    timer->deadline_us = timer_get_ticks() + microseconds;
+    timer->polled = timer_event_schedule(&timer->timer, microseconds) != 0;
+}
+
+int async_timer_expired(async_timer_t *timer) {
+    if (timer->polled) {
+        return timer_get_ticks() >= timer->deadline_us;
+    }
+    return async_event_ready(&timer->done);
+}
+
+int async_timer_wait_hint(const async_timer_t *timer) {
+    return timer->polled ? ASYNC_YIELD : ASYNC_PENDING;
+}
+
+static int offload_entry(void *arg) {
+    async_offload_t *work = (async_offload_t *)arg;
+    int result = work->fn(work->arg);
+
+    async_event_signal(&work->done, result);
+    return result;
+}
+
+int async_offload(async_offload_t *work, sched_fn_t fn, void *arg) {
+    if (!work || !fn) return -1;
+
+    work->fn = fn;
+    work->arg = arg;
+    async_event_init(&work->done);
+
+    return sched_spawn(&work->job, offload_entry, work);
+}
+
+void async_spawn(async_task_t *task, async_fn_t fn, void *arg) {
+    if (!task || !fn) return;
+
+    task->fn = fn;
+    task->arg = arg;
+    task->resume = 0;
+    task->result = 0;
+    task->state = ASYNC_TASK_QUEUED;
+    task->next = NULL;
+
+    if (run_tail) {
+        run_tail->next = task;
+    } else {
+        run_head = task;
+    }
+    run_tail = task;
+}
+
+int async_task_done(const async_task_t *task) {
+    return task->state == ASYNC_TASK_DONE;
+}
+
+// Step every queued task once; returns 1 if any of them can run again
+// without waiting for an event
+static int run_pass(void) {
+    async_task_t *prev = NULL;
+    async_task_t *task = run_head;
+    int runnable = 0;
+
+    while (task) {
+        async_task_t *next = task->next;
+        int rc = task->fn(task);
+
+        if (rc == ASYNC_DONE) {
+            // Unlink; the slot may be reused by the owner straight away
+            if (prev) {
+                prev->next = next;
+            } else {
+                run_head = next;
+            }
+            if (run_tail == task) run_tail = prev;
+            task->next = NULL;
+            task->state = ASYNC_TASK_DONE;
+        } else {
+            if (rc == ASYNC_YIELD) runnable = 1;
+            prev = task;
+        }
+        task = next;
+    }
+
+    return runnable;
+}
+
+// Blocking work offloaded to the scheduler must make progress even when
+// no secondary core is online, so every pass also helps run one job
+static void step(int runnable) {
+    if (sched_run_one()) return;
+    if (!runnable) wait_event();
+}
+
+int async_run_until(async_task_t *task) {
+    if (!task) return -1;
+
+    while (task->state == ASYNC_TASK_QUEUED) {
+        int runnable = run_pass();
+        if (task->state != ASYNC_TASK_QUEUED) break;
+        step(runnable);
+    }
+
+    return task->result;
+}
+
+void async_run_all(void) {
+    while (run_head) {
+        int runnable = run_pass();
+        if (!run_head) break;
+        step(runnable);
+    }
+}
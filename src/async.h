@@ -0,0 +1,131 @@
+/* Cooperative Async Executor (Stackless Coroutines) */
+
+#ifndef ASYNC_H
+#define ASYNC_H
+
+#include <stdint.h>
+#include "sched.h"
+#include "timer_queue.h"
+
+// Task step results
+#define ASYNC_PENDING   0       // Waiting on an event: the executor may sleep
+#define ASYNC_YIELD     1       // Still runnable (polling hardware)
+#define ASYNC_DONE      2
+
+// Completion - signalled once by an IRQ handler, another core or a task
+typedef struct {
+    volatile uint32_t signalled;
+    volatile int status;
+} async_event_t;
+
+typedef struct async_task async_task_t;
+
+// One step of a coroutine. Locals do not survive a wait: keep state in
+// the structure passed as arg
+typedef int (*async_fn_t)(async_task_t *task);
+
+struct async_task {
+    async_fn_t fn;
+    void *arg;
+    uint32_t resume;                // Line to continue at (0 = start)
+    volatile uint32_t state;
+    int result;
+    async_task_t *next;             // Executor run list
+};
+
+// Task states
+#define ASYNC_TASK_IDLE     0
+#define ASYNC_TASK_QUEUED   1
+#define ASYNC_TASK_DONE     2
+
+/*
+ * Coroutine body helpers (protothread style):
+ *
+ *   static int step(async_task_t *t) {
+ *       ASYNC_BEGIN(t);
+ *       start_io(&st->done);
+ *       ASYNC_AWAIT_EVENT(t, &st->done);
+ *       ASYNC_END(t);
+ *   }
+ *
+ * A wait may not sit inside a switch of the coroutine body itself.
+ */
+#define ASYNC_BEGIN(t)          switch ((t)->resume) { case 0:
+
+#define ASYNC_WAIT_UNTIL(t, cond, rc)                   \
+    do {                                                \
+        (t)->resume = __LINE__;                         \
+        /* fall through */                              \
+        case __LINE__:                                  \
+        if (!(cond)) return (rc);                       \
+    } while (0)
+
+// Block until cond holds; something must raise an event (IRQ, SEV) to wake us
+#define ASYNC_AWAIT(t, cond)        ASYNC_WAIT_UNTIL(t, cond, ASYNC_PENDING)
+#define ASYNC_AWAIT_EVENT(t, ev)    ASYNC_AWAIT(t, async_event_ready(ev))
+
+// Re-check cond every pass; for sources that raise no interrupt
+#define ASYNC_POLL(t, cond)         ASYNC_WAIT_UNTIL(t, cond, ASYNC_YIELD)
+
+#define ASYNC_YIELD_NOW(t)                              \
+    do {                                                \
+        (t)->resume = __LINE__;                         \
+        return ASYNC_YIELD;                             \
+        case __LINE__:;                                 \
+    } while (0)
+
+// Sleep on the timer queue (polls the clock if the queue is unavailable)
+#define ASYNC_SLEEP_US(t, timer, us)                    \
+    do {                                                \
+        async_timer_start((timer), (us));               \
+        ASYNC_WAIT_UNTIL(t, async_timer_expired(timer), \
+                         async_timer_wait_hint(timer)); \
+    } while (0)
+
+#define ASYNC_RETURN(t, value)                          \
+    do {                                                \
+        (t)->result = (value);                          \
+        return ASYNC_DONE;                              \
+    } while (0)
+
+#define ASYNC_END(t)            } return ASYNC_DONE
+
+// Completions
+void async_event_init(async_event_t *event);
+void async_event_signal(async_event_t *event, int status);
+
+static inline int async_event_ready(const async_event_t *event) {
+    return event->signalled;
+}
+
+// Timer completion backed by the timer queue
+typedef struct {
+    timer_event_t timer;
+    async_event_t done;
+    uint64_t deadline_us;           // Used when the queue is unavailable
+    uint32_t polled;
+} async_timer_t;
+
+void async_timer_start(async_timer_t *timer, uint64_t microseconds);
+int async_timer_expired(async_timer_t *timer);
+int async_timer_wait_hint(const async_timer_t *timer);
+
+// Run a blocking function (SD, FAT, ...) on the work-stealing scheduler
+// and complete 'done' with its return value
+typedef struct {
+    sched_task_t job;
+    sched_fn_t fn;
+    void *arg;
+    async_event_t done;
+} async_offload_t;
+
+int async_offload(async_offload_t *work, sched_fn_t fn, void *arg);
+
+// Executor - runs on the calling core; idle time helps the scheduler
+// and otherwise sleeps in WFE until an interrupt or event
+void async_spawn(async_task_t *task, async_fn_t fn, void *arg);
+int async_run_until(async_task_t *task);    // Returns the task's result
+void async_run_all(void);
+int async_task_done(const async_task_t *task);
+
+#endif
@@ -0,0 +1,268 @@
+/* ARMv8 Atomic Operations (LSE with LL/SC fallback) */
+
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#include <stdint.h>
+
+// Memory ordering for every operation below. Read-modify-write operations
+// treat ATOMIC_SEQ_CST as ATOMIC_ACQ_REL: ARMv8 acquire/release accesses are
+// already sequentially consistent with each other.
+#define ATOMIC_RELAXED  0
+#define ATOMIC_ACQUIRE  1
+#define ATOMIC_RELEASE  2
+#define ATOMIC_ACQ_REL  3
+#define ATOMIC_SEQ_CST  4
+
+// LSE (ARMv8.1 CAS/LDADD/SWP) is used when the compiler targets it, e.g.
+// 'make LSE=1' for Cortex-A76 (Pi 5); otherwise exclusive load/store loops
+// run on every ARMv8.0 core (Cortex-A53/A72)
+#if defined(__ARM_FEATURE_ATOMICS)
+#define ATOMIC_HAVE_LSE 1
+#else
+#define ATOMIC_HAVE_LSE 0
+#endif
+
+// Runtime check (ID_AA64ISAR0_EL1.Atomic) - an LSE build must not run on a
+// core that lacks it; main() checks before anything else runs
+static inline int atomic_cpu_has_lse(void) {
+    uint64_t isar0;
+    __asm__ volatile("mrs %0, id_aa64isar0_el1" : "=r"(isar0));
+    return ((isar0 >> 20) & 0xF) >= 2;
+}
+
+// Barriers
+static inline void atomic_fence(int order) {
+    if (order == ATOMIC_RELAXED) {
+        __asm__ volatile("" : : : "memory");
+    } else if (order == ATOMIC_ACQUIRE) {
+        __asm__ volatile("dmb ishld" : : : "memory");
+    } else {
+        __asm__ volatile("dmb ish" : : : "memory");
+    }
+}
+
+static inline void cpu_relax(void) {
+    __asm__ volatile("yield" : : : "memory");
+}
+
+// Sleep until another core signals (SEV) or an interrupt arrives
+static inline void cpu_wait_event(void) {
+    __asm__ volatile("wfe" : : : "memory");
+}
+
+/*
+ * Primitive generators. Each expands to four ordering variants:
+ * _relaxed, _acquire, _release, _acq_rel.
+ */
+
+#if ATOMIC_HAVE_LSE
+
+// LDADD/LDSET/LDCLR/SWP: old = *p; *p = op(*p, v)
+#define ATOMIC_RMW_ORDER(op, sz, w, sfx, lse, ld, st)                              \
+static inline uint##sz##_t __arch_atomic_##op##_##sz##sfx(volatile uint##sz##_t *p, \
+                                                     uint##sz##_t v) {             \
+    uint##sz##_t old;                                                              \
+    __asm__ volatile(lse " %" w "[v], %" w "[old], %[mem]"                         \
+                     : [old] "=r"(old), [mem] "+Q"(*p)                             \
+                     : [v] "r"(v)                                                  \
+                     : "memory");                                                  \
+    return old;                                                                    \
+}
+
+#define ATOMIC_CAS_ORDER(sz, w, sfx, lse, ld, st)                                  \
+static inline uint##sz##_t __arch_atomic_cas_##sz##sfx(volatile uint##sz##_t *p,   \
+                                                  uint##sz##_t expected,           \
+                                                  uint##sz##_t desired) {          \
+    uint##sz##_t old = expected;                                                   \
+    __asm__ volatile(lse " %" w "[old], %" w "[new], %[mem]"                       \
+                     : [old] "+r"(old), [mem] "+Q"(*p)                             \
+                     : [new] "r"(desired)                                          \
+                     : "memory");                                                  \
+    return old;                                                                    \
+}
+
+#define ATOMIC_ADD_INSN(sfx, w)  "ldadd" sfx
+#define ATOMIC_OR_INSN(sfx, w)   "ldset" sfx
+#define ATOMIC_ANDN_INSN(sfx, w) "ldclr" sfx
+#define ATOMIC_XCHG_INSN(sfx, w) "swp" sfx
+#define ATOMIC_CAS_INSN(sfx, w)  "cas" sfx
+
+#else
+
+// Exclusive monitor loop: retry until the store-exclusive succeeds
+#define ATOMIC_RMW_ORDER(op, sz, w, sfx, insn, ld, st)                             \
+static inline uint##sz##_t __arch_atomic_##op##_##sz##sfx(volatile uint##sz##_t *p, \
+                                                     uint##sz##_t v) {             \
+    uint##sz##_t old, tmp;                                                         \
+    uint32_t fail;                                                                 \
+    __asm__ volatile("1: " ld " %" w "[old], %[mem]\n\t"                           \
+                     insn "\n\t"                                                   \
+                     st " %w[fail], %" w "[tmp], %[mem]\n\t"                       \
+                     "cbnz %w[fail], 1b"                                           \
+                     : [old] "=&r"(old), [tmp] "=&r"(tmp),                         \
+                       [fail] "=&r"(fail), [mem] "+Q"(*p)                          \
+                     : [v] "r"(v)                                                  \
+                     : "memory");                                                  \
+    return old;                                                                    \
+}
+
+#define ATOMIC_CAS_ORDER(sz, w, sfx, insn, ld, st)                                 \
+static inline uint##sz##_t __arch_atomic_cas_##sz##sfx(volatile uint##sz##_t *p,   \
+                                                  uint##sz##_t expected,           \
+                                                  uint##sz##_t desired) {          \
+    uint##sz##_t old;                                                              \
+    uint32_t fail;                                                                 \
+    __asm__ volatile("1: " ld " %" w "[old], %[mem]\n\t"                           \
+                     "cmp %" w "[old], %" w "[exp]\n\t"                            \
+                     "b.ne 2f\n\t"                                                 \
+                     st " %w[fail], %" w "[new], %[mem]\n\t"                       \
+                     "cbnz %w[fail], 1b\n"                                         \
+                     "2:"                                                          \
+                     : [old] "=&r"(old), [fail] "=&r"(fail), [mem] "+Q"(*p)        \
+                     : [exp] "r"(expected), [new] "r"(desired)                     \
+                     : "cc", "memory");                                            \
+    return old;                                                                    \
+}
+
+// The ALU step between the exclusive load and store (old -> tmp)
+#define ATOMIC_ADD_INSN(sfx, w)  "add %" w "[tmp], %" w "[old], %" w "[v]"
+#define ATOMIC_OR_INSN(sfx, w)   "orr %" w "[tmp], %" w "[old], %" w "[v]"
+#define ATOMIC_ANDN_INSN(sfx, w) "bic %" w "[tmp], %" w "[old], %" w "[v]"
+#define ATOMIC_XCHG_INSN(sfx, w) "mov %" w "[tmp], %" w "[v]"
+#define ATOMIC_CAS_INSN(sfx, w)  ""
+
+#endif
+
+// Expand one operation in all four orderings at one width
+#define ATOMIC_RMW_ALL(op, sz, w, INSN)                                        \
+    ATOMIC_RMW_ORDER(op, sz, w, _relaxed, INSN("", w),   "ldxr",  "stxr")          \
+    ATOMIC_RMW_ORDER(op, sz, w, _acquire, INSN("a", w),  "ldaxr", "stxr")          \
+    ATOMIC_RMW_ORDER(op, sz, w, _release, INSN("l", w),  "ldxr",  "stlxr")         \
+    ATOMIC_RMW_ORDER(op, sz, w, _acq_rel, INSN("al", w), "ldaxr", "stlxr")
+
+#define ATOMIC_CAS_ALL(sz, w)                                                      \
+    ATOMIC_CAS_ORDER(sz, w, _relaxed, ATOMIC_CAS_INSN("", w),   "ldxr",  "stxr")   \
+    ATOMIC_CAS_ORDER(sz, w, _acquire, ATOMIC_CAS_INSN("a", w),  "ldaxr", "stxr")   \
+    ATOMIC_CAS_ORDER(sz, w, _release, ATOMIC_CAS_INSN("l", w),  "ldxr",  "stlxr")  \
+    ATOMIC_CAS_ORDER(sz, w, _acq_rel, ATOMIC_CAS_INSN("al", w), "ldaxr", "stlxr")
+
+ATOMIC_RMW_ALL(add, 32, "w", ATOMIC_ADD_INSN)
+ATOMIC_RMW_ALL(or, 32, "w", ATOMIC_OR_INSN)
+ATOMIC_RMW_ALL(andn, 32, "w", ATOMIC_ANDN_INSN)
+ATOMIC_RMW_ALL(xchg, 32, "w", ATOMIC_XCHG_INSN)
+ATOMIC_CAS_ALL(32, "w")
+
+ATOMIC_RMW_ALL(add, 64, "x", ATOMIC_ADD_INSN)
+ATOMIC_RMW_ALL(or, 64, "x", ATOMIC_OR_INSN)
+ATOMIC_RMW_ALL(andn, 64, "x", ATOMIC_ANDN_INSN)
+ATOMIC_RMW_ALL(xchg, 64, "x", ATOMIC_XCHG_INSN)
+ATOMIC_CAS_ALL(64, "x")
+
+// Pick the ordering variant; 'order' is a constant at every call site, so
+// the switch folds away
+#define ATOMIC_DISPATCH(fn, order, ...)                                            \
+    switch (order) {                                                               \
+        case ATOMIC_RELAXED: return fn##_relaxed(__VA_ARGS__);                     \
+        case ATOMIC_ACQUIRE: return fn##_acquire(__VA_ARGS__);                     \
+        case ATOMIC_RELEASE: return fn##_release(__VA_ARGS__);                     \
+        default:             return fn##_acq_rel(__VA_ARGS__);                     \
+    }
+
+/*
+ * Public API
+ */
+
+// Loads and stores (LDAR/STLR for acquire/release, plain access otherwise)
+static inline uint32_t atomic_load_32(const volatile uint32_t *p, int order) {
+    uint32_t v;
+    if (order == ATOMIC_RELAXED) return *p;
+    __asm__ volatile("ldar %w0, %1" : "=r"(v) : "Q"(*p) : "memory");
+    return v;
+}
+
+static inline uint64_t atomic_load_64(const volatile uint64_t *p, int order) {
+    uint64_t v;
+    if (order == ATOMIC_RELAXED) return *p;
+    __asm__ volatile("ldar %0, %1" : "=r"(v) : "Q"(*p) : "memory");
+    return v;
+}
+
+static inline void atomic_store_32(volatile uint32_t *p, uint32_t v, int order) {
+    if (order == ATOMIC_RELAXED) {
+        *p = v;
+        return;
+    }
+    __asm__ volatile("stlr %w1, %0" : "=Q"(*p) : "r"(v) : "memory");
+}
+
+static inline void atomic_store_64(volatile uint64_t *p, uint64_t v, int order) {
+    if (order == ATOMIC_RELAXED) {
+        *p = v;
+        return;
+    }
+    __asm__ volatile("stlr %1, %0" : "=Q"(*p) : "r"(v) : "memory");
+}
+
+// Read-modify-write; all return the previous value
+static inline uint32_t atomic_fetch_add_32(volatile uint32_t *p, uint32_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_add_32, order, p, v)
+}
+
+static inline uint32_t atomic_fetch_sub_32(volatile uint32_t *p, uint32_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_add_32, order, p, (uint32_t)-v)
+}
+
+static inline uint32_t atomic_fetch_or_32(volatile uint32_t *p, uint32_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_or_32, order, p, v)
+}
+
+static inline uint32_t atomic_fetch_and_32(volatile uint32_t *p, uint32_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_andn_32, order, p, ~v)
+}
+
+static inline uint32_t atomic_exchange_32(volatile uint32_t *p, uint32_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_xchg_32, order, p, v)
+}
+
+// Store 'desired' if *p == expected; returns the value observed
+static inline uint32_t atomic_cas_32(volatile uint32_t *p, uint32_t expected,
+                                     uint32_t desired, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_cas_32, order, p, expected, desired)
+}
+
+static inline uint64_t atomic_fetch_add_64(volatile uint64_t *p, uint64_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_add_64, order, p, v)
+}
+
+static inline uint64_t atomic_fetch_sub_64(volatile uint64_t *p, uint64_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_add_64, order, p, (uint64_t)-v)
+}
+
+static inline uint64_t atomic_fetch_or_64(volatile uint64_t *p, uint64_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_or_64, order, p, v)
+}
+
+static inline uint64_t atomic_fetch_and_64(volatile uint64_t *p, uint64_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_andn_64, order, p, ~v)
+}
+
+static inline uint64_t atomic_exchange_64(volatile uint64_t *p, uint64_t v, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_xchg_64, order, p, v)
+}
+
+static inline uint64_t atomic_cas_64(volatile uint64_t *p, uint64_t expected,
+                                     uint64_t desired, int order) {
+    ATOMIC_DISPATCH(__arch_atomic_cas_64, order, p, expected, desired)
+}
+
+// Pointer-sized helpers
+static inline void *atomic_load_ptr(void *const volatile *p, int order) {
+    return (void *)(uintptr_t)atomic_load_64((const volatile uint64_t *)p, order);
+}
+
+static inline void atomic_store_ptr(void *volatile *p, void *v, int order) {
+    atomic_store_64((volatile uint64_t *)p, (uint64_t)(uintptr_t)v, order);
+}
+
+#endif
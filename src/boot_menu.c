@@ -7,6 +7,8 @@
 #include "network.h"
 #include "usb.h"
 #include "mailbox.h"
+#include "driver.h"
+#include "memmap.h"
 
 #ifndef NULL
 #define NULL ((void *)0)
@@ -20,6 +22,8 @@
 #define ANSI_UP         "\x1B[A"
 #define ANSI_DOWN       "\x1B[B"
 
+#define BOOT_MENU_TFTP_MAX  0x1000000   // Largest kernel accepted over TFTP
+
 // Custom string functions
 static uint32_t strlen(const char *s) {
     uint32_t len = 0;
@@ -33,7 +37,8 @@ static void print_spaces(int count) {
 
 // Initialize boot menu
 void boot_menu_init(void) {
-    // Already initialized by uart_init
+    // UART is already up; everything else waits for the chosen boot path.
+    // Drivers register themselves through the driver table (DRIVER_DEFINE)
 }
 
 // Clear screen
@@ -206,8 +211,8 @@ int boot_menu_run(menu_config_t *menu) {
 int boot_menu_action_sd_boot(void *context) {
     uart_puts("\nBooting from SD card...\n");
 
-    // Initialize SD
-    if (sd_init() < 0) {
+    // Bring up SD and FAT only; no PHY or USB link waits on this path
+    if (boot_path_select(BOOT_PATH_SD) != 0) {
         uart_puts("SD card initialization failed\n");
         return -1;
     }
@@ -231,6 +236,7 @@ int boot_menu_action_network_boot(void *context) {
     network_config_t config;
 
     // Initialize network
+    boot_path_select(BOOT_PATH_NETWORK);
     if (network_init() < 0) {
         uart_puts("Network initialization failed\n");
         return -1;
@@ -250,10 +256,17 @@ int boot_menu_action_network_boot(void *context) {
     // Download kernel via TFTP
     uart_puts("Downloading kernel via TFTP...\n");
     uint32_t server_ip = network_ip_to_int(config.boot_server);
-    uint8_t *kernel_buf = (uint8_t *)0x80000;
+    uint64_t kernel_addr;
+
+    if (memmap_alloc(BOOT_MENU_TFTP_MAX, 0x200000, MEMMAP_KERNEL, 0, "tftp", &kernel_addr) != 0) {
+        uart_puts("No memory for the kernel\n");
+        return -1;
+    }
 
-    int size = network_tftp_download(config.boot_filename, server_ip, kernel_buf, 0x1000000);
+    int size = network_tftp_download(config.boot_filename, server_ip,
+                                     (uint8_t *)(uintptr_t)kernel_addr, BOOT_MENU_TFTP_MAX);
     if (size < 0) {
+        memmap_release(kernel_addr);
         uart_puts("TFTP download failed\n");
         return -1;
     }
@@ -265,6 +278,7 @@ int boot_menu_action_network_boot(void *context) {
 int boot_menu_action_usb_boot(void *context) {
     uart_puts("\nBooting from USB...\n");
 
+    boot_path_select(BOOT_PATH_USB);
     if (usb_boot_init() < 0) {
         uart_puts("No USB mass storage device found\n");
         return -1;
@@ -0,0 +1,95 @@
+/* Boot Profile Cache */
+
+#include <stdint.h>
+#include "boot_profile.h"
+#include "config_persist.h"
+#include "boot_source.h"
+#include "mailbox.h"
+#include "sd.h"
+#include "log.h"
+
+static boot_profile_t profile;
+static int profile_valid;
+
+static void copy_bytes(void *dest, const void *src, uint32_t n) {
+    uint8_t *d = dest;
+    const uint8_t *s = src;
+    while (n--) *d++ = *s++;
+}
+
+static void clear_bytes(void *dest, uint32_t n) {
+    uint8_t *d = dest;
+    while (n--) *d++ = 0;
+}
+
+int boot_profile_init(void) {
+    uint32_t revision = mailbox_get_board_revision();
+
+    profile_valid = 0;
+    if (config_persist_get_profile(&profile) == 0 && profile.board_revision == revision) {
+        profile_valid = 1;
+    } else {
+        // Card moved to another board (or first boot): start from scratch
+        clear_bytes(&profile, sizeof(profile));
+        profile.board_revision = revision;
+    }
+
+    // FAT checks and refreshes the volume and extents in place
+    fat_set_cache(&profile.fat);
+
+    if (profile_valid && profile.boot_source[0]) {
+        boot_source_prefer(boot_source_find(profile.boot_source));
+    }
+
+    log_info("PROFILE", profile_valid ? "Boot profile loaded" : "No boot profile, full discovery");
+    return 0;
+}
+
+int boot_profile_valid(void) {
+    return profile_valid;
+}
+
+int boot_profile_commit(const char *boot_source) {
+    uint32_t i = 0;
+
+    if (boot_source) {
+        for (; boot_source[i] && i < sizeof(profile.boot_source) - 1; i++) {
+            profile.boot_source[i] = boot_source[i];
+        }
+    }
+    for (; i < sizeof(profile.boot_source); i++) profile.boot_source[i] = 0;
+
+    return config_persist_set_profile(&profile);
+}
+
+int boot_profile_get_lease(uint8_t ip[4], uint8_t netmask[4], uint8_t gateway[4],
+                           uint8_t server[4], uint32_t *lease_seconds) {
+    if (!profile_valid || profile.lease_seconds == 0) return -1;
+
+    copy_bytes(ip, profile.lease_ip, 4);
+    copy_bytes(netmask, profile.lease_netmask, 4);
+    copy_bytes(gateway, profile.lease_gateway, 4);
+    copy_bytes(server, profile.lease_server, 4);
+    *lease_seconds = profile.lease_seconds;
+    return 0;
+}
+
+void boot_profile_set_lease(const uint8_t ip[4], const uint8_t netmask[4],
+                            const uint8_t gateway[4], const uint8_t server[4],
+                            uint32_t lease_seconds) {
+    copy_bytes(profile.lease_ip, ip, 4);
+    copy_bytes(profile.lease_netmask, netmask, 4);
+    copy_bytes(profile.lease_gateway, gateway, 4);
+    copy_bytes(profile.lease_server, server, 4);
+    profile.lease_seconds = lease_seconds;
+}
+
+int boot_profile_invalidate(void) {
+    uint32_t revision = profile.board_revision;
+
+    clear_bytes(&profile, sizeof(profile));
+    profile.board_revision = revision;
+    profile_valid = 0;
+
+    return config_persist_clear_profile();
+}
@@ -0,0 +1,38 @@
+/* Boot Profile Cache */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+#include "config_persist.h"
+
+/*
+ * Most units boot the same files from the same card every time. The
+ * profile remembers what discovery found (volume, file extents, boot
+ * source, DHCP lease) in the persisted config; the next boot checks each
+ * item with a single read and only rediscovers what changed.
+ */
+
+// Load the profile once the SD card is up and hand it to the FAT layer.
+// A profile from another board revision is dropped. Always returns 0: no
+// profile just means the slow path
+int boot_profile_init(void);
+
+// 1 if a valid profile for this board was found
+int boot_profile_valid(void);
+
+// Record the boot source that delivered the kernel and persist whatever
+// changed (no write at all when nothing did)
+int boot_profile_commit(const char *boot_source);
+
+// DHCP lease from the previous boot; -1 if there is none
+int boot_profile_get_lease(uint8_t ip[4], uint8_t netmask[4], uint8_t gateway[4],
+                           uint8_t server[4], uint32_t *lease_seconds);
+void boot_profile_set_lease(const uint8_t ip[4], const uint8_t netmask[4],
+                            const uint8_t gateway[4], const uint8_t server[4],
+                            uint32_t lease_seconds);
+
+// Forget the profile (next boot takes the slow path)
+int boot_profile_invalidate(void);
+
+#endif
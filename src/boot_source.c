@@ -0,0 +1,155 @@
+/* Boot Source Table */
+
+#include <stdint.h>
+#include "boot_source.h"
+#include "driver.h"
+#include "sched.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+#define BOOT_SOURCE_MAX     32      // Searches track tried sources in a bit mask
+
+LINKER_TABLE_DECLARE(const boot_source_t, boot_sources);
+
+static const boot_source_t *preferred;
+
+// Probes running on the scheduler (boot_source_probe_start), by table index
+static sched_task_t probe_tasks[BOOT_SOURCE_MAX];
+static uint32_t probes_started;
+static volatile uint32_t probes_cancelled;
+
+static int streq(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+uint32_t boot_source_count(void) {
+    return LINKER_TABLE_COUNT(boot_sources);
+}
+
+const boot_source_t *boot_source_get(uint32_t index) {
+    return index < boot_source_count() ? LINKER_TABLE_GET(boot_sources, index) : NULL;
+}
+
+const boot_source_t *boot_source_find(const char *name) {
+    for (uint32_t i = 0; i < boot_source_count(); i++) {
+        const boot_source_t *source = LINKER_TABLE_GET(boot_sources, i);
+        if (streq(source->name, name)) return source;
+    }
+    return NULL;
+}
+
+void boot_source_prefer(const boot_source_t *source) {
+    preferred = source;
+}
+
+// Search order: BOOT_SOURCE_PRIORITY_FIRST, the preferred source, then the
+// lowest priority value
+static uint64_t source_rank(const boot_source_t *source) {
+    uint64_t tier = source->priority == BOOT_SOURCE_PRIORITY_FIRST ? 0 :
+                    source == preferred ? 1 : 2;
+    return (tier << 32) | source->priority;
+}
+
+static int serves_path(const boot_source_t *source) {
+    uint32_t path = boot_path_get();
+    return path == BOOT_PATH_NONE || (source->paths & path);
+}
+
+// Next untried source for the selected path. Probing it is left to the caller
+static const boot_source_t *next_source(uint32_t *tried, uint32_t *index) {
+    const boot_source_t *best = NULL;
+    uint32_t best_index = 0;
+
+    for (uint32_t i = 0; i < boot_source_count() && i < BOOT_SOURCE_MAX; i++) {
+        const boot_source_t *source = LINKER_TABLE_GET(boot_sources, i);
+
+        if (*tried & (1u << i)) continue;
+        if (!serves_path(source)) continue;
+        if (!best || source_rank(source) < source_rank(best)) {
+            best = source;
+            best_index = i;
+        }
+    }
+
+    if (best) {
+        *tried |= 1u << best_index;
+        *index = best_index;
+    }
+    return best;
+}
+
+static int run_probe(void *arg) {
+    const boot_source_t *source = arg;
+    return probes_cancelled ? -1 : source->probe();
+}
+
+int boot_source_probe_start(void) {
+    probes_cancelled = 0;
+
+    for (uint32_t i = 0; i < boot_source_count() && i < BOOT_SOURCE_MAX; i++) {
+        const boot_source_t *source = LINKER_TABLE_GET(boot_sources, i);
+
+        if (!source->probe || !serves_path(source) || (probes_started & (1u << i))) continue;
+        if (sched_spawn(&probe_tasks[i], run_probe, (void *)source) == 0) {
+            probes_started |= 1u << i;
+        }
+    }
+    return 0;
+}
+
+int boot_source_probe_cancelled(void) {
+    return probes_cancelled;
+}
+
+// The result of a probe already running (waiting for it only now, when
+// nothing ranked higher came up), else probe here
+static int probe_source(const boot_source_t *source, uint32_t index) {
+    if (!source->probe) return 0;
+    if (probes_started & (1u << index)) return sched_join(&probe_tasks[index]);
+    return source->probe();
+}
+
+int boot_source_load(const char *filename, uint32_t load_addr, uint32_t *size,
+                     const boot_source_t **used) {
+    uint32_t tried = 0;             // Bit per table index (the table is small)
+    uint32_t index;
+    const boot_source_t *source;
+
+    if (used) *used = NULL;
+
+    while ((source = next_source(&tried, &index)) != NULL) {
+        if (probe_source(source, index) != 0) continue;
+        if (source->load(filename, load_addr, size) != 0) continue;
+
+        probes_cancelled = 1;
+        if (used) *used = source;
+        return 0;
+    }
+    return -1;
+}
+
+int boot_source_peek(const char *filename, void *buf, uint32_t len, uint32_t *size,
+                     const boot_source_t **used) {
+    uint32_t tried = 0;
+    uint32_t index;
+    const boot_source_t *source;
+
+    if (used) *used = NULL;
+
+    while ((source = next_source(&tried, &index)) != NULL) {
+        if (!source->peek) continue;
+        if (probe_source(source, index) != 0) continue;
+        if (source->peek(filename, buf, len, size) != 0) continue;
+
+        probes_cancelled = 1;
+        if (used) *used = source;
+        return 0;
+    }
+    return -1;
+}
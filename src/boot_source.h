@@ -0,0 +1,72 @@
+/* Boot Source Table */
+
+#ifndef BOOT_SOURCE_H
+#define BOOT_SOURCE_H
+
+#include <stdint.h>
+#include "initcall.h"
+
+// Somewhere a kernel image can come from. Defined by the module that
+// implements it, so the table only lists sources linked into the image
+typedef struct {
+    const char *name;
+    uint32_t paths;                 // BOOT_PATH_* this source serves
+    uint32_t priority;              // Lower is tried first
+    int (*probe)(void);             // 0 when usable; brings its drivers up
+    int (*load)(const char *filename, uint32_t load_addr, uint32_t *size);
+    // First len bytes and the file size, without loading the rest; lets a
+    // loader pick the final address before the one full read
+    int (*peek)(const char *filename, void *buf, uint32_t len, uint32_t *size);
+    // len bytes at 'offset' (all inside the file); lets a loader take only
+    // the parts it needs, such as an ELF's PT_LOAD segments. May be NULL
+    int (*read)(const char *filename, uint32_t offset, void *buf, uint32_t len);
+} boot_source_t;
+
+// Tried before everything, the preferred source included, and never
+// remembered as the source that worked: copies already in RAM (resident.h)
+#define BOOT_SOURCE_PRIORITY_FIRST  0
+
+#define BOOT_SOURCE(var, src_name, src_paths, src_priority, probe_fn, load_fn, peek_fn, \
+                    read_fn) \
+    static const boot_source_t var = { .name = (src_name), .paths = (src_paths), \
+                                       .priority = (src_priority), .probe = (probe_fn), \
+                                       .load = (load_fn), .peek = (peek_fn), \
+                                       .read = (read_fn) }; \
+    static const boot_source_t *const __boot_source_entry_##var \
+        LINKER_TABLE_ENTRY(".table.boot_sources") = &var
+
+uint32_t boot_source_count(void);
+const boot_source_t *boot_source_get(uint32_t index);
+const boot_source_t *boot_source_find(const char *name);
+
+// Try this source first next time, whatever its priority (NULL to clear);
+// used to go straight to the source that worked on the previous boot
+void boot_source_prefer(const boot_source_t *source);
+
+// Probe every source that serves the selected boot path at once, on the
+// scheduler. Searches then wait only for the sources ranked above the one
+// that comes up, not for each timeout in turn. The first file found
+// cancels the rest: probes not yet started never run, and running ones
+// stop at their next boot_source_probe_cancelled() check (USB, TFTP).
+// Those that never check (SD, virtio) run on, and sched_shutdown() waits
+// for them before the handoff. Without this, sources are probed as they
+// are reached
+int boot_source_probe_start(void);
+
+// For long probes (enumeration, link and DHCP waits): 1 once another
+// source has won and the result is no longer wanted. A probe that never
+// checks runs to the end of its own timeouts
+int boot_source_probe_cancelled(void);
+
+// Load a file from the first source that serves the selected boot path
+// (any source if none is selected): BOOT_SOURCE_PRIORITY_FIRST sources,
+// then the preferred one, then in priority order. Returns 0 and sets *used on success
+int boot_source_load(const char *filename, uint32_t load_addr, uint32_t *size,
+                     const boot_source_t **used);
+
+// Same search, reading only the start of the file (see boot_source_t.peek);
+// load the rest from *used
+int boot_source_peek(const char *filename, void *buf, uint32_t len, uint32_t *size,
+                     const boot_source_t **used);
+
+#endif
@@ -0,0 +1,193 @@
+/* ARMv8 Cache Maintenance Implementation */
+
+#include <stdint.h>
+#include "cache.h"
+
+static cache_info_t cache_info;
+static int cache_info_valid = 0;
+
+// Set/way operation types
+#define SETWAY_CLEAN            0
+#define SETWAY_INVALIDATE       1
+#define SETWAY_CLEAN_INVALIDATE 2
+
+void cache_init(void) {
+    uint64_t ctr, clidr;
+    __asm__ volatile("mrs %0, ctr_el0" : "=r"(ctr));
+    __asm__ volatile("mrs %0, clidr_el1" : "=r"(clidr));
+
+    // Line fields are log2 of the number of 4-byte words
+    cache_info.icache_line = 4U << (ctr & 0xF);
+    cache_info.dcache_line = 4U << ((ctr >> 16) & 0xF);
+    cache_info.idc = (ctr >> 28) & 1;
+    cache_info.dic = (ctr >> 29) & 1;
+    cache_info.levels = (clidr >> 24) & 0x7;
+
+    cache_info_valid = 1;
+}
+
+const cache_info_t *cache_get_info(void) {
+    if (!cache_info_valid) cache_init();
+    return &cache_info;
+}
+
+uint32_t dcache_line_size(void) {
+    if (!cache_info_valid) cache_init();
+    return cache_info.dcache_line;
+}
+
+void dcache_clean_range(uintptr_t start, uint64_t length) {
+    if (length == 0) return;
+
+    uint64_t line = dcache_line_size();
+    uintptr_t addr = start & ~(line - 1);
+    uintptr_t end = start + length;
+
+    for (; addr < end; addr += line) {
+        __asm__ volatile("dc cvac, %0" : : "r"(addr) : "memory");
+    }
+    __asm__ volatile("dsb sy" : : : "memory");
+}
+
+void dcache_invalidate_range(uintptr_t start, uint64_t length) {
+    if (length == 0) return;
+
+    uint64_t line = dcache_line_size();
+    uintptr_t addr = start & ~(line - 1);
+    uintptr_t end = start + length;
+
+    // Partial lines at either edge may hold unrelated dirty data, so clean
+    // them as well instead of discarding it
+    for (; addr < end; addr += line) {
+        if (addr < start || addr + line > end) {
+            __asm__ volatile("dc civac, %0" : : "r"(addr) : "memory");
+        } else {
+            __asm__ volatile("dc ivac, %0" : : "r"(addr) : "memory");
+        }
+    }
+    __asm__ volatile("dsb sy" : : : "memory");
+}
+
+void dcache_clean_invalidate_range(uintptr_t start, uint64_t length) {
+    if (length == 0) return;
+
+    uint64_t line = dcache_line_size();
+    uintptr_t addr = start & ~(line - 1);
+    uintptr_t end = start + length;
+
+    for (; addr < end; addr += line) {
+        __asm__ volatile("dc civac, %0" : : "r"(addr) : "memory");
+    }
+    __asm__ volatile("dsb sy" : : : "memory");
+}
+
+// Walk the data/unified cache levels below 'levels' by set/way. Only
+// registers are used inside the loops, so no new dirty lines appear mid-walk.
+static void dcache_setway(int op, uint32_t levels) {
+    uint64_t clidr;
+    __asm__ volatile("mrs %0, clidr_el1" : "=r"(clidr));
+
+    for (uint32_t level = 0; level < levels; level++) {
+        uint32_t ctype = (clidr >> (level * 3)) & 0x7;
+        if (ctype < 2) continue;  // No data cache at this level
+
+        uint64_t ccsidr;
+        __asm__ volatile("msr csselr_el1, %0\n\tisb" : : "r"((uint64_t)level << 1));
+        __asm__ volatile("mrs %0, ccsidr_el1" : "=r"(ccsidr));
+
+        uint32_t line_shift = (ccsidr & 0x7) + 4;
+        uint32_t max_way = (ccsidr >> 3) & 0x3FF;
+        uint32_t max_set = (ccsidr >> 13) & 0x7FFF;
+        uint32_t way_shift = max_way ? __builtin_clz(max_way) : 0;
+
+        for (uint32_t way = 0; way <= max_way; way++) {
+            for (uint32_t set = 0; set <= max_set; set++) {
+                uint64_t sw = ((uint64_t)way << way_shift) |
+                              ((uint64_t)set << line_shift) |
+                              (level << 1);
+                if (op == SETWAY_CLEAN) {
+                    __asm__ volatile("dc csw, %0" : : "r"(sw) : "memory");
+                } else if (op == SETWAY_INVALIDATE) {
+                    __asm__ volatile("dc isw, %0" : : "r"(sw) : "memory");
+                } else {
+                    __asm__ volatile("dc cisw, %0" : : "r"(sw) : "memory");
+                }
+            }
+        }
+    }
+
+    __asm__ volatile("msr csselr_el1, xzr\n\tdsb sy\n\tisb" : : : "memory");
+}
+
+static uint32_t clidr_field(uint32_t shift) {
+    uint64_t clidr;
+    __asm__ volatile("mrs %0, clidr_el1" : "=r"(clidr));
+    return (clidr >> shift) & 0x7;
+}
+
+void dcache_clean_all(void) {
+    dcache_setway(SETWAY_CLEAN, clidr_field(24));               // LoC
+}
+
+void dcache_invalidate_all(void) {
+    dcache_setway(SETWAY_INVALIDATE, clidr_field(24));          // LoC
+}
+
+void dcache_clean_invalidate_all(void) {
+    dcache_setway(SETWAY_CLEAN_INVALIDATE, clidr_field(24));    // LoC
+}
+
+void dcache_invalidate_local(void) {
+    dcache_setway(SETWAY_INVALIDATE, clidr_field(21));          // LoUIS
+}
+
+void icache_invalidate_all(void) {
+    __asm__ volatile("ic iallu\n\tdsb nsh\n\tisb" : : : "memory");
+}
+
+void icache_invalidate_range(uintptr_t start, uint64_t length) {
+    if (length == 0) return;
+
+    const cache_info_t *info = cache_get_info();
+    if (info->dic) {
+        __asm__ volatile("isb" : : : "memory");
+        return;
+    }
+
+    uint64_t line = info->icache_line;
+    uintptr_t addr = start & ~(line - 1);
+    uintptr_t end = start + length;
+
+    for (; addr < end; addr += line) {
+        __asm__ volatile("ic ivau, %0" : : "r"(addr) : "memory");
+    }
+    __asm__ volatile("dsb ish\n\tisb" : : : "memory");
+}
+
+void cache_sync_code(uintptr_t start, uint64_t length) {
+    if (length == 0) return;
+
+    const cache_info_t *info = cache_get_info();
+    if (!info->idc) {
+        uint64_t line = info->dcache_line;
+        uintptr_t addr = start & ~(line - 1);
+        uintptr_t end = start + length;
+
+        for (; addr < end; addr += line) {
+            __asm__ volatile("dc cvau, %0" : : "r"(addr) : "memory");
+        }
+    }
+    __asm__ volatile("dsb ish" : : : "memory");
+
+    icache_invalidate_range(start, length);
+}
+
+void cache_dma_to_device(const void *buffer, uint32_t length) {
+    dcache_clean_range((uintptr_t)buffer, length);
+}
+
+void cache_dma_from_device(void *buffer, uint32_t length) {
+    // Called before the transfer so no dirty line is evicted on top of the
+    // incoming data, and after it so the CPU does not read stale lines
+    dcache_invalidate_range((uintptr_t)buffer, length);
+}
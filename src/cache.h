@@ -0,0 +1,52 @@
+/* ARMv8 Cache Maintenance Header */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+
+// Largest cache line the maintenance code has to cope with (Cortex-A53/A72: 64)
+#define CACHE_LINE_MAX 64
+
+// Cache geometry discovered from CTR_EL0 / CLIDR_EL1
+typedef struct {
+    uint32_t dcache_line;     // Smallest D-cache line in bytes (CTR_EL0.DminLine)
+    uint32_t icache_line;     // Smallest I-cache line in bytes (CTR_EL0.IminLine)
+    uint32_t levels;          // Levels up to the Point of Coherency (CLIDR_EL1.LoC)
+    uint32_t idc;             // D-cache clean to PoU not needed for I/D coherence
+    uint32_t dic;             // I-cache invalidation to PoU not needed
+} cache_info_t;
+
+// Read line sizes and hierarchy once (called lazily by every helper)
+void cache_init(void);
+const cache_info_t *cache_get_info(void);
+
+// Smallest D-cache line size in bytes
+uint32_t dcache_line_size(void);
+
+// D-cache maintenance by virtual address range (to Point of Coherency)
+void dcache_clean_range(uintptr_t start, uint64_t length);             // Write dirty lines back (CPU -> device)
+void dcache_invalidate_range(uintptr_t start, uint64_t length);        // Discard lines (device -> CPU)
+void dcache_clean_invalidate_range(uintptr_t start, uint64_t length);  // Write back and discard
+
+// Whole D-cache maintenance by set/way (all levels up to PoC, this core only)
+void dcache_clean_all(void);
+void dcache_invalidate_all(void);
+void dcache_clean_invalidate_all(void);
+
+// Invalidate only this core's private levels (up to LoUIS); safe while other
+// cores have dirty data in the shared L2
+void dcache_invalidate_local(void);
+
+// I-cache maintenance
+void icache_invalidate_all(void);
+void icache_invalidate_range(uintptr_t start, uint64_t length);  // After writing code
+
+// Make freshly written instructions visible (D-cache clean to PoU + I-cache invalidate)
+void cache_sync_code(uintptr_t start, uint64_t length);
+
+// DMA coherence helpers for drivers
+void cache_dma_to_device(const void *buffer, uint32_t length);    // Before device reads memory
+void cache_dma_from_device(void *buffer, uint32_t length);        // Before and after device writes memory
+
+#endif
@@ -5,6 +5,7 @@
 #include "uart.h"
 #include "hardware.h"
 #include "mailbox.h"
+#include "memmap.h"
 
 // Forward declare if needed
 // typedef struct fat32_dir_entry fat32_dir_entry_t; // Already in sd.h
@@ -332,16 +333,24 @@ static int parse_line(char *line) {
 }
 
 void config_parse(void) {
-    uint8_t *config_buffer = (uint8_t*)0x200000; // Temporary buffer at 2MB
+    uint64_t buffer_addr;
     fat32_dir_entry_t entry;
 
     uart_puts("Loading config.txt...\n");
 
+    // Temporary buffer, wherever the memory map has room for it
+    if (memmap_alloc(MAX_CONFIG_SIZE, 0x1000, MEMMAP_SCRATCH, 0, "config", &buffer_addr) != 0) {
+        uart_puts("No memory for config.txt\n");
+        return;
+    }
+    uint8_t *config_buffer = (uint8_t*)(uintptr_t)buffer_addr;
+
     // Try to find and load config.txt
     if (fat_find_file("config.txt", &entry) == 0) {
         // Check config file size bounds
         if (entry.file_size > MAX_CONFIG_SIZE) {
             uart_puts("Config file too large\n");
+            memmap_release(buffer_addr);
             return;
         }
         int32_t size = fat_read_file(&entry, config_buffer, MAX_CONFIG_SIZE);
@@ -368,6 +377,8 @@ void config_parse(void) {
     } else {
         uart_puts("No config.txt found, using defaults\n");
     }
+
+    memmap_release(buffer_addr);
 }
 
 // Apply model-specific configuration
@@ -22,6 +22,15 @@ static void *memset(void *s, int c, uint32_t n) {
     return s;
 }
 
+static int memcmp(const void *a, const void *b, uint32_t n) {
+    const unsigned char *p = a, *q = b;
+    while (n--) {
+        if (*p != *q) return *p - *q;
+        p++; q++;
+    }
+    return 0;
+}
+
 // Current configuration
 static boot_config_t current_config;
 static int config_loaded = 0;
@@ -113,6 +122,7 @@ static void config_set_defaults(boot_config_t *config) {
     config->enable_secure_boot = 0;
     config->enable_a_b_boot = 0;
     config->current_boot_slot = 0;
+    config->keep_resident = 1;
 
     // Calculate CRC
     config->crc32 = config_calc_crc32(
@@ -184,14 +194,14 @@ int config_persist_load(boot_config_t *config) {
     uint8_t sector_buffer[512];
 
     // Read primary config sector
-    if (sd_read_block(CONFIG_SD_SECTOR, sector_buffer) == 0) {
+    if (sd_read_sector(CONFIG_SD_SECTOR, sector_buffer) == 0) {
         memcpy(config, sector_buffer, sizeof(boot_config_t));
         return 0;
     }
 
     // Try backup sector
     log_warn("CONFIG", "Primary config sector read failed, trying backup");
-    if (sd_read_block(CONFIG_BACKUP_SECTOR, sector_buffer) == 0) {
+    if (sd_read_sector(CONFIG_BACKUP_SECTOR, sector_buffer) == 0) {
         memcpy(config, sector_buffer, sizeof(boot_config_t));
         return 0;
     }
@@ -212,18 +222,25 @@ int config_persist_save(const boot_config_t *config) {
         sizeof(boot_config_t) - 12
     );
 
+    // Older cards start the boot partition at sector 2048; never write
+    // the config over the filesystem
+    if (fat_sector_in_volume(CONFIG_SD_SECTOR) || fat_sector_in_volume(CONFIG_BACKUP_SECTOR)) {
+        log_error("CONFIG", "Config sectors overlap the FAT volume, not saving");
+        return -1;
+    }
+
     // Prepare sector buffer
     memset(sector_buffer, 0, 512);
     memcpy(sector_buffer, &save_config, sizeof(boot_config_t));
 
     // Write primary sector
-    if (sd_write_block(CONFIG_SD_SECTOR, sector_buffer) != 0) {
+    if (sd_write_sector(CONFIG_SD_SECTOR, sector_buffer) != 0) {
         log_error("CONFIG", "Failed to write primary config sector");
         return -1;
     }
 
     // Write backup sector
-    if (sd_write_block(CONFIG_BACKUP_SECTOR, sector_buffer) != 0) {
+    if (sd_write_sector(CONFIG_BACKUP_SECTOR, sector_buffer) != 0) {
         log_warn("CONFIG", "Failed to write backup config sector");
         // Not fatal
     }
@@ -282,6 +299,12 @@ int config_persist_set_watchdog(uint8_t enabled, uint32_t timeout_ms) {
     return config_persist_save(&current_config);
 }
 
+// Update resident store setting; takes effect at the next kernel load
+int config_persist_set_resident(uint8_t enabled) {
+    current_config.keep_resident = enabled ? 1 : 0;
+    return config_persist_save(&current_config);
+}
+
 // Update network settings
 int config_persist_set_network(uint8_t dhcp, const uint8_t *ip, const uint8_t *netmask, const uint8_t *gateway) {
     current_config.dhcp_enabled = dhcp;
@@ -351,3 +374,47 @@ int config_persist_mark_boot_failure(void) {
 
     return config_persist_save(&current_config);
 }
+
+// Boot profile CRC covers everything after the crc32 field
+static uint32_t profile_crc(const boot_profile_t *profile) {
+    return config_calc_crc32((const uint8_t *)profile + 8, sizeof(boot_profile_t) - 8);
+}
+
+int config_persist_get_profile(boot_profile_t *profile) {
+    boot_profile_t stored;
+
+    if (!profile) return -1;
+
+    memcpy(&stored, config_persist_get()->reserved, sizeof(boot_profile_t));
+    if (stored.magic != BOOT_PROFILE_MAGIC || stored.crc32 != profile_crc(&stored)) {
+        return -1;
+    }
+
+    memcpy(profile, &stored, sizeof(boot_profile_t));
+    return 0;
+}
+
+int config_persist_set_profile(const boot_profile_t *profile) {
+    boot_profile_t record;
+
+    if (!profile) return -1;
+
+    memcpy(&record, profile, sizeof(boot_profile_t));
+    record.magic = BOOT_PROFILE_MAGIC;
+    record.crc32 = profile_crc(&record);
+
+    // Same files from the same card is the common case: no write at all
+    config_persist_get();
+    if (memcmp(current_config.reserved, &record, sizeof(boot_profile_t)) == 0) {
+        return 0;
+    }
+
+    memcpy(current_config.reserved, &record, sizeof(boot_profile_t));
+    return config_persist_save(&current_config);
+}
+
+int config_persist_clear_profile(void) {
+    config_persist_get();
+    memset(current_config.reserved, 0, sizeof(current_config.reserved));
+    return config_persist_save(&current_config);
+}
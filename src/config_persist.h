@@ -4,10 +4,11 @@
 #define CONFIG_PERSIST_H
 
 #include <stdint.h>
+#include "sd.h"
 
 // Configuration storage location
 #define CONFIG_MAGIC            0x42544346  // "BTCF" - BootConfig
-#define CONFIG_VERSION          1
+#define CONFIG_VERSION          2
 #define CONFIG_SD_SECTOR        2048        // Sector 2048 (1MB offset)
 #define CONFIG_BACKUP_SECTOR    2049        // Backup copy
 
@@ -48,11 +49,35 @@ typedef struct {
     uint32_t boot_counter_b;
     uint32_t boot_success_a;
     uint32_t boot_success_b;
+    uint8_t  keep_resident;           // Keep loaded images over a warm reset (resident.h)
 
-    // Reserved for future use
+    // Reserved for future use; holds the boot profile (boot_profile_t)
     uint8_t  reserved[128];
 } boot_config_t;
 
+// Boot profile: what discovery found last time, so the next boot can go
+// straight to it. Kept in boot_config_t.reserved with its own CRC, so a
+// stale or missing profile never invalidates the rest of the config
+#define BOOT_PROFILE_MAGIC      0x46525042  // "BPRF"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t crc32;                 // Over everything after this field
+    uint32_t board_revision;        // Profile only applies to this board
+    fat_cache_t fat;                // Partition LBA, volume serial, file extents
+    char     boot_source[12];       // Boot source that delivered the kernel
+
+    // DHCP lease (INIT-REBOOT: request the same address again)
+    uint8_t  lease_ip[4];
+    uint8_t  lease_netmask[4];
+    uint8_t  lease_gateway[4];
+    uint8_t  lease_server[4];
+    uint32_t lease_seconds;
+} boot_profile_t;
+
+_Static_assert(sizeof(boot_profile_t) <= sizeof(((boot_config_t *)0)->reserved),
+               "boot profile must fit in boot_config_t.reserved");
+
 // Initialize configuration system
 int config_persist_init(void);
 
@@ -74,12 +99,20 @@ int config_persist_set_default_boot(uint32_t device);
 int config_persist_set_log_level(uint8_t level);
 int config_persist_set_watchdog(uint8_t enabled, uint32_t timeout_ms);
 int config_persist_set_network(uint8_t dhcp, const uint8_t *ip, const uint8_t *netmask, const uint8_t *gateway);
+int config_persist_set_resident(uint8_t enabled);
 
 // A/B boot slot management
 int config_persist_get_boot_slot(void);
 int config_persist_mark_boot_success(void);
 int config_persist_mark_boot_failure(void);
 
+// Boot profile in the reserved area. get returns -1 (and leaves *profile
+// alone) when there is none or it fails its CRC; set persists only if the
+// profile changed
+int config_persist_get_profile(boot_profile_t *profile);
+int config_persist_set_profile(const boot_profile_t *profile);
+int config_persist_clear_profile(void);
+
 // Validate configuration
 int config_persist_validate(const boot_config_t *config);
 
@@ -1,6 +1,13 @@
 /* DMA Controller Implementation for Raspberry Pi */
 
 #include "dma.h"
+#include "cache.h"
+#include "interrupt.h"
+
+#define DMA_VC_IRQ_BASE 16      // VideoCore IRQ of channel 0; one per channel
+
+// Completion waiters, one per channel with an interrupt-driven transfer
+static async_event_t *volatile dma_waiters[8];
 
 // Helper functions
 static void mmio_write(uint32_t reg, uint32_t data) {
@@ -28,6 +35,10 @@ int dma_transfer(uint8_t channel, void *src, void *dst, uint32_t length, uint32_
     // Clear interrupts
     mmio_write(dma_base + DMA_CS, DMA_CS_INT | DMA_CS_END);
 
+    // The DMA engine does not snoop the ARM caches
+    cache_dma_to_device(src, length);
+    cache_dma_from_device(dst, length);
+
     // Set transfer parameters
     mmio_write(dma_base + DMA_SOURCE_AD, (uint32_t)src);
     mmio_write(dma_base + DMA_DEST_AD, (uint32_t)dst);
@@ -40,6 +51,9 @@ int dma_transfer(uint8_t channel, void *src, void *dst, uint32_t length, uint32_
     // Wait for completion
     while (!(mmio_read(dma_base + DMA_CS) & DMA_CS_END));
 
+    // Drop lines speculatively refilled while the transfer ran
+    cache_dma_from_device(dst, length);
+
     // Check for errors
     if (mmio_read(dma_base + DMA_CS) & DMA_CS_ERROR) {
         return -1;
@@ -60,6 +74,13 @@ int dma_transfer_async(uint8_t channel, dma_control_block_t *cb) {
     // Clear interrupts
     mmio_write(dma_base + DMA_CS, DMA_CS_INT | DMA_CS_END);
 
+    // The engine fetches the control block (and its source data) from
+    // memory; the caller owns the destination buffer's maintenance
+    cache_dma_to_device(cb, sizeof(dma_control_block_t));
+    if (cb->source_ad) {
+        cache_dma_to_device((void *)(uintptr_t)cb->source_ad, cb->txfr_len);
+    }
+
     // Set control block address
     mmio_write(dma_base + DMA_CONBLK_AD, (uint32_t)cb);
 
@@ -69,6 +90,37 @@ int dma_transfer_async(uint8_t channel, dma_control_block_t *cb) {
     return 0;
 }
 
+static void dma_irq_handler(void *context) {
+    uint8_t channel = (uint8_t)(uintptr_t)context;
+    uint32_t dma_base = DMA_BASE + channel * 0x100;
+    uint32_t cs = mmio_read(dma_base + DMA_CS);
+
+    // Acknowledge; the line stays asserted until INT is written back
+    mmio_write(dma_base + DMA_CS, DMA_CS_INT);
+
+    async_event_t *done = dma_waiters[channel];
+    if (done && (cs & DMA_CS_END)) {
+        dma_waiters[channel] = 0;
+        interrupt_disable(interrupt_vc_irq(DMA_VC_IRQ_BASE + channel));
+        async_event_signal(done, (cs & DMA_CS_ERROR) ? -1 : 0);
+    }
+}
+
+int dma_transfer_async_notify(uint8_t channel, dma_control_block_t *cb, async_event_t *done) {
+    if (channel > 7 || !cb || !done) return -1;
+
+    uint32_t irq = interrupt_vc_irq(DMA_VC_IRQ_BASE + channel);
+    if (irq == INTERRUPT_NONE) return -1;
+
+    async_event_init(done);
+    dma_waiters[channel] = done;
+    interrupt_register_handler(irq, dma_irq_handler, (void *)(uintptr_t)channel);
+    interrupt_enable(irq);
+
+    cb->ti |= DMA_TI_INTEN;
+    return dma_transfer_async(channel, cb);
+}
+
 int dma_wait_transfer(uint8_t channel) {
     if (channel > 7) return -1;
 
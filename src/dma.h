@@ -4,6 +4,7 @@
 #define DMA_H
 
 #include <stdint.h>
+#include "async.h"
 
 // DMA Controller registers (Pi 4)
 #define DMA_BASE 0xFE007000
@@ -80,6 +81,10 @@ void dma_init(void);
 int dma_transfer(uint8_t channel, void *src, void *dst, uint32_t length, uint32_t ti);
 int dma_transfer_async(uint8_t channel, dma_control_block_t *cb);
 int dma_wait_transfer(uint8_t channel);
+
+// Start a control-block transfer and signal 'done' from the channel's
+// completion interrupt (status 0 or -1 on error) instead of polling
+int dma_transfer_async_notify(uint8_t channel, dma_control_block_t *cb, async_event_t *done);
 void dma_abort_transfer(uint8_t channel);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+/* Lazy Driver Registry and Boot-Path Selection */
+
+#include <stdint.h>
+#include "driver.h"
+#include "timer.h"
+#include "atomic.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+LINKER_TABLE_DECLARE(driver_t, driver_table);
+
+static uint32_t selected_path = BOOT_PATH_NONE;
+
+static int streq(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+int driver_require(driver_t *driver) {
+    if (!driver || !driver->init) return -1;
+
+    uint32_t state = atomic_load_32(&driver->state, ATOMIC_ACQUIRE);
+
+    if (state == DRIVER_UNINIT &&
+        atomic_cas_32(&driver->state, DRIVER_UNINIT, DRIVER_INITING, ATOMIC_ACQUIRE) == DRIVER_UNINIT) {
+        uint64_t start = timer_get_ticks();
+        driver->result = driver->init();
+        driver->init_us = timer_get_ticks() - start;
+
+        atomic_store_32(&driver->state, driver->result == 0 ? DRIVER_READY : DRIVER_FAILED,
+                        ATOMIC_RELEASE);
+        __asm__ volatile("dsb ish\n\tsev" : : : "memory");
+        return driver->result;
+    }
+
+    // Someone else is bringing it up
+    while (atomic_load_32(&driver->state, ATOMIC_ACQUIRE) == DRIVER_INITING) {
+        __asm__ volatile("wfe" : : : "memory");
+    }
+
+    return driver->result;
+}
+
+int driver_is_ready(const driver_t *driver) {
+    return driver && atomic_load_32(&driver->state, ATOMIC_ACQUIRE) == DRIVER_READY;
+}
+
+driver_t *driver_find(const char *name) {
+    for (uint32_t i = 0; i < driver_count(); i++) {
+        driver_t *driver = LINKER_TABLE_GET(driver_table, i);
+        if (streq(driver->name, name)) return driver;
+    }
+    return NULL;
+}
+
+uint32_t driver_count(void) {
+    return LINKER_TABLE_COUNT(driver_table);
+}
+
+driver_t *driver_get(uint32_t index) {
+    return index < driver_count() ? LINKER_TABLE_GET(driver_table, index) : NULL;
+}
+
+int boot_path_select(uint32_t path) {
+    int failures = 0;
+
+    selected_path = path;
+    for (uint32_t i = 0; i < driver_count(); i++) {
+        driver_t *driver = LINKER_TABLE_GET(driver_table, i);
+        if (driver->paths & path) {
+            if (driver_require(driver) != 0) failures++;
+        }
+    }
+
+    return failures;
+}
+
+uint32_t boot_path_get(void) {
+    return selected_path;
+}
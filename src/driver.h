@@ -0,0 +1,55 @@
+/* Lazy Driver Registry and Boot-Path Selection */
+
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <stdint.h>
+#include "initcall.h"
+
+// Boot paths (bit mask); a driver lists the paths that need it up front
+#define BOOT_PATH_NONE      0
+#define BOOT_PATH_SD        (1 << 0)
+#define BOOT_PATH_USB       (1 << 1)
+#define BOOT_PATH_NETWORK   (1 << 2)
+#define BOOT_PATH_DIAG      (1 << 3)    // Self-tests and the full driver set
+#define BOOT_PATH_ALL       0xFFFFFFFF
+
+// Driver states
+#define DRIVER_UNINIT       0
+#define DRIVER_INITING      1
+#define DRIVER_READY        2
+#define DRIVER_FAILED       3
+
+typedef struct {
+    const char *name;
+    int (*init)(void);              // 0 on success
+    uint32_t paths;                 // BOOT_PATH_* that bring it up eagerly
+    volatile uint32_t state;
+    int result;
+    uint64_t init_us;               // Time spent in init
+} driver_t;
+
+// Define a driver descriptor in the driver's own file; it lands in the
+// driver table, so linking the file in is all it takes to register it
+#define DRIVER_DEFINE(var, drv_name, init_fn, boot_paths) \
+    driver_t var = { .name = (drv_name), .init = (init_fn), .paths = (boot_paths), \
+                     .state = DRIVER_UNINIT, .result = 0, .init_us = 0 }; \
+    static driver_t *const __driver_entry_##var LINKER_TABLE_ENTRY(".table.drivers") = &var
+
+// Initialise on first use. Safe from any core: one caller runs init, the
+// others wait for it. Returns the init result (cached afterwards)
+int driver_require(driver_t *driver);
+int driver_is_ready(const driver_t *driver);
+
+// Every driver linked into the image, in link order
+driver_t *driver_find(const char *name);
+uint32_t driver_count(void);
+driver_t *driver_get(uint32_t index);
+
+// Choose the boot path and bring up only the linked-in drivers it needs;
+// everything else stays untouched until something requires it. Returns
+// the number of drivers that failed
+int boot_path_select(uint32_t path);
+uint32_t boot_path_get(void);
+
+#endif
@@ -0,0 +1,81 @@
+/* ELF64 Kernel Loading */
+
+#include <stdint.h>
+#include "elf_loader.h"
+#include "memmap.h"
+#include "memory.h"
+#include "cache.h"
+
+#define ELF_PAGE            0x1000
+#define ELF_OFFSET_MAX      0xFFFFFFFF  // Boot sources address files with 32 bits
+
+int elf_check(const elf64_ehdr_t *header) {
+    if (header->e_magic != ELF_MAGIC || header->e_class != ELFCLASS64 ||
+        header->e_data != ELFDATA2LSB) {
+        return -1;
+    }
+    if (header->e_type != ET_EXEC || header->e_machine != EM_AARCH64) return -1;
+    if (header->e_phentsize != sizeof(elf64_phdr_t) || header->e_phnum == 0 ||
+        header->e_phnum > ELF_MAX_PHDRS) {
+        return -1;
+    }
+    return 0;
+}
+
+int elf_load(const boot_source_t *source, const char *filename, const elf64_ehdr_t *header,
+             elf_image_t *image) {
+    elf64_phdr_t phdrs[ELF_MAX_PHDRS];
+    uint32_t count = header->e_phnum;
+    uint64_t base = UINT64_MAX;
+    uint64_t end = 0;
+
+    image->entry = 0;
+
+    if (!source->read || header->e_phoff > ELF_OFFSET_MAX) return -1;
+    if (source->read(filename, (uint32_t)header->e_phoff, phdrs,
+                     count * sizeof(elf64_phdr_t)) != 0) {
+        return -1;
+    }
+
+    // Extent of the loadable segments, and the physical entry point (the
+    // header gives a virtual one)
+    for (uint32_t i = 0; i < count; i++) {
+        const elf64_phdr_t *ph = &phdrs[i];
+
+        if (ph->p_type != PT_LOAD || ph->p_memsz == 0) continue;
+        if (ph->p_filesz > ph->p_memsz || ph->p_paddr + ph->p_memsz < ph->p_paddr ||
+            ph->p_offset > ELF_OFFSET_MAX || ph->p_filesz > ELF_OFFSET_MAX - ph->p_offset) {
+            return -1;
+        }
+
+        if (ph->p_paddr < base) base = ph->p_paddr;
+        if (ph->p_paddr + ph->p_memsz > end) end = ph->p_paddr + ph->p_memsz;
+        if (header->e_entry >= ph->p_vaddr && header->e_entry - ph->p_vaddr < ph->p_memsz) {
+            image->entry = header->e_entry - ph->p_vaddr + ph->p_paddr;
+        }
+    }
+    if (end == 0 || image->entry == 0) return -1;
+
+    base &= ~(uint64_t)(ELF_PAGE - 1);
+    end = (end + ELF_PAGE - 1) & ~(uint64_t)(ELF_PAGE - 1);
+    if (memmap_reserve(base, end - base, MEMMAP_KERNEL, 0, "kernel") != 0) return -1;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const elf64_phdr_t *ph = &phdrs[i];
+        uint8_t *dest = (uint8_t *)(uintptr_t)ph->p_paddr;
+
+        if (ph->p_type != PT_LOAD || ph->p_memsz == 0) continue;
+
+        if (ph->p_filesz && source->read(filename, (uint32_t)ph->p_offset, dest,
+                                         (uint32_t)ph->p_filesz) != 0) {
+            memmap_release(base);
+            return -1;
+        }
+        memory_zero(dest + ph->p_filesz, ph->p_memsz - ph->p_filesz);
+        dcache_clean_range(ph->p_paddr, ph->p_memsz);
+    }
+
+    image->base = base;
+    image->end = end;
+    return 0;
+}
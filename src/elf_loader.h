@@ -0,0 +1,73 @@
+/* ELF64 Kernel Loading */
+
+#ifndef ELF_LOADER_H
+#define ELF_LOADER_H
+
+#include <stdint.h>
+#include "boot_source.h"
+
+/*
+ * Test kernels, bare-metal payloads and hypervisors are often ELF
+ * executables. Only the program headers and the PT_LOAD segments are
+ * read, each straight from the boot source to its physical address;
+ * symbols and debug sections are never touched. BSS is zeroed in place.
+ */
+
+#define ELF_MAGIC           0x464C457F  // "\x7F" "ELF"
+#define ELFCLASS64          2
+#define ELFDATA2LSB         1
+#define ET_EXEC             2
+#define EM_AARCH64          183
+#define PT_LOAD             1
+
+#define ELF_MAX_PHDRS       16
+
+typedef struct {
+    uint32_t e_magic;
+    uint8_t  e_class;
+    uint8_t  e_data;
+    uint8_t  e_version_ident;
+    uint8_t  e_pad[9];
+    uint16_t e_type;
+    uint16_t e_machine;
+    uint32_t e_version;
+    uint64_t e_entry;
+    uint64_t e_phoff;
+    uint64_t e_shoff;
+    uint32_t e_flags;
+    uint16_t e_ehsize;
+    uint16_t e_phentsize;
+    uint16_t e_phnum;
+    uint16_t e_shentsize;
+    uint16_t e_shnum;
+    uint16_t e_shstrndx;
+} elf64_ehdr_t;
+
+typedef struct {
+    uint32_t p_type;
+    uint32_t p_flags;
+    uint64_t p_offset;
+    uint64_t p_vaddr;
+    uint64_t p_paddr;
+    uint64_t p_filesz;
+    uint64_t p_memsz;
+    uint64_t p_align;
+} elf64_phdr_t;
+
+// What an ELF load placed
+typedef struct {
+    uint64_t base;              // Lowest segment address
+    uint64_t end;               // End of the highest segment
+    uint64_t entry;             // Physical entry point
+} elf_image_t;
+
+// 0 if 'header' is a little-endian AArch64 executable this loader takes
+int elf_check(const elf64_ehdr_t *header);
+
+// Claim the segments' range in the memory map, then read every PT_LOAD
+// segment from 'source' to its p_paddr and zero its BSS. The source must
+// implement read(). On failure nothing stays claimed
+int elf_load(const boot_source_t *source, const char *filename, const elf64_ehdr_t *header,
+             elf_image_t *image);
+
+#endif
@@ -0,0 +1,344 @@
+/* BCM EMMC SD Card Driver */
+
+#include <stdint.h>
+#include "sd.h"
+#include "uart.h"
+#include "timer.h"
+#include "warm_boot.h"
+#include "platform.h"
+
+// BCM EMMC (SD Card) registers (platform.h)
+#define EMMC_BASE PLATFORM_EMMC_BASE
+
+#define EMMC_ARG2           ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x00))
+#define EMMC_BLKSIZECNT     ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x04))
+#define EMMC_ARG1           ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x08))
+#define EMMC_CMDTM          ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x0C))
+#define EMMC_RESP0          ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x10))
+#define EMMC_RESP1          ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x14))
+#define EMMC_RESP2          ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x18))
+#define EMMC_RESP3          ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x1C))
+#define EMMC_DATA           ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x20))
+#define EMMC_STATUS         ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x24))
+#define EMMC_CONTROL0       ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x28))
+#define EMMC_CONTROL1       ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x2C))
+#define EMMC_INTERRUPT      ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x30))
+#define EMMC_IRPT_MASK      ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x34))
+#define EMMC_IRPT_EN        ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x38))
+#define EMMC_CONTROL2       ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0x3C))
+#define EMMC_SLOTISR_VER    ((volatile uint32_t*)(uintptr_t)(EMMC_BASE + 0xFC))
+
+// Command flags
+#define CMD_NEED_APP        0x80000000
+#define CMD_RSPNS_48        0x00020000
+#define CMD_ERRORS_MASK     0xFFF9C004
+#define CMD_RCA_MASK        0xFFFF0000
+
+// Status register flags
+#define SR_READ_AVAILABLE   0x00000800
+#define SR_DAT_INHIBIT      0x00000002
+#define SR_CMD_INHIBIT      0x00000001
+#define SR_APP_CMD          0x00000020
+
+// CONTROL1 flags
+#define C1_CLK_STABLE       0x00000002
+
+// Card status (R1) fields
+#define R1_ERRORS_MASK      0xFFF80000
+#define R1_STATE_SHIFT      9
+#define R1_STATE_STBY       3
+#define R1_STATE_TRAN       4
+
+// Interrupt flags
+#define INT_DATA_TIMEOUT    0x00100000
+#define INT_CMD_TIMEOUT     0x00010000
+#define INT_READ_RDY        0x00000020
+#define INT_WRITE_RDY       0x00000010
+#define INT_DATA_DONE       0x00000002
+#define INT_CMD_DONE        0x00000001
+#define INT_ERROR_MASK      0x017E8000
+
+// SD Commands
+#define SD_CMD_GO_IDLE      0x00000000
+#define SD_CMD_ALL_SEND_CID 0x02000000
+#define SD_CMD_SEND_REL_ADDR 0x03020000
+#define SD_CMD_CARD_SELECT  0x07030000
+#define SD_CMD_SEND_IF_COND 0x08020000
+#define SD_CMD_STOP_TRANS   0x0C030000
+#define SD_CMD_SEND_STATUS  0x0D020000
+#define SD_CMD_READ_SINGLE  0x11220010
+#define SD_CMD_READ_MULTI   0x12220032
+#define SD_CMD_WRITE_SINGLE 0x18220000
+#define SD_CMD_SET_BLOCKCNT 0x17020000
+#define SD_CMD_APP_CMD      0x37000000
+#define SD_CMD_SET_BUS_WIDTH 0x06020000
+#define SD_ACMD_SD_STATUS   0x0D220000
+#define SD_ACMD_SEND_OP_COND 0x29020000
+
+static uint8_t sd_initialized = 0;
+static uint32_t sd_rca = 0;
+
+// Wait for command/data to complete
+static int sd_wait_ready(void) {
+    uint32_t timeout = 1000;  // Reduced for QEMU compatibility
+    while (((*EMMC_STATUS) & (SR_CMD_INHIBIT | SR_DAT_INHIBIT)) && timeout--) {
+        // No delay - just check register
+    }
+    return timeout > 0 ? 0 : -1;
+}
+
+// Send SD command
+static int sd_send_command(uint32_t command, uint32_t arg) {
+    // Wait for command line ready
+    if (sd_wait_ready() != 0) {
+        return -1;
+    }
+
+    // Clear interrupt flags
+    *EMMC_INTERRUPT = *EMMC_INTERRUPT;
+
+    // Send command
+    *EMMC_ARG1 = arg;
+    *EMMC_CMDTM = command;
+
+    // Wait for command complete
+    uint32_t timeout = 10000;  // Reduced for QEMU compatibility
+    uint32_t interrupt;
+    while (timeout--) {
+        interrupt = *EMMC_INTERRUPT;
+        if (interrupt & INT_CMD_DONE) break;
+        if (interrupt & INT_ERROR_MASK) return -1;
+        // No delay - just check register
+    }
+
+    if (timeout == 0) return -1;
+
+    // Clear interrupt
+    *EMMC_INTERRUPT = INT_CMD_DONE;
+
+    return 0;
+}
+
+// Send APP command (CMD55 + ACMD)
+static int sd_send_app_command(uint32_t command, uint32_t arg) {
+    if (sd_send_command(SD_CMD_APP_CMD, sd_rca) != 0) {
+        return -1;
+    }
+    return sd_send_command(command, arg);
+}
+
+// Full identification: 400kHz, CMD0/8, ACMD41 loop, CMD2/3/7
+static int sd_identify(void) {
+    // Reset controller
+    *EMMC_CONTROL0 = 0;
+    *EMMC_CONTROL1 |= 0x01000000;  // Reset
+    timer_delay_ms(10);
+
+    // Set clock to 400kHz for initialization
+    *EMMC_CONTROL1 = 0x00000000;
+    *EMMC_CONTROL1 = 0x000F0000 | 0x00000040;  // Enable clock
+    timer_delay_ms(10);
+
+    // Enable interrupts
+    *EMMC_IRPT_EN = 0xFFFFFFFF;
+    *EMMC_IRPT_MASK = 0xFFFFFFFF;
+
+    // CMD0 - GO_IDLE
+    if (sd_send_command(SD_CMD_GO_IDLE, 0) != 0) {
+        uart_puts("  SD: CMD0 failed\n");
+        return -1;
+    }
+
+    // CMD8 - SEND_IF_COND (voltage check)
+    if (sd_send_command(SD_CMD_SEND_IF_COND, 0x000001AA) != 0) {
+        uart_puts("  SD: CMD8 failed (SD V1 card?)\n");
+        // Continue anyway - might be older card
+    }
+
+    // ACMD41 - SD_SEND_OP_COND (initialize card)
+    uint32_t timeout = 100;  // Reduced for QEMU compatibility
+    while (timeout--) {
+        if (sd_send_app_command(SD_ACMD_SEND_OP_COND, 0x51FF8000) == 0) {
+            uint32_t resp = *EMMC_RESP0;
+            if (resp & 0x80000000) break;  // Card ready
+        }
+        timer_delay_ms(1);  // Reduced delay
+    }
+
+    if (timeout == 0) {
+        uart_puts("  SD: ACMD41 timeout\n");
+        return -1;
+    }
+
+    // CMD2 - ALL_SEND_CID
+    if (sd_send_command(SD_CMD_ALL_SEND_CID, 0) != 0) {
+        uart_puts("  SD: CMD2 failed\n");
+        return -1;
+    }
+
+    // CMD3 - SEND_RELATIVE_ADDR
+    if (sd_send_command(SD_CMD_SEND_REL_ADDR, 0) != 0) {
+        uart_puts("  SD: CMD3 failed\n");
+        return -1;
+    }
+    sd_rca = *EMMC_RESP0 & CMD_RCA_MASK;
+
+    // Increase clock to 25MHz
+    *EMMC_CONTROL1 = 0x00000000;
+    *EMMC_CONTROL1 = 0x00030000 | 0x00000040;
+    timer_delay_ms(10);
+
+    // CMD7 - SELECT_CARD
+    if (sd_send_command(SD_CMD_CARD_SELECT, sd_rca) != 0) {
+        uart_puts("  SD: CMD7 failed\n");
+        return -1;
+    }
+
+    // Set block size to 512 bytes
+    *EMMC_BLKSIZECNT = 0x00000200;
+
+    sd_initialized = 1;
+    return 0;
+}
+
+// Warm reset: the card kept its power and address, so skip identification.
+// CMD13 tells whether it is still there and in a usable state
+static int sd_reattach(uint32_t rca) {
+    // Straight to 25MHz, no controller reset
+    *EMMC_CONTROL1 = 0x00000000;
+    *EMMC_CONTROL1 = 0x00030000 | 0x00000040;
+
+    uint32_t timeout = 10000;
+    while (!(*EMMC_CONTROL1 & C1_CLK_STABLE) && timeout > 0) {
+        timeout--;
+    }
+    if (timeout == 0) return -1;
+
+    *EMMC_IRPT_EN = 0xFFFFFFFF;
+    *EMMC_IRPT_MASK = 0xFFFFFFFF;
+
+    // CMD13 - SEND_STATUS
+    if (sd_send_command(SD_CMD_SEND_STATUS, rca) != 0) return -1;
+
+    uint32_t status = *EMMC_RESP0;
+    uint32_t state = (status >> R1_STATE_SHIFT) & 0xF;
+    if (status & R1_ERRORS_MASK) return -1;
+
+    if (state == R1_STATE_STBY) {
+        // Deselected by the reset; CMD7 - SELECT_CARD
+        if (sd_send_command(SD_CMD_CARD_SELECT, rca) != 0) return -1;
+    } else if (state != R1_STATE_TRAN) {
+        return -1;
+    }
+
+    *EMMC_BLKSIZECNT = 0x00000200;
+
+    sd_rca = rca;
+    sd_initialized = 1;
+    return 0;
+}
+
+int sd_init(void) {
+    uint32_t rca;
+
+    if (warm_boot_get_sd(&rca) == 0) {
+        if (sd_reattach(rca) == 0) return 0;
+        warm_boot_set_sd(0);
+    }
+
+    if (sd_identify() != 0) return -1;
+
+    warm_boot_set_sd(sd_rca);
+    return 0;
+}
+
+int sd_read_sector(uint32_t sector, uint8_t *buffer) {
+    if (!sd_initialized) {
+        return -1;
+    }
+
+    // Set block count and size
+    *EMMC_BLKSIZECNT = 0x00200001;  // 1 block of 512 bytes
+
+    // CMD17 - READ_SINGLE_BLOCK
+    if (sd_send_command(SD_CMD_READ_SINGLE, sector) != 0) {
+        return -1;
+    }
+
+    // Wait for data ready
+    uint32_t timeout = 10000;  // Reduced for QEMU compatibility
+    while (timeout--) {
+        uint32_t interrupt = *EMMC_INTERRUPT;
+        if (interrupt & INT_READ_RDY) break;
+        if (interrupt & INT_ERROR_MASK) return -1;
+        // No delay - just check register
+    }
+
+    if (timeout == 0) return -1;
+
+    // Read data
+    uint32_t *buf32 = (uint32_t*)buffer;
+    for (int i = 0; i < 128; i++) {
+        buf32[i] = *EMMC_DATA;
+    }
+
+    // Clear interrupt
+    *EMMC_INTERRUPT = INT_READ_RDY;
+
+    return 0;
+}
+
+int sd_write_sector(uint32_t sector, const uint8_t *buffer) {
+    if (!sd_initialized) {
+        return -1;
+    }
+
+    // Set block count and size
+    *EMMC_BLKSIZECNT = 0x00200001;  // 1 block of 512 bytes
+
+    // CMD24 - WRITE_SINGLE_BLOCK
+    if (sd_send_command(SD_CMD_WRITE_SINGLE, sector) != 0) {
+        return -1;
+    }
+
+    // Wait for buffer space
+    uint32_t timeout = 10000;
+    while (timeout > 0) {
+        uint32_t interrupt = *EMMC_INTERRUPT;
+        if (interrupt & INT_WRITE_RDY) break;
+        if (interrupt & INT_ERROR_MASK) return -1;
+        timeout--;
+    }
+
+    if (timeout == 0) return -1;
+
+    const uint32_t *buf32 = (const uint32_t*)buffer;
+    for (int i = 0; i < 128; i++) {
+        *EMMC_DATA = buf32[i];
+    }
+    *EMMC_INTERRUPT = INT_WRITE_RDY;
+
+    // Wait for the card to finish programming
+    timeout = 100000;
+    while (timeout > 0) {
+        uint32_t interrupt = *EMMC_INTERRUPT;
+        if (interrupt & INT_DATA_DONE) break;
+        if (interrupt & INT_ERROR_MASK) return -1;
+        timeout--;
+    }
+
+    if (timeout == 0) return -1;
+
+    *EMMC_INTERRUPT = INT_DATA_DONE;
+
+    return 0;
+}
+
+// One command per sector: FAT reads are small apart from the kernel, and
+// the contiguous read saves the copy through the FAT sector buffer
+int sd_read_sectors(uint32_t sector, uint32_t count, uint8_t *buffer) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (sd_read_sector(sector + i, buffer + 512 * i) != 0) return -1;
+    }
+    return 0;
+}
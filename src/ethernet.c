@@ -2,6 +2,8 @@
 
 #include "ethernet.h"
 #include "memory.h"
+#include "cache.h"
+#include "driver.h"
 
 // Helper functions
 static void mmio_write(uint32_t reg, uint32_t data) {
@@ -24,10 +26,11 @@ static void *memcpy(void *dest, const void *src, uint32_t n) {
 #define TX_RING_SIZE 8
 #define RX_RING_SIZE 8
 
-static dma_desc_t tx_ring[TX_RING_SIZE] __attribute__((aligned(16)));
-static dma_desc_t rx_ring[RX_RING_SIZE] __attribute__((aligned(16)));
-static uint8_t tx_buffers[TX_RING_SIZE][2048] __attribute__((aligned(16)));
-static uint8_t rx_buffers[RX_RING_SIZE][2048] __attribute__((aligned(16)));
+// Cache-line aligned so buffer maintenance never touches unrelated data
+static dma_desc_t tx_ring[TX_RING_SIZE] __attribute__((aligned(CACHE_LINE_MAX)));
+static dma_desc_t rx_ring[RX_RING_SIZE] __attribute__((aligned(CACHE_LINE_MAX)));
+static uint8_t tx_buffers[TX_RING_SIZE][2048] __attribute__((aligned(CACHE_LINE_MAX)));
+static uint8_t rx_buffers[RX_RING_SIZE][2048] __attribute__((aligned(CACHE_LINE_MAX)));
 
 static uint32_t tx_head = 0;
 static uint32_t tx_tail = 0;
@@ -57,6 +60,12 @@ void ethernet_init(void) {
         rx_ring[i].length = 2048 | (1 << 31); // Max length, empty
     }
 
+    // Descriptors are read by the controller; RX buffers must hold no
+    // dirty lines that could be evicted over received frames
+    cache_dma_to_device(tx_ring, sizeof(tx_ring));
+    cache_dma_to_device(rx_ring, sizeof(rx_ring));
+    cache_dma_from_device(rx_buffers, sizeof(rx_buffers));
+
     // Set up DMA rings
     mmio_write(ETH_DMA_TX_RING0_ADDR, (uint32_t)tx_ring);
     mmio_write(ETH_DMA_TX_RING0_SIZE, TX_RING_SIZE);
@@ -70,6 +79,14 @@ void ethernet_init(void) {
     mmio_write(ETH_DMA_CTRL, DMA_TX_EN | DMA_RX_EN | DMA_TX_RING_EN | DMA_RX_RING_EN);
 }
 
+static int ethernet_driver_init(void) {
+    ethernet_init();
+    return 0;
+}
+
+// PHY reset and link negotiation are slow; only network boots pay for them
+DRIVER_DEFINE(ethernet_driver, "ethernet", ethernet_driver_init, BOOT_PATH_NETWORK | BOOT_PATH_DIAG);
+
 void ethernet_set_mac_address(const uint8_t *mac) {
     uint32_t mac_low = (mac[0] << 24) | (mac[1] << 16) | (mac[2] << 8) | mac[3];
     uint32_t mac_high = (mac[4] << 8) | mac[5];
@@ -90,8 +107,14 @@ int ethernet_send_frame(const ethernet_frame_t *frame, uint16_t length) {
     uint8_t *buffer = tx_buffers[buffer_idx];
     memcpy(buffer, frame, length);
 
-    // Set up descriptor
+    cache_dma_to_device(buffer, length);
+
+    // Set up descriptor. Several descriptors share a cache line and the
+    // controller writes the others, so refetch the line right before the
+    // update and push it straight back out.
+    cache_dma_from_device(&tx_ring[buffer_idx], sizeof(dma_desc_t));
     tx_ring[buffer_idx].length = length | (1 << 31); // Length with ownership bit
+    cache_dma_to_device(&tx_ring[buffer_idx], sizeof(dma_desc_t));
 
     // Update tail pointer
     tx_tail = (tx_tail + 1) % TX_RING_SIZE;
@@ -112,16 +135,19 @@ int ethernet_receive_frame(ethernet_frame_t *frame, uint16_t *length) {
     // Get frame from RX buffer
     uint32_t buffer_idx = rx_head;
     uint8_t *buffer = rx_buffers[buffer_idx];
+    cache_dma_from_device(&rx_ring[buffer_idx], sizeof(dma_desc_t));
     uint32_t desc_length = rx_ring[buffer_idx].length;
 
     if (!(desc_length & (1 << 31))) { // Check ownership
         uint16_t frame_length = desc_length & 0x7FFF; // Mask out flags
         if (frame_length <= sizeof(ethernet_frame_t)) {
+            cache_dma_from_device(buffer, frame_length);
             memcpy(frame, buffer, frame_length);
             *length = frame_length;
 
-            // Mark buffer as empty and update head
+            // Mark buffer as empty and update head (line was refetched above)
             rx_ring[buffer_idx].length = 2048 | (1 << 31);
+            cache_dma_to_device(&rx_ring[buffer_idx], sizeof(dma_desc_t));
             rx_head = (rx_head + 1) % RX_RING_SIZE;
 
             return 0;
@@ -4,6 +4,7 @@
 #define ETHERNET_H
 
 #include <stdint.h>
+#include "driver.h"
 
 // Ethernet GENET Controller registers (Pi 4)
 #define ETH_BASE 0xFE300000
@@ -459,4 +460,7 @@ uint32_t network_ip_to_int(const uint8_t *ip);
 void network_int_to_ip(uint32_t ip_int, uint8_t *ip);
 int network_parse_ip(const char *ip_str, uint32_t *ip);
 
+// Lazy driver descriptor (see driver.h)
+extern driver_t ethernet_driver;
+
 #endif
\ No newline at end of file
@@ -1,8 +1,10 @@
 /* Interrupt-Driven Ethernet Reception for Raspberry Pi */
 
 #include "ethernet.h"
+#include "ethernet_irq.h"
 #include "interrupt.h"
 #include "timer.h"
+#include "sync.h"
 
 #ifndef NULL
 #define NULL ((void *)0)
@@ -38,26 +40,27 @@ static void *memset(void *s, int c, uint32_t n) {
 // GIC interrupt number for Ethernet (platform-specific)
 #define ETH_GIC_IRQ          157        // Raspberry Pi 4/5
 
-// RX packet queue
-#define RX_QUEUE_SIZE 16
+// RX packet queue - the IRQ handler is the only producer and the receive
+// path the only consumer, so a lock-free SPSC ring needs no IRQ masking
+#define RX_QUEUE_SIZE 16    // Power of two
 
 typedef struct {
     ethernet_frame_t frame;
     uint16_t length;
     uint64_t timestamp;
-    int valid;
 } rx_packet_entry_t;
 
 static struct {
+    spsc_ring_t ring;
     rx_packet_entry_t queue[RX_QUEUE_SIZE];
-    volatile uint32_t head;
-    volatile uint32_t tail;
-    volatile uint32_t count;
     volatile uint32_t dropped;
     volatile uint32_t errors;
     volatile uint32_t interrupts;
 } rx_queue;
 
+// Async waiter for the next queued frame (one-shot)
+static async_event_t *volatile rx_waiter;
+
 // Statistics
 static struct {
     uint32_t packets_received;
@@ -85,25 +88,27 @@ static void ethernet_irq_handler(void *context) {
 
     // Handle RX packet
     if (irq_status & ETH_IRQ_RX_DONE) {
-        ethernet_frame_t rx_frame;
-        uint16_t rx_len;
-
-        // Read packet from hardware (polling the actual FIFO)
-        if (ethernet_receive_frame(&rx_frame, &rx_len) == 0) {
-            // Add to queue if space available
-            if (rx_queue.count < RX_QUEUE_SIZE) {
-                uint32_t tail_idx = rx_queue.tail;
-
-                memcpy(&rx_queue.queue[tail_idx].frame, &rx_frame, sizeof(ethernet_frame_t));
-                rx_queue.queue[tail_idx].length = rx_len;
-                rx_queue.queue[tail_idx].timestamp = timer_get_counter();
-                rx_queue.queue[tail_idx].valid = 1;
-
-                rx_queue.tail = (rx_queue.tail + 1) % RX_QUEUE_SIZE;
-                rx_queue.count++;
+        uint32_t slot;
+
+        if (spsc_ring_reserve(&rx_queue.ring, &slot) == 0) {
+            // Read packet from hardware straight into the free slot
+            rx_packet_entry_t *entry = &rx_queue.queue[slot];
+            if (ethernet_receive_frame(&entry->frame, &entry->length) == 0) {
+                entry->timestamp = timer_get_counter();
+                spsc_ring_commit(&rx_queue.ring);
                 eth_stats.packets_received++;
-            } else {
-                // Queue full, drop packet
+
+                async_event_t *waiter = rx_waiter;
+                if (waiter) {
+                    rx_waiter = NULL;
+                    async_event_signal(waiter, 0);
+                }
+            }
+        } else {
+            // Queue full: still drain the controller, then drop the packet
+            ethernet_frame_t rx_frame;
+            uint16_t rx_len;
+            if (ethernet_receive_frame(&rx_frame, &rx_len) == 0) {
                 rx_queue.dropped++;
                 eth_stats.packets_dropped++;
             }
@@ -146,6 +151,7 @@ int ethernet_irq_init(void) {
     // Initialize queue
     memset(&rx_queue, 0, sizeof(rx_queue));
     memset(&eth_stats, 0, sizeof(eth_stats));
+    spsc_ring_init(&rx_queue.ring, RX_QUEUE_SIZE);
 
     // Register interrupt handler
     if (interrupt_register_handler(ETH_GIC_IRQ, ethernet_irq_handler, NULL) < 0) {
@@ -170,31 +176,17 @@ int ethernet_irq_init(void) {
 int ethernet_irq_receive(ethernet_frame_t *frame, uint16_t *length) {
     if (!frame || !length) return -1;
 
-    // Disable interrupts briefly to access queue
-    interrupt_disable(ETH_GIC_IRQ);
-
-    if (rx_queue.count == 0) {
-        interrupt_enable(ETH_GIC_IRQ);
+    uint32_t slot;
+    if (spsc_ring_peek(&rx_queue.ring, &slot) < 0) {
         return -1; // No packets
     }
 
     // Dequeue packet
-    uint32_t head_idx = rx_queue.head;
-
-    if (rx_queue.queue[head_idx].valid) {
-        memcpy(frame, &rx_queue.queue[head_idx].frame, sizeof(ethernet_frame_t));
-        *length = rx_queue.queue[head_idx].length;
-
-        rx_queue.queue[head_idx].valid = 0;
-        rx_queue.head = (rx_queue.head + 1) % RX_QUEUE_SIZE;
-        rx_queue.count--;
-
-        interrupt_enable(ETH_GIC_IRQ);
-        return 0;
-    }
+    memcpy(frame, &rx_queue.queue[slot].frame, sizeof(ethernet_frame_t));
+    *length = rx_queue.queue[slot].length;
+    spsc_ring_release(&rx_queue.ring);
 
-    interrupt_enable(ETH_GIC_IRQ);
-    return -1;
+    return 0;
 }
 
 // Dequeue with timeout
@@ -215,14 +207,29 @@ int ethernet_irq_receive_timeout(ethernet_frame_t *frame, uint16_t *length, uint
 
 // Check if packets are available
 int ethernet_irq_available(void) {
-    return rx_queue.count;
+    return spsc_ring_count(&rx_queue.ring);
+}
+
+void ethernet_irq_notify(async_event_t *ready) {
+    async_event_init(ready);
+    rx_waiter = ready;
+
+    // A frame queued before the waiter was published would never signal it
+    if (spsc_ring_count(&rx_queue.ring) && rx_waiter == ready) {
+        rx_waiter = NULL;
+        async_event_signal(ready, 0);
+    }
 }
 
 // Flush receive queue
 void ethernet_irq_flush(void) {
+    // Producer must be quiet while both indices are rewound
     interrupt_disable(ETH_GIC_IRQ);
 
-    memset(&rx_queue, 0, sizeof(rx_queue));
+    spsc_ring_reset(&rx_queue.ring);
+    rx_queue.dropped = 0;
+    rx_queue.errors = 0;
+    rx_queue.interrupts = 0;
 
     interrupt_enable(ETH_GIC_IRQ);
 }
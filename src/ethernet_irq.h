@@ -5,6 +5,7 @@
 
 #include <stdint.h>
 #include "ethernet.h"
+#include "async.h"
 
 // Initialize interrupt-driven Ethernet reception
 int ethernet_irq_init(void);
@@ -18,6 +19,10 @@ int ethernet_irq_receive_timeout(ethernet_frame_t *frame, uint16_t *length, uint
 // Check if packets are available in queue
 int ethernet_irq_available(void);
 
+// Signal 'ready' once a frame is queued (immediately if one already is);
+// one-shot, re-arm after each wakeup
+void ethernet_irq_notify(async_event_t *ready);
+
 // Flush receive queue
 void ethernet_irq_flush(void);
 
@@ -0,0 +1,140 @@
+/* AArch64 Exception Vectors and Handlers */
+
+#include <stdint.h>
+#include "exception.h"
+#include "interrupt.h"
+#include "atomic.h"
+#include "uart.h"
+
+extern char exception_vector_table[];
+
+static exception_stats_t exc_stats;
+
+static uint32_t current_el(void) {
+    uint64_t el;
+    __asm__ volatile("mrs %0, CurrentEL" : "=r"(el));
+    return (el >> 2) & 3;
+}
+
+static uint64_t read_esr(void) {
+    uint64_t esr;
+    switch (current_el()) {
+        case 3:  __asm__ volatile("mrs %0, esr_el3" : "=r"(esr)); break;
+        case 2:  __asm__ volatile("mrs %0, esr_el2" : "=r"(esr)); break;
+        default: __asm__ volatile("mrs %0, esr_el1" : "=r"(esr)); break;
+    }
+    return esr;
+}
+
+static uint64_t read_far(void) {
+    uint64_t far;
+    switch (current_el()) {
+        case 3:  __asm__ volatile("mrs %0, far_el3" : "=r"(far)); break;
+        case 2:  __asm__ volatile("mrs %0, far_el2" : "=r"(far)); break;
+        default: __asm__ volatile("mrs %0, far_el1" : "=r"(far)); break;
+    }
+    return far;
+}
+
+static void print_hex(uint64_t value) {
+    uart_puts("0x");
+    for (int i = 60; i >= 0; i -= 4) {
+        uint32_t nibble = (value >> i) & 0xF;
+        uart_putc(nibble < 10 ? '0' + nibble : 'A' + nibble - 10);
+    }
+}
+
+static const char *exception_class_name(uint32_t ec) {
+    switch (ec) {
+        case ESR_EC_UNKNOWN:  return "Unknown/undefined instruction";
+        case ESR_EC_SVC64:    return "SVC";
+        case ESR_EC_IABT_LOW:
+        case ESR_EC_IABT_CUR: return "Instruction abort";
+        case ESR_EC_PC_ALIGN: return "PC alignment fault";
+        case ESR_EC_DABT_LOW:
+        case ESR_EC_DABT_CUR: return "Data abort";
+        case ESR_EC_SP_ALIGN: return "SP alignment fault";
+        case ESR_EC_BRK64:    return "BRK";
+        default:              return "Other";
+    }
+}
+
+static void dump_frame(const char *what, exception_frame_t *frame, uint64_t esr) {
+    uart_puts("\n*** EXCEPTION: ");
+    uart_puts(what);
+    uart_puts(" ***\n  ESR: ");
+    print_hex(esr);
+    uart_puts("\n  ELR: ");
+    print_hex(frame->elr);
+    uart_puts("\n  FAR: ");
+    print_hex(read_far());
+    uart_puts("\n  SPSR: ");
+    print_hex(frame->spsr);
+    uart_puts("\n  LR: ");
+    print_hex(frame->x[30]);
+    uart_puts("\n");
+}
+
+static void halt(void) {
+    while (1) {
+        __asm__ volatile("wfe");
+    }
+}
+
+void exception_init(void) {
+    uint64_t vbar = (uint64_t)(uintptr_t)exception_vector_table;
+
+    switch (current_el()) {
+        case 3:  __asm__ volatile("msr vbar_el3, %0" : : "r"(vbar)); break;
+        case 2:  __asm__ volatile("msr vbar_el2, %0" : : "r"(vbar)); break;
+        default: __asm__ volatile("msr vbar_el1, %0" : : "r"(vbar)); break;
+    }
+    __asm__ volatile("isb");
+}
+
+void exception_handle_sync(exception_frame_t *frame) {
+    atomic_fetch_add_32(&exc_stats.sync, 1, ATOMIC_RELAXED);
+
+    uint64_t esr = read_esr();
+    uint32_t ec = (esr >> ESR_EC_SHIFT) & 0x3F;
+
+    // BRK is a debug breakpoint: report and continue after it
+    if (ec == ESR_EC_BRK64) {
+        dump_frame(exception_class_name(ec), frame, esr);
+        frame->elr += 4;
+        return;
+    }
+
+    dump_frame(exception_class_name(ec), frame, esr);
+    halt();
+}
+
+void exception_handle_irq(exception_frame_t *frame) {
+    atomic_fetch_add_32(&exc_stats.irq, 1, ATOMIC_RELAXED);
+    interrupt_dispatch(frame->entry_ticks);
+}
+
+void exception_handle_fiq(exception_frame_t *frame) {
+    // Nothing is routed to FIQ on purpose; treat it like an IRQ
+    atomic_fetch_add_32(&exc_stats.fiq, 1, ATOMIC_RELAXED);
+    interrupt_dispatch(frame->entry_ticks);
+}
+
+void exception_handle_serror(exception_frame_t *frame) {
+    atomic_fetch_add_32(&exc_stats.serror, 1, ATOMIC_RELAXED);
+    dump_frame("SError", frame, read_esr());
+    halt();
+}
+
+void exception_handle_unexpected(exception_frame_t *frame, uint32_t vector) {
+    atomic_fetch_add_32(&exc_stats.unexpected, 1, ATOMIC_RELAXED);
+    uart_puts("\n*** Unexpected exception vector ");
+    uart_putc(vector < 10 ? '0' + vector : 'A' + vector - 10);
+    uart_puts(" ***");
+    dump_frame("unexpected", frame, read_esr());
+    halt();
+}
+
+const exception_stats_t *exception_get_stats(void) {
+    return &exc_stats;
+}
@@ -0,0 +1,92 @@
+/* AArch64 Exception Vectors and Handlers */
+
+#ifndef EXCEPTION_H
+#define EXCEPTION_H
+
+#include <stdint.h>
+
+// Vector table slot groups (offset / 0x200) and entry types (offset % 0x200 / 0x80)
+#define EXC_GROUP_CUR_SP0       0   // Current EL, SP_EL0
+#define EXC_GROUP_CUR_SPX       1   // Current EL, SP_ELx (normal for this bootloader)
+#define EXC_GROUP_LOWER_A64     2   // Lower EL, AArch64
+#define EXC_GROUP_LOWER_A32     3   // Lower EL, AArch32
+
+#define EXC_TYPE_SYNC           0
+#define EXC_TYPE_IRQ            1
+#define EXC_TYPE_FIQ            2
+#define EXC_TYPE_SERROR         3
+
+// Register frame pushed by the vector entry code (layout shared with start.S)
+typedef struct {
+    uint64_t x[31];         // x0-x30
+    uint64_t elr;           // Return address
+    uint64_t spsr;          // Saved PSTATE
+    uint64_t entry_ticks;   // CNTPCT_EL0 at vector entry
+} exception_frame_t;
+
+#define EXC_FRAME_SIZE  (34 * 8)    // Keep in sync with start.S
+
+// ESR exception classes of interest
+#define ESR_EC_SHIFT            26
+#define ESR_EC_UNKNOWN          0x00
+#define ESR_EC_SVC64            0x15
+#define ESR_EC_IABT_LOW         0x20
+#define ESR_EC_IABT_CUR         0x21
+#define ESR_EC_PC_ALIGN         0x22
+#define ESR_EC_DABT_LOW         0x24
+#define ESR_EC_DABT_CUR         0x25
+#define ESR_EC_SP_ALIGN         0x26
+#define ESR_EC_BRK64            0x3C
+
+// Exception counts (all cores)
+typedef struct {
+    uint32_t sync;
+    uint32_t irq;
+    uint32_t fiq;
+    uint32_t serror;
+    uint32_t unexpected;    // Taken from SP_EL0 or a lower EL
+} exception_stats_t;
+
+// Install the vector table for the calling core (VBAR at the current EL)
+void exception_init(void);
+
+// C entry points (called from start.S with the saved frame)
+void exception_handle_sync(exception_frame_t *frame);
+void exception_handle_irq(exception_frame_t *frame);
+void exception_handle_fiq(exception_frame_t *frame);
+void exception_handle_serror(exception_frame_t *frame);
+void exception_handle_unexpected(exception_frame_t *frame, uint32_t vector);
+
+const exception_stats_t *exception_get_stats(void);
+
+// Interrupt mask helpers (PSTATE.I for this core)
+static inline void irq_enable(void) {
+    __asm__ volatile("msr daifclr, #2" : : : "memory");
+}
+
+static inline void irq_disable(void) {
+    __asm__ volatile("msr daifset, #2" : : : "memory");
+}
+
+static inline uint64_t irq_save(void) {
+    uint64_t flags;
+    __asm__ volatile("mrs %0, daif\n\tmsr daifset, #2" : "=r"(flags) : : "memory");
+    return flags;
+}
+
+static inline void irq_restore(uint64_t flags) {
+    __asm__ volatile("msr daif, %0" : : "r"(flags) : "memory");
+}
+
+static inline int irq_masked(void) {
+    uint64_t daif;
+    __asm__ volatile("mrs %0, daif" : "=r"(daif));
+    return (daif >> 7) & 1;
+}
+
+// Sleep until an interrupt is pending; with IRQs masked it is taken on unmask
+static inline void irq_wait(void) {
+    __asm__ volatile("wfi");
+}
+
+#endif
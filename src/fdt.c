@@ -15,6 +15,17 @@ static void *memcpy(void *dest, const void *src, uint32_t n) {
     return dest;
 }
 
+static void *memmove(void *dest, const void *src, uint32_t n) {
+    unsigned char *d = dest;
+    const unsigned char *s = src;
+    if (d < s) {
+        while (n--) *d++ = *s++;
+    } else {
+        while (n--) d[n] = s[n];
+    }
+    return dest;
+}
+
 static void *memset(void *s, int c, uint32_t n) {
     unsigned char *p = s;
     while (n--) *p++ = c;
@@ -37,6 +48,14 @@ static uint32_t strlen(const char *s) {
     return len;
 }
 
+// 'len' bytes equal, terminating NUL included
+static int names_equal(const char *a, const char *b, uint32_t len) {
+    while (len--) {
+        if (*a++ != *b++) return 0;
+    }
+    return 1;
+}
+
 // Byte swapping for big-endian FDT
 static uint32_t fdt32_to_cpu(uint32_t x) {
     return ((x & 0xFF000000) >> 24) |
@@ -63,6 +82,17 @@ static inline uint32_t align_up(uint32_t x, uint32_t align) {
     return (x + align - 1) & ~(align - 1);
 }
 
+static inline const uint32_t *align_ptr(const void *p) {
+    return (const uint32_t *)(((uintptr_t)p + 3) & ~(uintptr_t)3);
+}
+
+// First token after a node's BEGIN_NODE tag and name
+static const uint32_t *skip_node_name(const uint32_t *ptr) {
+    const char *name = (const char *)(ptr + 1);
+    while (*name) name++;
+    return align_ptr(name + 1);
+}
+
 // Get pointer to FDT structure block
 static const uint32_t *fdt_get_struct(const void *fdt, uint32_t offset) {
     const fdt_header_t *hdr = (const fdt_header_t *)fdt;
@@ -115,43 +145,35 @@ uint32_t fdt_get_totalsize(const void *fdt) {
     return fdt32_to_cpu(hdr->totalsize);
 }
 
-// Find next node in tree
+// Next node in document order after the one at 'offset'. *depth goes up
+// by one into a child and down by one per node closed on the way, so a
+// result with *depth <= 0 is no longer below the starting node
 int fdt_next_node(const void *fdt, int offset, int *depth) {
     const fdt_header_t *hdr = (const fdt_header_t *)fdt;
-    uint32_t struct_size = fdt32_to_cpu(hdr->size_dt_struct);
+    const char *base = (const char *)fdt_get_struct(fdt, 0);
+    const char *end = base + fdt32_to_cpu(hdr->size_dt_struct);
     const uint32_t *ptr = fdt_get_struct(fdt, offset);
-    int current_depth = depth ? *depth : 0;
 
-    while ((const char *)ptr < (const char *)fdt + fdt32_to_cpu(hdr->off_dt_struct) + struct_size) {
+    if (offset < 0 || (const char *)ptr >= end || fdt32_to_cpu(*ptr) != FDT_BEGIN_NODE) {
+        return FDT_ERR_BADOFFSET;
+    }
+    ptr = skip_node_name(ptr);
+
+    while ((const char *)ptr < end) {
         uint32_t tag = fdt32_to_cpu(*ptr);
 
         switch (tag) {
             case FDT_BEGIN_NODE:
-                if (offset > 0) {
-                    current_depth++;
-                    if (depth) *depth = current_depth;
-                    return (const char *)ptr - (const char *)fdt_get_struct(fdt, 0);
-                }
-                // Skip node name
-                ptr++;
-                while (*(const char *)ptr) ptr = (const uint32_t *)((const char *)ptr + 1);
-                ptr = (const uint32_t *)align_up((uint32_t)(const char *)ptr + 1, 4);
-                offset = (const char *)ptr - (const char *)fdt_get_struct(fdt, 0);
-                break;
+                if (depth) (*depth)++;
+                return (const char *)ptr - base;
 
             case FDT_END_NODE:
-                current_depth--;
-                if (current_depth < 0) return FDT_ERR_BADSTRUCTURE;
+                if (depth) (*depth)--;
                 ptr++;
                 break;
 
             case FDT_PROP:
-                ptr++; // Skip tag
-                ptr += 2; // Skip len and nameoff
-                {
-                    uint32_t len = fdt32_to_cpu(*(ptr - 2));
-                    ptr = (const uint32_t *)align_up((uint32_t)ptr + len, 4);
-                }
+                ptr = align_ptr((const char *)(ptr + 3) + fdt32_to_cpu(ptr[1]));
                 break;
 
             case FDT_NOP:
@@ -171,20 +193,14 @@ int fdt_next_node(const void *fdt, int offset, int *depth) {
 
 // Get property
 const void *fdt_getprop(const void *fdt, int node_offset, const char *name, int *len) {
-    const fdt_header_t *hdr = (const fdt_header_t *)fdt;
     const uint32_t *ptr = fdt_get_struct(fdt, node_offset);
 
-    // Skip BEGIN_NODE tag
-    uint32_t tag = fdt32_to_cpu(*ptr++);
-    if (tag != FDT_BEGIN_NODE) return NULL;
-
-    // Skip node name
-    while (*(const char *)ptr) ptr = (const uint32_t *)((const char *)ptr + 1);
-    ptr = (const uint32_t *)align_up((uint32_t)(const char *)ptr + 1, 4);
+    if (fdt32_to_cpu(*ptr) != FDT_BEGIN_NODE) return NULL;
+    ptr = skip_node_name(ptr);
 
     // Search properties
     while (1) {
-        tag = fdt32_to_cpu(*ptr++);
+        uint32_t tag = fdt32_to_cpu(*ptr++);
 
         if (tag == FDT_PROP) {
             uint32_t prop_len = fdt32_to_cpu(*ptr++);
@@ -196,7 +212,7 @@ const void *fdt_getprop(const void *fdt, int node_offset, const char *name, int
                 return ptr;
             }
 
-            ptr = (const uint32_t *)align_up((uint32_t)ptr + prop_len, 4);
+            ptr = align_ptr((const char *)ptr + prop_len);
         } else if (tag == FDT_BEGIN_NODE || tag == FDT_END_NODE) {
             break;
         } else if (tag == FDT_NOP) {
@@ -253,7 +269,6 @@ int fdt_path_offset(const void *fdt, const char *path) {
     if (path[1] == '\0') return 0; // Root node
 
     int offset = 0;
-    int depth = 0;
     const char *path_ptr = path + 1; // Skip initial '/'
 
     while (*path_ptr) {
@@ -263,19 +278,22 @@ int fdt_path_offset(const void *fdt, const char *path) {
 
         uint32_t component_len = next_slash - path_ptr;
 
-        // Find matching child node
-        offset = fdt_next_node(fdt, offset, &depth);
-        while (offset >= 0) {
+        // Find the matching child; "name" also matches "name@unit"
+        int depth = 0;
+        int child = fdt_next_node(fdt, offset, &depth);
+        while (child >= 0 && depth > 0) {
             int name_len;
-            const char *node_name = fdt_get_name(fdt, offset, &name_len);
+            const char *node_name = fdt_get_name(fdt, child, &name_len);
 
-            if (node_name && name_len == component_len &&
-                strncmp(node_name, path_ptr, component_len) == 0) {
+            if (depth == 1 && node_name && (uint32_t)name_len >= component_len &&
+                strncmp(node_name, path_ptr, component_len) == 0 &&
+                (node_name[component_len] == '\0' || node_name[component_len] == '@')) {
                 break; // Found
             }
 
-            offset = fdt_next_node(fdt, offset, &depth);
+            child = fdt_next_node(fdt, child, &depth);
         }
+        offset = (child >= 0 && depth > 0) ? child : FDT_ERR_NOTFOUND;
 
         if (offset < 0) return FDT_ERR_NOTFOUND;
 
@@ -293,24 +311,269 @@ int fdt_get_reg(const void *fdt, int node_offset, int index, uint64_t *addr, uin
     const uint32_t *reg = (const uint32_t *)fdt_getprop(fdt, node_offset, "reg", &len);
     if (!reg) return FDT_ERR_NOTFOUND;
 
-    // Assume #address-cells=2 and #size-cells=1 for now (common for Pi)
-    int cells_per_entry = 3; // 2 for address, 1 for size
+    // Cell counts are the parent's; the spec's defaults (2 and 1) when it
+    // gives none, which is also the Pi firmware's layout
+    int parent = fdt_parent_offset(fdt, node_offset);
+    uint32_t addr_cells = 2;
+    uint32_t size_cells = 1;
+    if (parent >= 0 && fdt_getprop(fdt, parent, "#address-cells", NULL)) {
+        addr_cells = fdt_getprop_u32(fdt, parent, "#address-cells");
+    }
+    if (parent >= 0 && fdt_getprop(fdt, parent, "#size-cells", NULL)) {
+        size_cells = fdt_getprop_u32(fdt, parent, "#size-cells");
+    }
+    if (addr_cells == 0 || addr_cells > 2 || size_cells > 2) return FDT_ERR_BADSTRUCTURE;
+
+    int cells_per_entry = addr_cells + size_cells;
     int offset_cells = index * cells_per_entry;
 
-    if (offset_cells * 4 + 12 > len) return FDT_ERR_NOTFOUND;
+    if ((offset_cells + cells_per_entry) * 4 > len) return FDT_ERR_NOTFOUND;
+
+    const uint32_t *cell = reg + offset_cells;
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < addr_cells; i++) value = (value << 32) | fdt32_to_cpu(*cell++);
+    if (addr) *addr = value;
+
+    value = 0;
+    for (uint32_t i = 0; i < size_cells; i++) value = (value << 32) | fdt32_to_cpu(*cell++);
+    if (size) *size = value;
+
+    return 0;
+}
+
+// Move the blob into 'buf' (may overlap it) and make the rest of the buffer
+// free space for the editing calls below. Blocks must be in the usual
+// order: reserve map, structure, strings
+int fdt_open_into(const void *fdt, void *buf, int bufsize) {
+    fdt_header_t hdr;
+    int err = fdt_check_header(fdt);
+    if (err) return err;
+
+    fdt_get_header(fdt, &hdr);
+    if (hdr.off_mem_rsvmap > hdr.off_dt_struct ||
+        hdr.off_dt_struct + hdr.size_dt_struct > hdr.off_dt_strings ||
+        hdr.off_dt_strings + hdr.size_dt_strings > hdr.totalsize) {
+        return FDT_ERR_BADSTRUCTURE;
+    }
+    if (bufsize < 0 || (uint32_t)bufsize < hdr.totalsize) return FDT_ERR_NOSPACE;
+
+    memmove(buf, fdt, hdr.totalsize);
+    ((fdt_header_t *)buf)->totalsize = cpu_to_fdt32(bufsize);
+    return 0;
+}
+
+// Open a gap of 'delta' bytes (negative closes one) at 'at'; the blocks
+// after it move along
+static int fdt_splice(void *fdt, char *at, int delta) {
+    fdt_header_t *hdr = (fdt_header_t *)fdt;
+    uint32_t at_off = at - (char *)fdt;
+    uint32_t off_struct = fdt32_to_cpu(hdr->off_dt_struct);
+    uint32_t off_strings = fdt32_to_cpu(hdr->off_dt_strings);
+    uint32_t used = off_strings + fdt32_to_cpu(hdr->size_dt_strings);
+
+    if (delta > 0 && used + delta > fdt32_to_cpu(hdr->totalsize)) return FDT_ERR_NOSPACE;
+
+    memmove(at + delta, at, used - at_off);
+    if (off_struct > at_off) hdr->off_dt_struct = cpu_to_fdt32(off_struct + delta);
+    if (off_strings >= at_off) hdr->off_dt_strings = cpu_to_fdt32(off_strings + delta);
+    return 0;
+}
 
-    if (addr) {
-        *addr = ((uint64_t)fdt32_to_cpu(reg[offset_cells]) << 32) |
-                fdt32_to_cpu(reg[offset_cells + 1]);
+// Same, inside the structure block
+static int fdt_splice_struct(void *fdt, char *at, int delta) {
+    fdt_header_t *hdr = (fdt_header_t *)fdt;
+    int err = fdt_splice(fdt, at, delta);
+    if (err) return err;
+
+    hdr->size_dt_struct = cpu_to_fdt32(fdt32_to_cpu(hdr->size_dt_struct) + delta);
+    return 0;
+}
+
+// Offset of 'name' in the strings block, appending it if it is not there
+static int fdt_find_add_string(void *fdt, const char *name) {
+    fdt_header_t *hdr = (fdt_header_t *)fdt;
+    char *strings = (char *)fdt + fdt32_to_cpu(hdr->off_dt_strings);
+    uint32_t size = fdt32_to_cpu(hdr->size_dt_strings);
+    uint32_t len = strlen(name) + 1;
+
+    for (uint32_t off = 0; off + len <= size; off++) {
+        if (names_equal(strings + off, name, len)) return off;
+    }
+
+    if (fdt32_to_cpu(hdr->off_dt_strings) + size + len > fdt32_to_cpu(hdr->totalsize)) {
+        return FDT_ERR_NOSPACE;
+    }
+    memcpy(strings + size, name, len);
+    hdr->size_dt_strings = cpu_to_fdt32(size + len);
+    return size;
+}
+
+// Set (create or resize) a property; needs free space from fdt_open_into()
+int fdt_setprop(void *fdt, int node_offset, const char *name, const void *val, int len) {
+    if (len < 0) return FDT_ERR_BADSTRUCTURE;
+
+    uint32_t *ptr = (uint32_t *)fdt_get_struct(fdt, node_offset);
+    if (fdt32_to_cpu(*ptr) != FDT_BEGIN_NODE) return FDT_ERR_BADOFFSET;
+
+    uint32_t *first = (uint32_t *)skip_node_name(ptr);
+    uint32_t *prop = first;
+    uint32_t new_space = align_up(len, 4);
+    int err;
+
+    // Existing property: resize it in place
+    while (1) {
+        uint32_t tag = fdt32_to_cpu(*prop);
+        if (tag == FDT_NOP) {
+            prop++;
+            continue;
+        }
+        if (tag != FDT_PROP) {
+            prop = NULL;
+            break;
+        }
+        uint32_t old_len = fdt32_to_cpu(prop[1]);
+        if (strcmp(fdt_get_string(fdt, fdt32_to_cpu(prop[2])), name) == 0) {
+            int delta = (int)new_space - (int)align_up(old_len, 4);
+            if (delta != 0) {
+                err = fdt_splice_struct(fdt, (char *)(prop + 3) + align_up(old_len, 4), delta);
+                if (err) return err;
+            }
+            break;
+        }
+        prop = (uint32_t *)align_ptr((const char *)(prop + 3) + old_len);
     }
 
-    if (size) {
-        *size = fdt32_to_cpu(reg[offset_cells + 2]);
+    // New property: name into the strings block, then a slot before the
+    // node's other properties
+    if (!prop) {
+        int nameoff = fdt_find_add_string(fdt, name);
+        if (nameoff < 0) return nameoff;
+
+        err = fdt_splice_struct(fdt, (char *)first, 12 + new_space);
+        if (err) return err;
+
+        prop = first;
+        prop[0] = cpu_to_fdt32(FDT_PROP);
+        prop[2] = cpu_to_fdt32(nameoff);
     }
 
+    prop[1] = cpu_to_fdt32(len);
+    memset((char *)(prop + 3) + len, 0, new_space - len);
+    memcpy(prop + 3, val, len);
     return 0;
 }
 
+int fdt_setprop_u32(void *fdt, int node_offset, const char *name, uint32_t val) {
+    uint32_t be = cpu_to_fdt32(val);
+    return fdt_setprop(fdt, node_offset, name, &be, sizeof(be));
+}
+
+int fdt_setprop_u64(void *fdt, int node_offset, const char *name, uint64_t val) {
+    uint64_t be = cpu_to_fdt64(val);
+    return fdt_setprop(fdt, node_offset, name, &be, sizeof(be));
+}
+
+// Reserve map entries: (address, size) pairs up to a zero-size terminator
+static uint64_t *fdt_mem_rsv(const void *fdt, int n) {
+    const fdt_header_t *hdr = (const fdt_header_t *)fdt;
+    return (uint64_t *)((char *)fdt + fdt32_to_cpu(hdr->off_mem_rsvmap)) + 2 * n;
+}
+
+int fdt_num_mem_rsv(const void *fdt) {
+    int n = 0;
+    while (fdt64_to_cpu(fdt_mem_rsv(fdt, n)[1]) != 0) n++;
+    return n;
+}
+
+int fdt_get_mem_rsv(const void *fdt, int n, uint64_t *address, uint64_t *size) {
+    if (n < 0 || n >= fdt_num_mem_rsv(fdt)) return FDT_ERR_NOTFOUND;
+
+    const uint64_t *entry = fdt_mem_rsv(fdt, n);
+    *address = fdt64_to_cpu(entry[0]);
+    *size = fdt64_to_cpu(entry[1]);
+    return 0;
+}
+
+// Append a reserve map entry (needs free space from fdt_open_into())
+int fdt_add_mem_rsv(void *fdt, uint64_t address, uint64_t size) {
+    uint64_t *entry = fdt_mem_rsv(fdt, fdt_num_mem_rsv(fdt));
+    int err = fdt_splice(fdt, (char *)entry, 16);
+    if (err) return err;
+
+    entry[0] = cpu_to_fdt64(address);
+    entry[1] = cpu_to_fdt64(size);
+    return 0;
+}
+
+int fdt_first_subnode(const void *fdt, int parent_offset) {
+    int depth = 0;
+    int offset = fdt_next_node(fdt, parent_offset, &depth);
+    return (offset >= 0 && depth == 1) ? offset : FDT_ERR_NOTFOUND;
+}
+
+int fdt_next_subnode(const void *fdt, int offset) {
+    int depth = 1;
+
+    // Skip the node's own descendants
+    do {
+        offset = fdt_next_node(fdt, offset, &depth);
+        if (offset < 0 || depth < 1) return FDT_ERR_NOTFOUND;
+    } while (depth > 1);
+
+    return offset;
+}
+
+// Walks from the root keeping the open node at each depth; there is no
+// back link in the structure block
+#define FDT_MAX_DEPTH 32
+
+int fdt_parent_offset(const void *fdt, int offset) {
+    int stack[FDT_MAX_DEPTH];
+    int depth = 0;
+    int node = 0;
+
+    if (offset <= 0) return FDT_ERR_NOTFOUND;   // The root has no parent
+
+    stack[0] = 0;
+    while ((node = fdt_next_node(fdt, node, &depth)) >= 0) {
+        if (depth <= 0 || depth >= FDT_MAX_DEPTH) return FDT_ERR_BADSTRUCTURE;
+        stack[depth] = node;
+        if (node == offset) return stack[depth - 1];
+    }
+
+    return FDT_ERR_NOTFOUND;
+}
+
+// Add an empty child after the parent's properties; returns its offset
+int fdt_add_subnode(void *fdt, int parent_offset, const char *name) {
+    uint32_t *ptr = (uint32_t *)fdt_get_struct(fdt, parent_offset);
+    if (fdt32_to_cpu(*ptr) != FDT_BEGIN_NODE) return FDT_ERR_BADOFFSET;
+
+    // Properties must come before subnodes
+    ptr = (uint32_t *)skip_node_name(ptr);
+    while (1) {
+        uint32_t tag = fdt32_to_cpu(*ptr);
+        if (tag == FDT_PROP) {
+            ptr = (uint32_t *)align_ptr((const char *)(ptr + 3) + fdt32_to_cpu(ptr[1]));
+        } else if (tag == FDT_NOP) {
+            ptr++;
+        } else {
+            break;
+        }
+    }
+
+    uint32_t name_space = align_up(strlen(name) + 1, 4);
+    int err = fdt_splice_struct(fdt, (char *)ptr, 8 + name_space);
+    if (err) return err;
+
+    ptr[0] = cpu_to_fdt32(FDT_BEGIN_NODE);
+    memset(ptr + 1, 0, name_space);
+    memcpy(ptr + 1, name, strlen(name));
+    *(uint32_t *)((char *)(ptr + 1) + name_space) = cpu_to_fdt32(FDT_END_NODE);
+
+    return (char *)ptr - (char *)fdt_get_struct(fdt, 0);
+}
+
 // Dump FDT for debugging
 void fdt_dump(const void *fdt) {
     fdt_header_t hdr;
@@ -2,9 +2,10 @@
 
 #include <stdint.h>
 #include "gpio.h"
+#include "platform.h"
 
-// BCM2837 GPIO (QEMU raspi3b)
-#define GPIO_BASE 0x3F200000
+// BCM GPIO (platform.h)
+#define GPIO_BASE PLATFORM_GPIO_BASE
 
 #define GPIO_GPFSEL0 (GPIO_BASE + 0x00)  // Function Select 0
 #define GPIO_GPFSEL1 (GPIO_BASE + 0x04)  // Function Select 1
@@ -17,12 +18,16 @@
 #define GPIO_GPCLR0  (GPIO_BASE + 0x28)  // Pin Output Clear 0
 #define GPIO_GPCLR1  (GPIO_BASE + 0x2C)  // Pin Output Clear 1
 
+// Machines without the BCM GPIO block (QEMU virt) have nothing to drive:
+// writes are dropped and pins read low
 static inline void mmio_write(uint32_t reg, uint32_t data) {
-    *(volatile uint32_t*)reg = data;
+    if (!PLATFORM_HAS_VIDEOCORE) return;
+    *(volatile uint32_t*)(uintptr_t)reg = data;
 }
 
 static inline uint32_t mmio_read(uint32_t reg) {
-    return *(volatile uint32_t*)reg;
+    if (!PLATFORM_HAS_VIDEOCORE) return 0;
+    return *(volatile uint32_t*)(uintptr_t)reg;
 }
 
 void gpio_init(void) {
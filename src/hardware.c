@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include "hardware.h"
 #include "mailbox.h"
+#include "platform.h"
 
 // Current model - detected at runtime
 pi_model_t current_pi_model = PI_MODEL_UNKNOWN;
@@ -259,168 +260,108 @@ static const pi_model_info_t model_info_table[] = {
     }
 };
 
-uint32_t get_uart_base(void) {
-    switch (current_pi_model) {
-        // BCM2835 models (Pi 1, Zero, Zero W)
-        case PI_MODEL_1A:
-        case PI_MODEL_1B:
-        case PI_MODEL_1A_PLUS:
-        case PI_MODEL_1B_PLUS:
-        case PI_MODEL_ZERO:
-        case PI_MODEL_ZERO_W:
-            return UART_BASE_BCM2835;
+#ifdef SOC_GENERIC
 
-        // BCM2837 models (Pi 2, 3, Zero 2 W)
-        case PI_MODEL_2B:
-        case PI_MODEL_3B:
-        case PI_MODEL_3B_PLUS:
-        case PI_MODEL_3A_PLUS:
-        case PI_MODEL_ZERO_2_W:
-            return UART_BASE_BCM2837;
+// Every 64-bit Pi by CPU: MIDR_EL1 is readable before any peripheral is,
+// and the mailbox that knows the board model needs its base first. The
+// Pi 5 (Cortex-A76) is not covered: its peripherals and GIC sit above
+// 4GB, outside the identity map
+#define MIDR_PART(midr)         (((midr) >> 4) & 0xFFF)
+#define MIDR_PART_CORTEX_A53    0xD03   // BCM2837
+#define MIDR_PART_CORTEX_A72    0xD08   // BCM2711
 
-        // BCM2711 models (Pi 4, 400)
-        case PI_MODEL_4B:
-        case PI_MODEL_400:
-            return UART_BASE_BCM2711;
+static const soc_bases_t soc_layout_bcm2711 = {
+    PERIPHERAL_BASE_BCM2711, UART_BASE_BCM2711, GPIO_BASE_BCM2711, TIMER_BASE_BCM2711,
+    EMMC_BASE_BCM2711, ARM_TIMER_BASE_BCM2711, PM_BASE_BCM2711, MAILBOX_BASE_BCM2711, 0
+};
 
-        // BCM2712 models (Pi 5)
-        case PI_MODEL_5B:
-            return UART_BASE_BCM2712;
+// BCM2837 unless the CPU says otherwise. In .data, not .bss: start.S
+// resolves it before the image is copied, and the copy keeps it
+soc_bases_t soc_bases = {
+    PERIPHERAL_BASE_BCM2837, UART_BASE_BCM2837, GPIO_BASE_BCM2837, TIMER_BASE_BCM2837,
+    EMMC_BASE_BCM2837, ARM_TIMER_BASE_BCM2837, PM_BASE_BCM2837, MAILBOX_BASE_BCM2837, 1
+};
 
+void platform_init(void) {
+    const soc_bases_t *layout;
+    uint64_t midr;
+
+    __asm__ volatile("mrs %0, midr_el1" : "=r"(midr));
+    switch (MIDR_PART(midr)) {
+        case MIDR_PART_CORTEX_A53: return;
+        case MIDR_PART_CORTEX_A72: layout = &soc_layout_bcm2711; break;
         default:
-            return UART_BASE_BCM2711; // Default to Pi 4 addresses
+            // Any other core is on a SoC with no table here, where the
+            // BCM2837 bases could be anything: halt before the first
+            // access. There is no UART known to say so on
+            while (1) {
+                __asm__ volatile("wfe");
+            }
+    }
+
+    // Word by word: no memcpy this early
+    const uint32_t *src = (const uint32_t *)layout;
+    uint32_t *dest = (uint32_t *)&soc_bases;
+    for (uint32_t i = 0; i < sizeof(soc_bases_t) / sizeof(uint32_t); i++) {
+        dest[i] = src[i];
     }
 }
 
-uint32_t get_gpio_base(void) {
-    switch (current_pi_model) {
-        // BCM2835 models
-        case PI_MODEL_1A:
-        case PI_MODEL_1B:
-        case PI_MODEL_1A_PLUS:
-        case PI_MODEL_1B_PLUS:
-        case PI_MODEL_ZERO:
-        case PI_MODEL_ZERO_W:
-            return GPIO_BASE_BCM2835;
+#else
 
-        // BCM2837 models
-        case PI_MODEL_2B:
-        case PI_MODEL_3B:
-        case PI_MODEL_3B_PLUS:
-        case PI_MODEL_3A_PLUS:
-        case PI_MODEL_ZERO_2_W:
-            return GPIO_BASE_BCM2837;
+// Bases are constants (platform.h)
+void platform_init(void) {
+}
 
-        // BCM2711 models
-        case PI_MODEL_4B:
-        case PI_MODEL_400:
-            return GPIO_BASE_BCM2711;
+#endif
 
-        // BCM2712 models
-        case PI_MODEL_5B:
-            return GPIO_BASE_BCM2712;
+uint32_t get_uart_base(void) {
+    return PLATFORM_UART_BASE;
+}
 
-        default:
-            return GPIO_BASE_BCM2711;
-    }
+uint32_t get_gpio_base(void) {
+    return PLATFORM_GPIO_BASE;
 }
 
 uint32_t get_timer_base(void) {
-    switch (current_pi_model) {
-        // BCM2835 models
-        case PI_MODEL_1A:
-        case PI_MODEL_1B:
-        case PI_MODEL_1A_PLUS:
-        case PI_MODEL_1B_PLUS:
-        case PI_MODEL_ZERO:
-        case PI_MODEL_ZERO_W:
-            return TIMER_BASE_BCM2835;
-
-        // BCM2837 models
-        case PI_MODEL_2B:
-        case PI_MODEL_3B:
-        case PI_MODEL_3B_PLUS:
-        case PI_MODEL_3A_PLUS:
-        case PI_MODEL_ZERO_2_W:
-            return TIMER_BASE_BCM2837;
-
-        // BCM2711 models
-        case PI_MODEL_4B:
-        case PI_MODEL_400:
-            return TIMER_BASE_BCM2711;
-
-        // BCM2712 models
-        case PI_MODEL_5B:
-            return TIMER_BASE_BCM2712;
-
-        default:
-            return TIMER_BASE_BCM2711;
-    }
+    return PLATFORM_TIMER_BASE;
 }
 
 uint32_t get_emmc_base(void) {
-    switch (current_pi_model) {
-        // BCM2835 models
-        case PI_MODEL_1A:
-        case PI_MODEL_1B:
-        case PI_MODEL_1A_PLUS:
-        case PI_MODEL_1B_PLUS:
-        case PI_MODEL_ZERO:
-        case PI_MODEL_ZERO_W:
-            return EMMC_BASE_BCM2835;
-
-        // BCM2837 models
-        case PI_MODEL_2B:
-        case PI_MODEL_3B:
-        case PI_MODEL_3B_PLUS:
-        case PI_MODEL_3A_PLUS:
-        case PI_MODEL_ZERO_2_W:
-            return EMMC_BASE_BCM2837;
-
-        // BCM2711 models
-        case PI_MODEL_4B:
-        case PI_MODEL_400:
-            return EMMC_BASE_BCM2711;
-
-        // BCM2712 models
-        case PI_MODEL_5B:
-            return EMMC_BASE_BCM2712;
-
-        default:
-            return EMMC_BASE_BCM2711;
-    }
+    return PLATFORM_EMMC_BASE;
 }
 
 uint32_t get_arm_timer_base(void) {
-    switch (current_pi_model) {
-        // BCM2835 models
-        case PI_MODEL_1A:
-        case PI_MODEL_1B:
-        case PI_MODEL_1A_PLUS:
-        case PI_MODEL_1B_PLUS:
-        case PI_MODEL_ZERO:
-        case PI_MODEL_ZERO_W:
-            return ARM_TIMER_BASE_BCM2835;
-
-        // BCM2837 models
-        case PI_MODEL_2B:
-        case PI_MODEL_3B:
-        case PI_MODEL_3B_PLUS:
-        case PI_MODEL_3A_PLUS:
-        case PI_MODEL_ZERO_2_W:
-            return ARM_TIMER_BASE_BCM2837;
-
-        // BCM2711 models
-        case PI_MODEL_4B:
-        case PI_MODEL_400:
-            return ARM_TIMER_BASE_BCM2711;
+    return PLATFORM_ARM_TIMER_BASE;
+}
 
-        // BCM2712 models
-        case PI_MODEL_5B:
-            return ARM_TIMER_BASE_BCM2712;
+uint32_t get_pm_base(void) {
+    return PLATFORM_PM_BASE;
+}
 
-        default:
-            return ARM_TIMER_BASE_BCM2711;
+// New-style revision codes (bit 23 set) carry the board type in bits 11:4
+pi_model_t pi_get_model(void) {
+    uint32_t revision = mailbox_get_board_revision();
+
+    if (revision == 0) return PI_MODEL_UNKNOWN;
+    if (!(revision & (1 << 23))) return PI_MODEL_1B;    // Old-style codes: Pi 1 only
+
+    switch ((revision >> 4) & 0xFF) {
+        case 0x00: return PI_MODEL_1A;
+        case 0x01: return PI_MODEL_1B;
+        case 0x02: return PI_MODEL_1A_PLUS;
+        case 0x03: return PI_MODEL_1B_PLUS;
+        case 0x04: return PI_MODEL_2B;
+        case 0x08: return PI_MODEL_3B;
+        case 0x09: return PI_MODEL_ZERO;
+        case 0x0C: return PI_MODEL_ZERO_W;
+        case 0x0D: return PI_MODEL_3B_PLUS;
+        case 0x0E: return PI_MODEL_3A_PLUS;
+        case 0x11: return PI_MODEL_4B;
+        case 0x12: return PI_MODEL_ZERO_2_W;
+        case 0x13: return PI_MODEL_400;
+        case 0x17: return PI_MODEL_5B;
+        default:   return PI_MODEL_UNKNOWN;
     }
 }
 
@@ -436,8 +377,6 @@ const pi_model_info_t* hardware_get_model_info(void) {
 }
 
 void hardware_apply_model_tuning(void) {
-    const pi_model_info_t *info = hardware_get_model_info();
-
     // Apply model-specific tuning
     // This could include:
     // - Setting optimal CPU frequency
@@ -465,8 +404,6 @@ uint32_t hardware_get_recommended_uart_baud(void) {
 }
 
 void hardware_apply_model_quirks(void) {
-    const pi_model_info_t *info = hardware_get_model_info();
-
     // Apply model-specific workarounds and quirks
     switch (current_pi_model) {
         case PI_MODEL_1A:
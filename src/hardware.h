@@ -11,6 +11,12 @@
 // BCM2836/BCM2837 (Pi 2, 3, Zero 2): 0x3Fxxxxxx
 // BCM2711/BCM2712 (Pi 4, 5, 400): 0xFExxxxxx
 
+// Peripheral window base addresses (start of Device memory in the MMU map)
+#define PERIPHERAL_BASE_BCM2835 0x20000000  // Pi 1, Zero, Zero W
+#define PERIPHERAL_BASE_BCM2837 0x3F000000  // Pi 2, 3, 3+, 3A+, Zero 2 W
+#define PERIPHERAL_BASE_BCM2711 0xFC000000  // Pi 4, 400 (low peripheral mode)
+#define PERIPHERAL_BASE_BCM2712 0xFC000000  // Pi 5
+
 // UART base addresses
 #define UART_BASE_BCM2835 0x20201000  // Pi 1, Zero, Zero W
 #define UART_BASE_BCM2837 0x3F201000  // Pi 2, 3, 3+, 3A+, Zero 2 W
@@ -42,15 +48,35 @@
 #define ARM_TIMER_BASE_BCM2711 0xFE00B000  // Pi 4, 400
 #define ARM_TIMER_BASE_BCM2712 0xFE00B000  // Pi 5 (same as BCM2711)
 
+// Power management (watchdog, reset status) base addresses
+#define PM_BASE_BCM2835 0x20100000  // Pi 1, Zero, Zero W
+#define PM_BASE_BCM2837 0x3F100000  // Pi 2, 3, 3+, 3A+, Zero 2 W
+#define PM_BASE_BCM2711 0xFE100000  // Pi 4, 400
+#define PM_BASE_BCM2712 0xFE100000  // Pi 5 (same as BCM2711)
+
+// VideoCore property mailbox (ARM side, mailbox 0)
+#define MAILBOX_BASE_BCM2837 0x3F00B880  // Pi 2, 3, 3+, 3A+, Zero 2 W
+#define MAILBOX_BASE_BCM2711 0xFE00B880  // Pi 4, 400
+
+#define IRQ_LEGACY_BASE_BCM2837 0x3F00B200  // BCM2835-style IC (Pi 2, 3, Zero 2 W)
+#define ARM_LOCAL_BASE_BCM2837  0x40000000  // BCM2836 per-core local controller
+#define GIC400_BASE_BCM2711     0xFF840000  // GIC-400 (Pi 4, 400); GICD at +0x1000
+
+// Register offsets used by the default interrupt handlers
+#define ARM_TIMER_IRQCLR_OFFSET 0x40C     // ARM timer IRQ clear/ack
+#define GPIO_GPEDS0_OFFSET      0x40      // GPIO event detect status 0
+
 // Current model
 extern pi_model_t current_pi_model;
 
-// Get base addresses based on model
+// Peripheral bases of the SoC the image was built for (platform.h); no
+// longer looked up per model
 uint32_t get_uart_base(void);
 uint32_t get_gpio_base(void);
 uint32_t get_timer_base(void);
 uint32_t get_emmc_base(void);
 uint32_t get_arm_timer_base(void);
+uint32_t get_pm_base(void);
 
 // Detect and set current Pi model
 void hardware_detect_model(void);
@@ -1,6 +1,7 @@
 /* I2C Controller Implementation for Raspberry Pi */
 
 #include "i2c.h"
+#include "driver.h"
 
 // Helper functions
 static void mmio_write(uint32_t reg, uint32_t data) {
@@ -37,6 +38,13 @@ void i2c_init(uint8_t bus) {
     mmio_write(base + I2C_C, I2C_C_I2CEN);
 }
 
+static int i2c_driver_init(void) {
+    i2c_init(I2C_BUS_0);
+    return 0;
+}
+
+DRIVER_DEFINE(i2c_driver, "i2c", i2c_driver_init, BOOT_PATH_DIAG);
+
 int i2c_write(uint8_t bus, uint8_t addr, const uint8_t *data, uint32_t len) {
     uint32_t base = get_i2c_base(bus);
 
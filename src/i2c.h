@@ -4,6 +4,7 @@
 #define I2C_H
 
 #include <stdint.h>
+#include "driver.h"
 
 // I2C Controller registers (Pi 4)
 #define I2C0_BASE 0xFE804000
@@ -55,4 +56,7 @@ int i2c_read(uint8_t bus, uint8_t addr, uint8_t *data, uint32_t len);
 int i2c_write_reg(uint8_t bus, uint8_t addr, uint8_t reg, uint8_t value);
 int i2c_read_reg(uint8_t bus, uint8_t addr, uint8_t reg, uint8_t *value);
 
+// Lazy driver descriptor (see driver.h)
+extern driver_t i2c_driver;
+
 #endif
\ No newline at end of file
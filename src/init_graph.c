@@ -0,0 +1,191 @@
+/* Dependency-Graph Driver Initialisation */
+
+#include <stdint.h>
+#include "init_graph.h"
+#include "sched.h"
+#include "timer.h"
+#include "atomic.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+static int streq(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static int find_index(const init_graph_t *graph, const char *name) {
+    for (uint32_t i = 0; i < graph->count; i++) {
+        if (streq(graph->nodes[i].name, name)) return (int)i;
+    }
+    return -1;
+}
+
+static uint32_t node_index(const init_graph_t *graph, const init_node_t *node) {
+    return (uint32_t)(node - graph->nodes);
+}
+
+// Scheduler entry: dependencies have finished by construction, only their
+// outcome is left to check. Optional dependencies may fail harmlessly
+static int run_node(void *arg) {
+    init_node_t *node = (init_node_t *)arg;
+
+    for (uint32_t d = 0; d < node->dep_count; d++) {
+        init_node_t *dep = node->dep[d];
+        if (dep->result != 0 && !(dep->flags & INIT_OPTIONAL)) {
+            node->result = INIT_SKIPPED;
+            return node->result;
+        }
+    }
+
+    node->result = node->fn();
+    return node->result;
+}
+
+// Kahn's algorithm; fails on cycles
+static int topo_sort(init_graph_t *graph) {
+    uint8_t indegree[INIT_MAX_NODES];
+    uint32_t head = 0, tail = 0;
+
+    for (uint32_t i = 0; i < graph->count; i++) {
+        indegree[i] = graph->nodes[i].dep_count;
+        if (indegree[i] == 0) graph->order[tail++] = (uint8_t)i;
+    }
+
+    while (head < tail) {
+        init_node_t *done = &graph->nodes[graph->order[head++]];
+        for (uint32_t i = 0; i < graph->count; i++) {
+            init_node_t *node = &graph->nodes[i];
+            for (uint32_t d = 0; d < node->dep_count; d++) {
+                if (node->dep[d] == done && --indegree[i] == 0) {
+                    graph->order[tail++] = (uint8_t)i;
+                }
+            }
+        }
+    }
+
+    return tail == graph->count ? 0 : -1;
+}
+
+int init_graph_start(init_graph_t *graph) {
+    if (!graph || !graph->nodes || graph->count == 0 || graph->count > INIT_MAX_NODES) {
+        return -1;
+    }
+
+    // Resolve names up front so a typo fails the whole graph before
+    // anything has been started
+    for (uint32_t i = 0; i < graph->count; i++) {
+        init_node_t *node = &graph->nodes[i];
+        if (!node->fn) return -1;
+
+        node->dep_count = 0;
+        node->result = INIT_NOT_RUN;
+        for (uint32_t d = 0; d < INIT_MAX_DEPS && node->deps[d]; d++) {
+            int index = find_index(graph, node->deps[d]);
+            if (index < 0 || (uint32_t)index == i) return -1;
+            node->dep[node->dep_count++] = &graph->nodes[index];
+        }
+    }
+
+    if (topo_sort(graph) != 0) return -1;
+
+    for (uint32_t i = 0; i < graph->count; i++) {
+        init_node_t *node = &graph->nodes[i];
+        sched_task_init(&node->task, run_node, node);
+        for (uint32_t d = 0; d < node->dep_count; d++) {
+            if (sched_task_depends_on(&node->task, &node->dep[d]->task) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    graph->phase_cursor = 0;
+    graph->failed = 0;
+    graph->start_us = timer_get_ticks();
+
+    if (graph->report) {
+        graph->report(graph->nodes[0].phase);
+    }
+
+    // Every edge is wired already, so each node becomes ready the moment
+    // its last dependency finishes; roots start right away on any free core
+    for (uint32_t i = 0; i < graph->count; i++) {
+        sched_submit(&graph->nodes[graph->order[i]].task);
+    }
+
+    return 0;
+}
+
+int init_graph_poll(init_graph_t *graph) {
+    while (graph->phase_cursor < graph->count) {
+        init_node_t *node = &graph->nodes[graph->phase_cursor];
+        if (!sched_task_done(&node->task)) return 0;
+
+        if (node->result != 0 && !(node->flags & INIT_OPTIONAL)) {
+            graph->failed++;
+        }
+
+        graph->phase_cursor++;
+        if (graph->phase_cursor < graph->count && graph->report &&
+            graph->nodes[graph->phase_cursor].phase != node->phase) {
+            graph->report(graph->nodes[graph->phase_cursor].phase);
+        }
+    }
+
+    return 1;
+}
+
+int init_graph_run(init_graph_t *graph) {
+    if (init_graph_start(graph) != 0) return -1;
+
+    while (!init_graph_poll(graph)) {
+        if (!sched_run_one()) {
+            cpu_wait_event();
+        }
+    }
+
+    if (graph->failed) {
+        if (graph->report) graph->report(STATE_FAILURE);
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t init_graph_critical_path_us(const init_graph_t *graph) {
+    uint64_t path[INIT_MAX_NODES];
+    uint64_t longest = 0;
+
+    // Topological order guarantees dependencies are settled first
+    for (uint32_t i = 0; i < graph->count; i++) {
+        uint32_t index = graph->order[i];
+        const init_node_t *node = &graph->nodes[index];
+        uint64_t before = 0;
+
+        for (uint32_t d = 0; d < node->dep_count; d++) {
+            uint32_t dep = node_index(graph, node->dep[d]);
+            if (path[dep] > before) before = path[dep];
+        }
+        path[index] = before + (node->task.end_us - node->task.start_us);
+        if (path[index] > longest) longest = path[index];
+    }
+
+    return longest;
+}
+
+uint64_t init_graph_total_us(const init_graph_t *graph) {
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i < graph->count; i++) {
+        total += graph->nodes[i].task.end_us - graph->nodes[i].task.start_us;
+    }
+    return total;
+}
+
+const init_node_t *init_graph_find(const init_graph_t *graph, const char *name) {
+    int index = find_index(graph, name);
+    return index < 0 ? NULL : &graph->nodes[index];
+}
@@ -0,0 +1,71 @@
+/* Dependency-Graph Driver Initialisation */
+
+#ifndef INIT_GRAPH_H
+#define INIT_GRAPH_H
+
+#include <stdint.h>
+#include "sched.h"
+#include "fsa_monitor.h"
+
+#define INIT_MAX_NODES      32
+#define INIT_MAX_DEPS       4       // Per node (scheduler allows up to SCHED_MAX_DEPENDENTS dependents)
+
+// Node flags
+#define INIT_OPTIONAL       (1 << 0)    // Failure does not fail the graph
+
+// Node results besides the init function's own return value
+#define INIT_NOT_RUN        (-100)
+#define INIT_SKIPPED        (-101)      // A dependency failed
+
+typedef int (*init_fn_t)(void);
+
+// One driver. Declared statically by the caller; 'deps' names other nodes
+// of the same graph
+typedef struct init_node {
+    const char *name;
+    init_fn_t fn;
+    const char *deps[INIT_MAX_DEPS];    // Unused entries NULL
+    boot_state_t phase;                 // FSA phase the driver belongs to
+    uint32_t flags;
+
+    // Filled in by the engine
+    sched_task_t task;
+    int result;
+    struct init_node *dep[INIT_MAX_DEPS];
+    uint32_t dep_count;
+} init_node_t;
+
+typedef struct {
+    init_node_t *nodes;
+    uint32_t count;
+
+    // Called with each phase as it is entered and with STATE_FAILURE if a
+    // required node fails. Phases are entered in declaration order, once
+    // every earlier node has finished, so keep a phase's nodes together.
+    // Use fsa_update_state to drive the FSA monitor; NULL to skip
+    void (*report)(boot_state_t state);
+
+    // Engine state
+    uint8_t order[INIT_MAX_NODES];      // Topological order
+    uint32_t phase_cursor;              // Next node (declaration order) to report
+    uint32_t failed;
+    uint64_t start_us;
+} init_graph_t;
+
+// Resolve dependencies, reject unknown names and cycles, then submit every
+// node to the scheduler; nodes start as soon as their dependencies finish
+int init_graph_start(init_graph_t *graph);
+
+// Report phase progress; returns 1 once every node has finished
+int init_graph_poll(init_graph_t *graph);
+
+// start + wait (helping the scheduler); 0 if all required nodes succeeded
+int init_graph_run(init_graph_t *graph);
+
+// After completion: longest dependency chain vs. sum of node run times
+uint64_t init_graph_critical_path_us(const init_graph_t *graph);
+uint64_t init_graph_total_us(const init_graph_t *graph);
+
+const init_node_t *init_graph_find(const init_graph_t *graph, const char *name);
+
+#endif
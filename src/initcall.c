@@ -0,0 +1,43 @@
+/* Linker-Section Registration Tables */
+
+#include <stdint.h>
+#include "initcall.h"
+
+// Level boundaries from linker.ld; level n spans start[n]..start[n + 1]
+extern const initcall_t __initcall0_start[];
+extern const initcall_t __initcall1_start[];
+extern const initcall_t __initcall2_start[];
+extern const initcall_t __initcall3_start[];
+extern const initcall_t __initcall4_start[];
+extern const initcall_t __initcall_end[];
+
+static const initcall_t *const level_bounds[INITCALL_LEVELS + 1] = {
+    __initcall0_start,
+    __initcall1_start,
+    __initcall2_start,
+    __initcall3_start,
+    __initcall4_start,
+    __initcall_end,
+};
+
+int initcall_run_level(uint32_t level) {
+    int failures = 0;
+
+    if (level >= INITCALL_LEVELS) return -1;
+
+    for (const initcall_t *call = level_bounds[level]; call < level_bounds[level + 1]; call++) {
+        if ((*call)() != 0) failures++;
+    }
+
+    return failures;
+}
+
+int initcall_run_all(void) {
+    int failures = 0;
+
+    for (uint32_t level = 0; level < INITCALL_LEVELS; level++) {
+        failures += initcall_run_level(level);
+    }
+
+    return failures;
+}
@@ -0,0 +1,47 @@
+/* Linker-Section Registration Tables */
+
+#ifndef INITCALL_H
+#define INITCALL_H
+
+#include <stdint.h>
+
+/*
+ * Modules register themselves by dropping a pointer into a named section;
+ * linker.ld gathers each section into a table with start/end symbols. A
+ * module left out of the build (see PROFILE in the Makefile) simply
+ * contributes nothing - no calls to edit elsewhere.
+ */
+#define LINKER_TABLE_ENTRY(sect) __attribute__((used, section(sect), aligned(8)))
+
+// Walk a table declared with LINKER_TABLE_DECLARE
+#define LINKER_TABLE_DECLARE(type, name) \
+    extern type *const __##name##_start[]; \
+    extern type *const __##name##_end[]
+
+#define LINKER_TABLE_COUNT(name)   ((uint32_t)(__##name##_end - __##name##_start))
+#define LINKER_TABLE_GET(name, i)  (__##name##_start[i])
+
+// Initcalls, run by level; within a level in link order (SRC_C order)
+typedef int (*initcall_t)(void);
+
+#define INITCALL_CORE       0   // Interrupt controller (after UART/mailbox)
+#define INITCALL_SUBSYS     1   // Services built on it (timer queue, ...)
+#define INITCALL_DEVICE     2   // Drivers that must be up before the banner
+#define INITCALL_SMP        3   // Secondary cores (need the above configured)
+#define INITCALL_LATE       4
+#define INITCALL_LEVELS     5
+
+#define __define_initcall(fn, level) \
+    static const initcall_t __initcall_##fn LINKER_TABLE_ENTRY(".initcall" #level) = fn
+
+#define core_initcall(fn)       __define_initcall(fn, 0)
+#define subsys_initcall(fn)     __define_initcall(fn, 1)
+#define device_initcall(fn)     __define_initcall(fn, 2)
+#define smp_initcall(fn)        __define_initcall(fn, 3)
+#define late_initcall(fn)       __define_initcall(fn, 4)
+
+// Run one level / every level in order; return the number of failures
+int initcall_run_level(uint32_t level);
+int initcall_run_all(void);
+
+#endif
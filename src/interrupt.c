@@ -4,119 +4,159 @@
 #include "timer.h"
 #include "gpio.h"
 #include "hardware.h"
+#include "exception.h"
+#include "atomic.h"
+#include "smp.h"
+#include "initcall.h"
+#include "perfmon.h"
 
 #define NULL ((void*)0)
 
 // Interrupt handler table
 #define MAX_INTERRUPTS 256
-static interrupt_handler_t interrupt_handlers[MAX_INTERRUPTS];
+static struct {
+    interrupt_handler_t handler;
+    void *context;
+} interrupt_handlers[MAX_INTERRUPTS];
+
+static interrupt_stats_t interrupt_stats[MAX_INTERRUPTS];
+static volatile uint32_t spurious_count;
+static volatile uint32_t nesting_enabled;
+static volatile uint32_t dispatch_depth[SMP_MAX_CORES];
+
+static const interrupt_controller_ops_t *irq_ops;
 
 // Helper functions
 static void mmio_write(uint32_t reg, uint32_t data) {
-    *(volatile uint32_t*)reg = data;
+    *(volatile uint32_t*)(uintptr_t)reg = data;
 }
 
 static uint32_t mmio_read(uint32_t reg) {
-    return *(volatile uint32_t*)reg;
+    return *(volatile uint32_t*)(uintptr_t)reg;
+}
+
+// BCM2711 moved to a GIC-400; everything older (and QEMU raspi3b) has the
+// BCM2836 local controller in front of the BCM2835 legacy one
+static const interrupt_controller_ops_t *select_controller(pi_model_t model) {
+    // QEMU virt has only its GICv2 (platform.h)
+    if (!PLATFORM_HAS_BCM_IRQ) return &gic400_ops;
+
+    switch (model) {
+        case PI_MODEL_4B:
+        case PI_MODEL_400:
+            return &gic400_ops;
+        default:
+            return &bcm2836_ops;
+    }
 }
 
 void interrupt_init(void) {
     // Initialize handler table
     for (int i = 0; i < MAX_INTERRUPTS; i++) {
-        interrupt_handlers[i] = NULL;
+        interrupt_handlers[i].handler = NULL;
+        interrupt_handlers[i].context = NULL;
     }
+    interrupt_reset_stats();
 
-    // Disable all interrupts in distributor
-    for (int i = 0; i < 32; i++) {
-        mmio_write(GICD_ICENABLER + i * 4, 0xFFFFFFFF);
-        mmio_write(GICD_ICPENDR + i * 4, 0xFFFFFFFF);
-        mmio_write(GICD_ICACTIVER + i * 4, 0xFFFFFFFF);
+    if (current_pi_model == PI_MODEL_UNKNOWN) {
+        hardware_detect_model();
     }
+    irq_ops = select_controller(current_pi_model);
+    irq_ops->init();
+}
 
-    // Set all interrupts to group 0 (secure)
-    for (int i = 0; i < 32; i++) {
-        mmio_write(GICD_IGROUPR + i * 4, 0x00000000);
-    }
+// Needs the board revision from the mailbox to pick the controller; runs
+// before the SMP level so secondaries find it configured
+static int interrupt_initcall(void) {
+    interrupt_init();
+    irq_enable();
+    return 0;
+}
+core_initcall(interrupt_initcall);
 
-    // Set priority mask to allow all priorities
-    mmio_write(GICC_PMR, 0xFF);
+void interrupt_shutdown(void) {
+    irq_disable();
+    if (!irq_ops) return;
 
-    // Enable CPU interface
-    mmio_write(GICC_CTLR, 0x01);
+    // init() masks every source again; the next owner sets up its own
+    irq_ops->init();
+}
 
-    // Enable distributor
-    mmio_write(GICD_CTLR, 0x01);
+void interrupt_init_core(void) {
+    if (!irq_ops) return;
+    irq_ops->init_core(smp_core_id());
 }
 
-void interrupt_enable(uint32_t irq) {
-    if (irq >= MAX_INTERRUPTS) return;
+const interrupt_controller_ops_t *interrupt_get_controller(void) {
+    return irq_ops;
+}
 
-    uint32_t reg_index = irq / 32;
-    uint32_t bit_index = irq % 32;
+uint32_t interrupt_local_irq(uint32_t source) {
+    if (!irq_ops) return INTERRUPT_NONE;
+    return irq_ops->local_irq(source);
+}
 
-    mmio_write(GICD_ISENABLER + reg_index * 4, 1 << bit_index);
+uint32_t interrupt_vc_irq(uint32_t vc_irq) {
+    if (!irq_ops) return INTERRUPT_NONE;
+    return irq_ops->vc_irq(vc_irq);
+}
+
+void interrupt_enable(uint32_t irq) {
+    if (irq >= MAX_INTERRUPTS || !irq_ops) return;
+    irq_ops->enable(irq);
 }
 
 void interrupt_disable(uint32_t irq) {
-    if (irq >= MAX_INTERRUPTS) return;
+    if (irq >= MAX_INTERRUPTS || !irq_ops) return;
+    irq_ops->disable(irq);
+}
 
-    uint32_t reg_index = irq / 32;
-    uint32_t bit_index = irq % 32;
+int interrupt_register_handler(uint32_t irq, interrupt_handler_t handler, void *context) {
+    if (irq >= MAX_INTERRUPTS || !handler) return -1;
 
-    mmio_write(GICD_ICENABLER + reg_index * 4, 1 << bit_index);
+    // Context first, so the dispatcher never pairs a new handler with a stale context
+    interrupt_handlers[irq].handler = NULL;
+    atomic_fence(ATOMIC_SEQ_CST);
+    interrupt_handlers[irq].context = context;
+    atomic_store_ptr((void *volatile *)&interrupt_handlers[irq].handler, (void *)handler, ATOMIC_RELEASE);
+    return 0;
 }
 
-void interrupt_register_handler(uint32_t irq, interrupt_handler_t handler) {
+void interrupt_unregister_handler(uint32_t irq) {
     if (irq >= MAX_INTERRUPTS) return;
-    interrupt_handlers[irq] = handler;
+    atomic_store_ptr((void *volatile *)&interrupt_handlers[irq].handler, NULL, ATOMIC_RELEASE);
 }
 
-void interrupt_set_priority(uint32_t irq, uint8_t priority) {
-    if (irq >= MAX_INTERRUPTS) return;
-
-    uint32_t reg_index = irq / 4;
-    uint32_t byte_index = irq % 4;
-
-    uint32_t reg_addr = GICD_IPRIORITYR + reg_index * 4;
-    uint32_t reg_value = mmio_read(reg_addr);
-
-    // Clear the byte for this interrupt
-    reg_value &= ~(0xFF << (byte_index * 8));
-    // Set the priority
-    reg_value |= (priority << (byte_index * 8));
+void interrupt_set_nesting(int enable) {
+    atomic_store_32(&nesting_enabled, enable ? 1 : 0, ATOMIC_RELEASE);
+}
 
-    mmio_write(reg_addr, reg_value);
+void interrupt_set_priority(uint32_t irq, uint8_t priority) {
+    if (irq >= MAX_INTERRUPTS || !irq_ops) return;
+    irq_ops->set_priority(irq, priority);
 }
 
 void interrupt_set_target(uint32_t irq, uint8_t cpu_mask) {
-    if (irq >= MAX_INTERRUPTS) return;
-
-    uint32_t reg_index = irq / 4;
-    uint32_t byte_index = irq % 4;
-
-    uint32_t reg_addr = GICD_ITARGETSR + reg_index * 4;
-    uint32_t reg_value = mmio_read(reg_addr);
-
-    // Clear the byte for this interrupt
-    reg_value &= ~(0xFF << (byte_index * 8));
-    // Set the target CPUs
-    reg_value |= (cpu_mask << (byte_index * 8));
-
-    mmio_write(reg_addr, reg_value);
+    if (irq >= MAX_INTERRUPTS || !irq_ops) return;
+    irq_ops->set_target(irq, cpu_mask);
 }
 
 // Default interrupt handlers
-void timer_interrupt_handler(void) {
+void timer_interrupt_handler(void *context) {
+    (void)context;
+
     // Clear the ARM timer interrupt
-    uint32_t arm_timer_base = get_arm_timer_base();
+    uint32_t arm_timer_base = PLATFORM_ARM_TIMER_BASE;
     mmio_write(arm_timer_base + ARM_TIMER_IRQCLR_OFFSET, 0);
 
     // Handle timer interrupt (e.g., schedule tasks, update counters)
     // For now, just acknowledge
 }
 
-void gpio_interrupt_handler(void) {
-    uint32_t gpio_base = get_gpio_base();
+void gpio_interrupt_handler(void *context) {
+    (void)context;
+
+    uint32_t gpio_base = PLATFORM_GPIO_BASE;
     // Clear GPIO interrupt events
     for (int i = 0; i < 2; i++) {
         uint32_t events = mmio_read(gpio_base + GPIO_GPEDS0_OFFSET + i * 4);
@@ -129,16 +169,86 @@ void gpio_interrupt_handler(void) {
     // For now, just acknowledge
 }
 
-// Interrupt handler dispatcher (called from assembly)
-void interrupt_handler(void) {
-    // Read the interrupt acknowledge register
-    uint32_t iar = mmio_read(GICC_IAR);
-    uint32_t irq = iar & 0x3FF;
+static void update_max(volatile uint64_t *max, uint64_t value) {
+    uint64_t seen = atomic_load_64(max, ATOMIC_RELAXED);
+    while (value > seen) {
+        uint64_t prev = atomic_cas_64(max, seen, value, ATOMIC_RELAXED);
+        if (prev == seen) break;
+        seen = prev;
+    }
+}
+
+// Interrupt handler dispatcher (called from the IRQ vector)
+void interrupt_dispatch(uint64_t entry_ticks) {
+    if (!irq_ops) return;
+
+    // On the GIC, acknowledging also raises the running priority, so only
+    // strictly higher priorities can nest
+    uint32_t token;
+    uint32_t irq = irq_ops->acknowledge(&token);
+
+    if (irq >= MAX_INTERRUPTS) {
+        // Nothing pending (GIC 1020-1023, or the source cleared itself): no EOI
+        atomic_fetch_add_32(&spurious_count, 1, ATOMIC_RELAXED);
+        return;
+    }
+
+    uint32_t core = smp_core_id();
+    uint32_t depth = dispatch_depth[core]++;
+    uint64_t start = timer_read_cycles();
+
+    interrupt_handler_t handler = (interrupt_handler_t)atomic_load_ptr(
+        (void *const volatile *)&interrupt_handlers[irq].handler, ATOMIC_ACQUIRE);
+    void *context = interrupt_handlers[irq].context;
+
+    if (handler) {
+        // ELR/SPSR are already on the stack, so unmasking here is safe. Without
+        // hardware priorities the still-asserted line would re-enter at once
+        int nest = irq_ops->has_priority &&
+                   atomic_load_32(&nesting_enabled, ATOMIC_ACQUIRE);
+        if (nest) irq_enable();
+        handler(context);
+        if (nest) irq_disable();
+    }
+
+    uint64_t end = timer_read_cycles();
+
+    irq_ops->end_of_interrupt(token);
+    dispatch_depth[core]--;
+
+    interrupt_stats_t *st = &interrupt_stats[irq];
+    atomic_fetch_add_32(&st->count, 1, ATOMIC_RELAXED);
+    if (depth > 0) atomic_fetch_add_32(&st->nested, 1, ATOMIC_RELAXED);
+    atomic_fetch_add_64(&st->total_ticks, end - start, ATOMIC_RELAXED);
+    update_max(&st->max_ticks, end - start);
+    update_max(&st->max_latency_ticks, start - entry_ticks);
+}
+
+const interrupt_stats_t *interrupt_get_stats(uint32_t irq) {
+    if (irq >= MAX_INTERRUPTS) return NULL;
+    return &interrupt_stats[irq];
+}
 
-    if (irq < MAX_INTERRUPTS && interrupt_handlers[irq]) {
-        interrupt_handlers[irq]();
+uint32_t interrupt_get_spurious_count(void) {
+    return spurious_count;
+}
+
+static uint64_t sample_spurious(void) {
+    return interrupt_get_spurious_count();
+}
+PERFMON_PROBE(spurious_probe, "Spurious IRQs", "total", sample_spurious);
+
+void interrupt_reset_stats(void) {
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        interrupt_stats[i].count = 0;
+        interrupt_stats[i].nested = 0;
+        interrupt_stats[i].total_ticks = 0;
+        interrupt_stats[i].max_ticks = 0;
+        interrupt_stats[i].max_latency_ticks = 0;
     }
+    spurious_count = 0;
+}
 
-    // Write end of interrupt
-    mmio_write(GICC_EOIR, iar);
-}
\ No newline at end of file
+uint64_t interrupt_ticks_to_us(uint64_t ticks) {
+    return timer_cycles_to_us(ticks);
+}
@@ -4,9 +4,10 @@
 #define INTERRUPT_H
 
 #include <stdint.h>
+#include "platform.h"
 
-// GIC-400 Distributor registers
-#define GICD_BASE 0xFF841000
+// GIC-400 Distributor registers (GICv2; on QEMU virt as well)
+#define GICD_BASE PLATFORM_GICD_BASE
 #define GICD_CTLR       (GICD_BASE + 0x000)
 #define GICD_TYPER      (GICD_BASE + 0x004)
 #define GICD_IIDR       (GICD_BASE + 0x008)
@@ -23,7 +24,7 @@
 #define GICD_SGIR       (GICD_BASE + 0xF00)
 
 // GIC-400 CPU Interface registers
-#define GICC_BASE 0xFF842000
+#define GICC_BASE PLATFORM_GICC_BASE
 #define GICC_CTLR       (GICC_BASE + 0x000)
 #define GICC_PMR        (GICC_BASE + 0x004)
 #define GICC_BPR        (GICC_BASE + 0x008)
@@ -47,17 +48,77 @@
 #define INTERRUPT_GPIO  113
 #define INTERRUPT_SD    62
 
-typedef void (*interrupt_handler_t)(void);
+#define INTERRUPT_SPURIOUS 1023   // GICC_IAR value when nothing is pending
+#define INTERRUPT_NONE     0xFFFF // Source not available on this controller
+
+// Per-core sources, numbered as in the BCM2836 core IRQ source register;
+// translate with interrupt_local_irq()
+#define INTERRUPT_LOCAL_CNTPS       0   // Secure physical timer
+#define INTERRUPT_LOCAL_CNTPNS      1   // Non-secure physical timer
+#define INTERRUPT_LOCAL_CNTHP       2   // Hypervisor timer
+#define INTERRUPT_LOCAL_CNTV        3   // Virtual timer
+#define INTERRUPT_LOCAL_MAILBOX0    4   // Mailboxes 0-3: 4-7
+#define INTERRUPT_LOCAL_PMU         9
+
+typedef void (*interrupt_handler_t)(void *context);
+
+// Interrupt controller operations; one table per controller family,
+// selected from the detected board model by interrupt_init()
+typedef struct {
+    const char *name;
+    int has_priority;                           // Hardware priority (nesting possible)
+    void (*init)(void);                         // Global setup, boot core
+    void (*init_core)(uint32_t core);           // Per-core setup, every core
+    void (*enable)(uint32_t irq);
+    void (*disable)(uint32_t irq);
+    void (*set_priority)(uint32_t irq, uint8_t priority);
+    void (*set_target)(uint32_t irq, uint8_t cpu_mask);
+    uint32_t (*acknowledge)(uint32_t *token);   // IRQ number or INTERRUPT_SPURIOUS
+    void (*end_of_interrupt)(uint32_t token);
+    uint32_t (*local_irq)(uint32_t source);     // INTERRUPT_LOCAL_* -> IRQ number
+    uint32_t (*vc_irq)(uint32_t vc_irq);        // VideoCore peripheral IRQ -> IRQ number
+} interrupt_controller_ops_t;
+
+extern const interrupt_controller_ops_t gic400_ops;      // interrupt_gic.c
+extern const interrupt_controller_ops_t bcm2836_ops;     // interrupt_bcm.c
+
+// Per-IRQ statistics (counter ticks; see interrupt_ticks_to_us())
+typedef struct {
+    uint32_t count;
+    uint32_t nested;                // Times it preempted another handler
+    uint64_t total_ticks;           // Handler run time
+    uint64_t max_ticks;
+    uint64_t max_latency_ticks;     // Vector entry -> handler start
+} interrupt_stats_t;
+
+void interrupt_init(void);                  // Boot core, after hardware_detect_model()
+void interrupt_init_core(void);             // Each secondary core
+void interrupt_shutdown(void);              // Mask everything (before a handoff)
+const interrupt_controller_ops_t *interrupt_get_controller(void);
+uint32_t interrupt_local_irq(uint32_t source);
+uint32_t interrupt_vc_irq(uint32_t vc_irq);
 
-void interrupt_init(void);
 void interrupt_enable(uint32_t irq);
 void interrupt_disable(uint32_t irq);
-void interrupt_register_handler(uint32_t irq, interrupt_handler_t handler);
+int interrupt_register_handler(uint32_t irq, interrupt_handler_t handler, void *context);
+void interrupt_unregister_handler(uint32_t irq);
 void interrupt_set_priority(uint32_t irq, uint8_t priority);
 void interrupt_set_target(uint32_t irq, uint8_t cpu_mask);
 
+// Allow higher-priority interrupts to preempt a running handler (off by default)
+void interrupt_set_nesting(int enable);
+
+// Called from the IRQ vector; entry_ticks is CNTPCT_EL0 at vector entry
+void interrupt_dispatch(uint64_t entry_ticks);
+
+// Statistics
+const interrupt_stats_t *interrupt_get_stats(uint32_t irq);
+uint32_t interrupt_get_spurious_count(void);
+void interrupt_reset_stats(void);
+uint64_t interrupt_ticks_to_us(uint64_t ticks);
+
 // Default interrupt handlers
-void timer_interrupt_handler(void);
-void gpio_interrupt_handler(void);
+void timer_interrupt_handler(void *context);
+void gpio_interrupt_handler(void *context);
 
 #endif
\ No newline at end of file
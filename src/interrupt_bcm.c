@@ -0,0 +1,187 @@
+/* BCM2836 Local + BCM2835 Legacy Interrupt Controllers (Pi 2, 3, Zero 2 W, QEMU raspi3b) */
+
+#include <stdint.h>
+#include "interrupt.h"
+#include "hardware.h"
+#include "smp.h"
+
+/*
+ * IRQ numbering on this controller pair:
+ *   0-31    per-core local sources (INTERRUPT_LOCAL_*)
+ *   32-95   VideoCore peripheral IRQs 0-63 (legacy pending 1/2)
+ *   96-103  ARM basic IRQs 0-7 (ARM timer, doorbells, ...)
+ */
+#define BCM_VC_BASE         32
+#define BCM_BASIC_BASE      96
+#define BCM_BASIC_COUNT     8
+#define BCM_LOCAL_COUNT     12
+
+// ARM local controller (one per cluster, banked by core index)
+#define LOCAL_GPU_ROUTING       (ARM_LOCAL_BASE_BCM2837 + 0x0C)
+#define LOCAL_PMU_ROUTING_SET   (ARM_LOCAL_BASE_BCM2837 + 0x10)
+#define LOCAL_PMU_ROUTING_CLR   (ARM_LOCAL_BASE_BCM2837 + 0x14)
+#define LOCAL_TIMER_CNTRL(c)    (ARM_LOCAL_BASE_BCM2837 + 0x40 + 4 * (c))
+#define LOCAL_MAILBOX_CNTRL(c)  (ARM_LOCAL_BASE_BCM2837 + 0x50 + 4 * (c))
+#define LOCAL_IRQ_SOURCE(c)     (ARM_LOCAL_BASE_BCM2837 + 0x60 + 4 * (c))
+
+#define LOCAL_SOURCE_GPU        (1 << 8)
+#define LOCAL_SOURCE_PMU        (1 << 9)
+
+// Legacy (BCM2835-style) controller
+#define IRQ_BASIC_PENDING   (IRQ_LEGACY_BASE_BCM2837 + 0x00)
+#define IRQ_PENDING_1       (IRQ_LEGACY_BASE_BCM2837 + 0x04)
+#define IRQ_PENDING_2       (IRQ_LEGACY_BASE_BCM2837 + 0x08)
+#define IRQ_ENABLE_1        (IRQ_LEGACY_BASE_BCM2837 + 0x10)
+#define IRQ_ENABLE_2        (IRQ_LEGACY_BASE_BCM2837 + 0x14)
+#define IRQ_ENABLE_BASIC    (IRQ_LEGACY_BASE_BCM2837 + 0x18)
+#define IRQ_DISABLE_1       (IRQ_LEGACY_BASE_BCM2837 + 0x1C)
+#define IRQ_DISABLE_2       (IRQ_LEGACY_BASE_BCM2837 + 0x20)
+#define IRQ_DISABLE_BASIC   (IRQ_LEGACY_BASE_BCM2837 + 0x24)
+
+static void mmio_write(uint32_t reg, uint32_t data) {
+    *(volatile uint32_t*)(uintptr_t)reg = data;
+}
+
+static uint32_t mmio_read(uint32_t reg) {
+    return *(volatile uint32_t*)(uintptr_t)reg;
+}
+
+// Set or clear the enable bit of a per-core local source on one core
+static void local_set(uint32_t core, uint32_t irq, int enable) {
+    uint32_t reg, bit;
+
+    if (irq <= INTERRUPT_LOCAL_CNTV) {
+        reg = LOCAL_TIMER_CNTRL(core);
+        bit = 1u << irq;
+    } else if (irq < INTERRUPT_LOCAL_MAILBOX0 + 4) {
+        reg = LOCAL_MAILBOX_CNTRL(core);
+        bit = 1u << (irq - INTERRUPT_LOCAL_MAILBOX0);
+    } else if (irq == INTERRUPT_LOCAL_PMU) {
+        mmio_write(enable ? LOCAL_PMU_ROUTING_SET : LOCAL_PMU_ROUTING_CLR, 1u << core);
+        return;
+    } else {
+        return;
+    }
+
+    uint32_t value = mmio_read(reg);
+    mmio_write(reg, enable ? (value | bit) : (value & ~bit));
+}
+
+static void bcm_init_core(uint32_t core) {
+    mmio_write(LOCAL_TIMER_CNTRL(core), 0);
+    mmio_write(LOCAL_MAILBOX_CNTRL(core), 0);
+    mmio_write(LOCAL_PMU_ROUTING_CLR, 1u << core);
+}
+
+static void bcm_init(void) {
+    // Mask every legacy source
+    mmio_write(IRQ_DISABLE_1, 0xFFFFFFFF);
+    mmio_write(IRQ_DISABLE_2, 0xFFFFFFFF);
+    mmio_write(IRQ_DISABLE_BASIC, 0xFFFFFFFF);
+
+    // All peripheral IRQs to core 0 (IRQ, not FIQ)
+    mmio_write(LOCAL_GPU_ROUTING, 0);
+
+    for (uint32_t core = 0; core < SMP_MAX_CORES; core++) {
+        bcm_init_core(core);
+    }
+}
+
+static void bcm_enable(uint32_t irq) {
+    if (irq < BCM_LOCAL_COUNT) {
+        local_set(smp_core_id(), irq, 1);
+    } else if (irq < BCM_VC_BASE + 32) {
+        mmio_write(IRQ_ENABLE_1, 1u << (irq - BCM_VC_BASE));
+    } else if (irq < BCM_BASIC_BASE) {
+        mmio_write(IRQ_ENABLE_2, 1u << (irq - BCM_VC_BASE - 32));
+    } else if (irq < BCM_BASIC_BASE + BCM_BASIC_COUNT) {
+        mmio_write(IRQ_ENABLE_BASIC, 1u << (irq - BCM_BASIC_BASE));
+    }
+}
+
+static void bcm_disable(uint32_t irq) {
+    if (irq < BCM_LOCAL_COUNT) {
+        local_set(smp_core_id(), irq, 0);
+    } else if (irq < BCM_VC_BASE + 32) {
+        mmio_write(IRQ_DISABLE_1, 1u << (irq - BCM_VC_BASE));
+    } else if (irq < BCM_BASIC_BASE) {
+        mmio_write(IRQ_DISABLE_2, 1u << (irq - BCM_VC_BASE - 32));
+    } else if (irq < BCM_BASIC_BASE + BCM_BASIC_COUNT) {
+        mmio_write(IRQ_DISABLE_BASIC, 1u << (irq - BCM_BASIC_BASE));
+    }
+}
+
+static void bcm_set_priority(uint32_t irq, uint8_t priority) {
+    // No hardware priorities on this controller
+    (void)irq;
+    (void)priority;
+}
+
+static void bcm_set_target(uint32_t irq, uint8_t cpu_mask) {
+    if (cpu_mask == 0) return;
+
+    if (irq < BCM_LOCAL_COUNT) {
+        // Per-core source: enable it on exactly the cores in the mask
+        for (uint32_t core = 0; core < SMP_MAX_CORES; core++) {
+            local_set(core, irq, (cpu_mask >> core) & 1);
+        }
+        return;
+    }
+
+    // Peripheral IRQs share one route; use the lowest core in the mask
+    mmio_write(LOCAL_GPU_ROUTING, __builtin_ctz(cpu_mask) & 3);
+}
+
+static uint32_t bcm_acknowledge(uint32_t *token) {
+    uint32_t source = mmio_read(LOCAL_IRQ_SOURCE(smp_core_id()));
+    uint32_t irq = INTERRUPT_SPURIOUS;
+
+    if (source & 0xFF) {
+        // Core timers and mailboxes
+        irq = __builtin_ctz(source & 0xFF);
+    } else if (source & LOCAL_SOURCE_GPU) {
+        uint32_t basic = mmio_read(IRQ_BASIC_PENDING) & 0xFF;
+        uint32_t pending;
+
+        if (basic) {
+            irq = BCM_BASIC_BASE + __builtin_ctz(basic);
+        } else if ((pending = mmio_read(IRQ_PENDING_1)) != 0) {
+            irq = BCM_VC_BASE + __builtin_ctz(pending);
+        } else if ((pending = mmio_read(IRQ_PENDING_2)) != 0) {
+            irq = BCM_VC_BASE + 32 + __builtin_ctz(pending);
+        }
+    } else if (source & LOCAL_SOURCE_PMU) {
+        irq = INTERRUPT_LOCAL_PMU;
+    }
+
+    *token = irq;
+    return irq;
+}
+
+static void bcm_end_of_interrupt(uint32_t token) {
+    // Level-triggered: the handler clears the source, nothing to signal
+    (void)token;
+}
+
+static uint32_t bcm_local_irq(uint32_t source) {
+    return source < BCM_LOCAL_COUNT ? source : INTERRUPT_NONE;
+}
+
+static uint32_t bcm_vc_irq(uint32_t vc_irq) {
+    return vc_irq < 64 ? BCM_VC_BASE + vc_irq : INTERRUPT_NONE;
+}
+
+const interrupt_controller_ops_t bcm2836_ops = {
+    .name = "BCM2836 local + legacy",
+    .has_priority = 0,
+    .init = bcm_init,
+    .init_core = bcm_init_core,
+    .enable = bcm_enable,
+    .disable = bcm_disable,
+    .set_priority = bcm_set_priority,
+    .set_target = bcm_set_target,
+    .acknowledge = bcm_acknowledge,
+    .end_of_interrupt = bcm_end_of_interrupt,
+    .local_irq = bcm_local_irq,
+    .vc_irq = bcm_vc_irq
+};
@@ -0,0 +1,138 @@
+/* GIC-400 Interrupt Controller (BCM2711: Pi 4, 400) */
+
+#include <stdint.h>
+#include "interrupt.h"
+
+#define GIC_MAX_IRQS    256     // Lines handled by the dispatcher
+#define GIC_SPI_BASE    32      // First shared peripheral interrupt
+#define GIC_VC_BASE     96      // VideoCore peripheral IRQ 0 (SPI 64)
+
+// Private peripheral interrupts for the generic timers
+#define GIC_PPI_CNTHP   26
+#define GIC_PPI_CNTV    27
+#define GIC_PPI_CNTPS   29
+#define GIC_PPI_CNTPNS  30
+
+static void mmio_write(uint32_t reg, uint32_t data) {
+    *(volatile uint32_t*)(uintptr_t)reg = data;
+}
+
+static uint32_t mmio_read(uint32_t reg) {
+    return *(volatile uint32_t*)(uintptr_t)reg;
+}
+
+// Read-modify-write one byte of a byte-per-IRQ register bank
+static void write_byte_field(uint32_t bank, uint32_t irq, uint8_t value) {
+    uint32_t reg_addr = bank + (irq / 4) * 4;
+    uint32_t shift = (irq % 4) * 8;
+    uint32_t reg_value = mmio_read(reg_addr);
+
+    reg_value &= ~(0xFFu << shift);
+    reg_value |= ((uint32_t)value << shift);
+    mmio_write(reg_addr, reg_value);
+}
+
+static void gic_init_core(uint32_t core) {
+    (void)core;
+
+    // SGIs/PPIs are banked per core: start with all of them disabled
+    mmio_write(GICD_ICENABLER, 0xFFFFFFFF);
+    mmio_write(GICD_ICPENDR, 0xFFFFFFFF);
+    mmio_write(GICD_ICACTIVER, 0xFFFFFFFF);
+
+    // Set priority mask to allow all priorities
+    mmio_write(GICC_PMR, 0xFF);
+
+    // All priority bits are group priority, so any higher priority preempts
+    mmio_write(GICC_BPR, 0x00);
+
+    // Enable CPU interface
+    mmio_write(GICC_CTLR, 0x01);
+}
+
+static void gic_init(void) {
+    mmio_write(GICD_CTLR, 0x00);
+
+    // Disable all interrupts in distributor
+    for (int i = 0; i < 32; i++) {
+        mmio_write(GICD_ICENABLER + i * 4, 0xFFFFFFFF);
+        mmio_write(GICD_ICPENDR + i * 4, 0xFFFFFFFF);
+        mmio_write(GICD_ICACTIVER + i * 4, 0xFFFFFFFF);
+    }
+
+    // Set all interrupts to group 0 (secure)
+    for (int i = 0; i < 32; i++) {
+        mmio_write(GICD_IGROUPR + i * 4, 0x00000000);
+    }
+
+    // Default priority and boot-core routing for every SPI
+    for (uint32_t irq = GIC_SPI_BASE; irq < GIC_MAX_IRQS; irq++) {
+        write_byte_field(GICD_IPRIORITYR, irq, INTERRUPT_PRIORITY_NORMAL);
+        write_byte_field(GICD_ITARGETSR, irq, 0x01);
+    }
+
+    gic_init_core(0);
+
+    // Enable distributor
+    mmio_write(GICD_CTLR, 0x01);
+}
+
+static void gic_enable(uint32_t irq) {
+    mmio_write(GICD_ISENABLER + (irq / 32) * 4, 1u << (irq % 32));
+}
+
+static void gic_disable(uint32_t irq) {
+    mmio_write(GICD_ICENABLER + (irq / 32) * 4, 1u << (irq % 32));
+}
+
+static void gic_set_priority(uint32_t irq, uint8_t priority) {
+    write_byte_field(GICD_IPRIORITYR, irq, priority);
+}
+
+static void gic_set_target(uint32_t irq, uint8_t cpu_mask) {
+    // SGI/PPI targets are fixed to the owning core
+    if (irq < GIC_SPI_BASE) return;
+    write_byte_field(GICD_ITARGETSR, irq, cpu_mask);
+}
+
+static uint32_t gic_acknowledge(uint32_t *token) {
+    // Reading IAR also raises the running priority, so only strictly
+    // higher priorities can preempt the handler
+    uint32_t iar = mmio_read(GICC_IAR);
+    *token = iar;
+    return iar & 0x3FF;
+}
+
+static void gic_end_of_interrupt(uint32_t token) {
+    mmio_write(GICC_EOIR, token);
+}
+
+static uint32_t gic_local_irq(uint32_t source) {
+    switch (source) {
+        case INTERRUPT_LOCAL_CNTPS:  return GIC_PPI_CNTPS;
+        case INTERRUPT_LOCAL_CNTPNS: return GIC_PPI_CNTPNS;
+        case INTERRUPT_LOCAL_CNTHP:  return GIC_PPI_CNTHP;
+        case INTERRUPT_LOCAL_CNTV:   return GIC_PPI_CNTV;
+        default:                     return INTERRUPT_NONE;
+    }
+}
+
+static uint32_t gic_vc_irq(uint32_t vc_irq) {
+    if (vc_irq >= 64) return INTERRUPT_NONE;
+    return GIC_VC_BASE + vc_irq;
+}
+
+const interrupt_controller_ops_t gic400_ops = {
+    .name = "GIC-400",
+    .has_priority = 1,
+    .init = gic_init,
+    .init_core = gic_init_core,
+    .enable = gic_enable,
+    .disable = gic_disable,
+    .set_priority = gic_set_priority,
+    .set_target = gic_set_target,
+    .acknowledge = gic_acknowledge,
+    .end_of_interrupt = gic_end_of_interrupt,
+    .local_irq = gic_local_irq,
+    .vc_irq = gic_vc_irq
+};
@@ -0,0 +1,247 @@
+/* Linux arm64 Image Loading and Handoff */
+
+#include <stdint.h>
+#include "kernel_boot.h"
+#include "boot_source.h"
+#include "elf_loader.h"
+#include "memmap.h"
+#include "fdt.h"
+#include "cache.h"
+#include "mmu.h"
+#include "smp.h"
+#include "interrupt.h"
+#include "exception.h"
+#include "timer_queue.h"
+#include "platform.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+#define KERNEL_PAGE             0x1000
+
+typedef void (*kernel_entry_t)(uint64_t dtb, uint64_t x1, uint64_t x2, uint64_t x3);
+
+static kernel_load_hook_t load_hook;
+
+void kernel_boot_set_load_hook(kernel_load_hook_t hook) {
+    load_hook = hook;
+}
+
+int kernel_image_check(const arm64_image_header_t *header) {
+    if (header->magic != ARM64_IMAGE_MAGIC) return -1;
+
+    // Kernels without image_size predate the flags field
+    if (header->image_size != 0 && (header->flags & ARM64_IMAGE_FLAG_BE)) return -1;
+
+    return 0;
+}
+
+// DTB into a block of its own with room for edits: the file if the
+// kernel's source has one, else the firmware's
+static int place_dtb(const char *dtb, kernel_layout_t *layout) {
+    fdt_header_t header;
+    const void *blob = NULL;
+    uint32_t size;
+
+    if (dtb && layout->source->peek(dtb, &header, sizeof(header), &size) == 0 &&
+        fdt_check_header(&header) == 0) {
+        // Loaded below, once there is somewhere to put it
+    } else if (firmware_dtb && fdt_check_header((const void *)(uintptr_t)firmware_dtb) == 0) {
+        blob = (const void *)(uintptr_t)firmware_dtb;
+        size = fdt_get_totalsize(blob);
+    } else {
+        return -1;  // arm64 kernels need a device tree
+    }
+
+    if (size + KERNEL_DTB_SLACK > KERNEL_DTB_MAX) return -1;
+    layout->dtb_size = size + KERNEL_DTB_SLACK;
+
+    if (memmap_alloc(layout->dtb_size, KERNEL_PAGE, MEMMAP_DTB, 0, "dtb", &layout->dtb_addr) != 0) {
+        return -1;
+    }
+
+    if (!blob) {
+        if (layout->source->load(dtb, (uint32_t)layout->dtb_addr, &size) != 0) return -1;
+        blob = (const void *)(uintptr_t)layout->dtb_addr;
+    }
+
+    // Copies the firmware's tree (or opens the loaded one in place) and
+    // turns the slack into free space
+    return fdt_open_into(blob, (void *)(uintptr_t)layout->dtb_addr, layout->dtb_size) == 0 ? 0 : -1;
+}
+
+static int chosen_set_initrd(const kernel_layout_t *layout) {
+    void *fdt = (void *)(uintptr_t)layout->dtb_addr;
+    int chosen = fdt_path_offset(fdt, "/chosen");
+
+    if (chosen < 0) return -1;
+    if (fdt_setprop_u64(fdt, chosen, "linux,initrd-start", layout->initrd_addr) != 0) return -1;
+    return fdt_setprop_u64(fdt, chosen, "linux,initrd-end",
+                           layout->initrd_addr + layout->initrd_size);
+}
+
+// Secondaries wait in a copy of the spin loop that the DTB reserves;
+// under PSCI they are powered off instead (smp.c)
+static int place_park_loop(kernel_layout_t *layout) {
+    uint32_t size = smp_spin_park_end - smp_spin_park;
+
+    if (!PLATFORM_HAS_SPIN_TABLE) return 0;
+
+    if (memmap_alloc(KERNEL_PAGE, KERNEL_PAGE, MEMMAP_BOOTLOADER, MEMMAP_NOMAP, "spin-park",
+                     &layout->park_addr) != 0) {
+        return -1;
+    }
+
+    uint8_t *dest = (uint8_t *)(uintptr_t)layout->park_addr;
+    for (uint32_t i = 0; i < size; i++) {
+        dest[i] = smp_spin_park[i];
+    }
+    dcache_clean_range(layout->park_addr, size);
+    icache_invalidate_all();
+    return 0;
+}
+
+static void release_layout(const kernel_layout_t *layout) {
+    if (layout->kernel_base) memmap_release(layout->kernel_base);
+    if (layout->dtb_addr) memmap_release(layout->dtb_addr);
+    if (layout->initrd_addr) memmap_release(layout->initrd_addr);
+    if (layout->park_addr) memmap_release(layout->park_addr);
+}
+
+// Segments are read straight to their own addresses, so unlike an Image
+// there is no window to claim before the DTB
+static int load_elf(const char *image, const elf64_ehdr_t *header, const char *dtb,
+                    kernel_layout_t *layout) {
+    elf_image_t elf;
+
+    if (elf_load(layout->source, image, header, &elf) != 0) return -1;
+
+    layout->kernel_base = elf.base;
+    layout->kernel_addr = elf.entry;
+    layout->kernel_end = elf.end;
+    return place_dtb(dtb, layout);
+}
+
+static int load_image(const char *image, const arm64_image_header_t *header, const char *dtb,
+                      kernel_layout_t *layout) {
+    uint32_t size = layout->kernel_size;
+    uint64_t text_offset = KERNEL_TEXT_OFFSET_LEGACY;
+    uint64_t image_size = (uint64_t)size + KERNEL_BSS_SLACK;
+
+    // Without a header (any flat binary) or before image_size existed, the
+    // kernel runs at the legacy offset and its BSS and early page tables
+    // take whatever follows the file, so leave room for them there
+    if (header->magic == ARM64_IMAGE_MAGIC) {
+        if (kernel_image_check(header) != 0) return -1;
+        if (header->image_size) {
+            text_offset = header->text_offset;
+            image_size = header->image_size > size ? header->image_size : size;
+        }
+    }
+
+    // Lowest free 2MB-aligned base (flags bit 3 allows anywhere, but low is
+    // what older kernels require)
+    if (memmap_alloc(text_offset + image_size, KERNEL_ALIGN, MEMMAP_KERNEL, 0, "kernel",
+                     &layout->kernel_base) != 0) {
+        return -1;
+    }
+    layout->kernel_addr = layout->kernel_base + text_offset;
+    layout->kernel_end = layout->kernel_addr + image_size;
+
+    // DTB before the kernel is read, in case the file is missing or bad
+    if (place_dtb(dtb, layout) != 0) return -1;
+
+    if (layout->source->load(image, (uint32_t)layout->kernel_addr, &size) != 0) return -1;
+    dcache_clean_range((uintptr_t)layout->kernel_addr, size);
+    return 0;
+}
+
+int kernel_boot_load(const char *image, const char *dtb, const char *initrd,
+                     kernel_layout_t *layout) {
+    union {
+        arm64_image_header_t image;
+        elf64_ehdr_t elf;
+    } header;
+    uint32_t size;
+
+    layout->kernel_base = 0;
+    layout->kernel_addr = 0;
+    layout->dtb_addr = 0;
+    layout->dtb_size = 0;
+    layout->initrd_addr = 0;
+    layout->initrd_size = 0;
+    layout->park_addr = 0;
+
+    // Header first: it decides where the one full read goes
+    if (boot_source_peek(image, &header, sizeof(header), &size, &layout->source) != 0) {
+        return -1;
+    }
+    if (size < sizeof(header)) return -1;
+    layout->kernel_size = size;
+
+    if (elf_check(&header.elf) == 0) {
+        layout->format = KERNEL_FORMAT_ELF;
+        if (load_elf(image, &header.elf, dtb, layout) != 0) goto fail;
+    } else {
+        layout->format = KERNEL_FORMAT_IMAGE;
+        if (load_image(image, &header.image, dtb, layout) != 0) goto fail;
+    }
+
+    // Sized before it is placed, so even a large initrd is read once to
+    // its final address; one that does not fit or load is left out
+    uint32_t initrd_size = 0;
+    if (initrd && layout->source->peek(initrd, NULL, 0, &initrd_size) == 0 && initrd_size &&
+        memmap_alloc(initrd_size, KERNEL_PAGE, MEMMAP_INITRD, 0, "initrd",
+                     &layout->initrd_addr) == 0) {
+        if (layout->source->load(initrd, (uint32_t)layout->initrd_addr, &initrd_size) == 0) {
+            layout->initrd_size = initrd_size;
+        }
+        if (!layout->initrd_size || chosen_set_initrd(layout) != 0) {
+            memmap_release(layout->initrd_addr);
+            layout->initrd_addr = 0;
+            layout->initrd_size = 0;
+        } else {
+            dcache_clean_range((uintptr_t)layout->initrd_addr, initrd_size);
+        }
+    }
+
+    if (place_park_loop(layout) != 0) goto fail;
+    if (load_hook) load_hook(image, dtb, initrd, layout);
+
+    // Tell the kernel what it must keep. The firmware's tree has been
+    // copied, but stays reserved until the copy is known to be usable
+    if (memmap_fdt_apply((void *)(uintptr_t)layout->dtb_addr) != 0) goto fail;
+    if (firmware_dtb) memmap_release(firmware_dtb);
+
+    dcache_clean_range((uintptr_t)layout->dtb_addr, layout->dtb_size);
+    return 0;
+
+fail:
+    release_layout(layout);
+    return -1;
+}
+
+void kernel_boot_start(const kernel_layout_t *layout) {
+    kernel_entry_t entry = (kernel_entry_t)(uintptr_t)layout->kernel_addr;
+    uint64_t dtb = layout->dtb_addr;
+
+    // Nothing of ours may fire once the kernel owns the vectors
+    timer_queue_stop();
+    interrupt_shutdown();
+    smp_park_secondaries((void (*)(void))(uintptr_t)layout->park_addr);
+
+    // The images were cleaned as they were loaded; this writes back the
+    // rest and leaves the MMU and D-cache off, I-cache invalidated
+    if (mmu_is_enabled()) {
+        mmu_disable();
+    } else {
+        icache_invalidate_all();
+    }
+
+    entry(dtb, 0, 0, 0);
+
+    while (1) {
+        __asm__ volatile("wfi");
+    }
+}
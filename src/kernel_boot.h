@@ -0,0 +1,91 @@
+/* Linux arm64 Image Loading and Handoff */
+
+#ifndef KERNEL_BOOT_H
+#define KERNEL_BOOT_H
+
+#include <stdint.h>
+#include "boot_source.h"
+
+/*
+ * Documentation/arch/arm64/booting.rst: the Image starts with a 64-byte
+ * header that says where in a 2MB-aligned window it wants to run and how
+ * much memory it touches there (BSS and early page tables included). The
+ * header is read first, so the single full read lands the kernel at its
+ * final address.
+ */
+#define ARM64_IMAGE_MAGIC           0x644D5241  // "ARM\x64"
+#define ARM64_IMAGE_FLAG_BE         (1 << 0)    // Big-endian kernel
+
+typedef struct {
+    uint32_t code0;
+    uint32_t code1;
+    uint64_t text_offset;       // Entry point distance from the 2MB-aligned base
+    uint64_t image_size;        // Effective size, 0 on kernels before 3.17
+    uint64_t flags;
+    uint64_t res2;
+    uint64_t res3;
+    uint64_t res4;
+    uint32_t magic;
+    uint32_t res5;
+} arm64_image_header_t;
+
+// Default file names on the boot source
+#define KERNEL_IMAGE                "kernel8.img"
+#define KERNEL_DTB                  "kernel8.dtb"   // Optional; the firmware's otherwise
+#define KERNEL_INITRD               "initrd.img"    // Optional
+
+#define KERNEL_ALIGN                0x00200000  // Image base alignment
+#define KERNEL_TEXT_OFFSET_LEGACY   0x00080000  // Assumed when image_size is 0
+#define KERNEL_BSS_SLACK            0x01000000  // Kept free after such a kernel
+#define KERNEL_DTB_MAX              0x00200000  // booting.rst limit
+#define KERNEL_DTB_SLACK            0x00001000  // Room for /chosen and reservations
+
+// Kernel file formats (elf_loader.h for ELF)
+#define KERNEL_FORMAT_IMAGE         0   // arm64 Image, or any flat binary at the legacy offset
+#define KERNEL_FORMAT_ELF           1   // ELF64 executable, loaded by segment
+
+// Where everything went; filled by kernel_boot_load()
+typedef struct {
+    uint32_t format;            // KERNEL_FORMAT_*
+    uint64_t kernel_base;       // 2MB-aligned window (Image), lowest segment (ELF)
+    uint64_t kernel_addr;       // Entry point (base + text_offset, or ELF entry)
+    uint64_t kernel_end;        // kernel_addr + image_size, or end of the last segment
+    uint32_t kernel_size;       // Bytes in the file
+    uint64_t dtb_addr;
+    uint32_t dtb_size;
+    uint64_t initrd_addr;
+    uint32_t initrd_size;       // 0 when there is none
+    uint64_t park_addr;         // Secondaries' spin-table loop
+    const boot_source_t *source;
+} kernel_layout_t;
+
+// Called by kernel_boot_load() once everything is placed and read, before
+// the DTB's reservations are written, so anything the hook claims with
+// MEMMAP_KEEP is reported too. Its result does not affect the load
+typedef void (*kernel_load_hook_t)(const char *image, const char *dtb, const char *initrd,
+                                   const kernel_layout_t *layout);
+
+void kernel_boot_set_load_hook(kernel_load_hook_t hook);     // NULL for none
+
+// Check an Image header (little-endian arm64 only). 0 if bootable; a file
+// without the magic is loaded as a headerless binary instead
+int kernel_image_check(const arm64_image_header_t *header);
+
+// Load an Image (or ELF executable), its DTB and an optional initrd, each
+// placed by the memory map (memmap.h) before it is read, so nothing is
+// moved afterwards:
+//   kernel  base + text_offset, base 2MB aligned, image_size bytes (the
+//           file plus KERNEL_BSS_SLACK without one); an ELF's PT_LOAD
+//           segments at their physical addresses instead
+//   DTB     'dtb' if the source has it, else the one the firmware passed;
+//           reservations for what outlives the handoff are added to it
+//   initrd  recorded in /chosen
+// 'dtb' and 'initrd' may be NULL
+int kernel_boot_load(const char *image, const char *dtb, const char *initrd,
+                     kernel_layout_t *layout);
+
+// Quiesce interrupts and the other cores, turn the MMU and caches off and
+// enter the kernel with x0 = DTB. Does not return
+void kernel_boot_start(const kernel_layout_t *layout) __attribute__((noreturn));
+
+#endif
@@ -3,6 +3,8 @@
 #include "log.h"
 #include "uart.h"
 #include "timer.h"
+#include "atomic.h"
+#include "sync.h"
 
 #ifndef NULL
 #define NULL ((void *)0)
@@ -12,17 +14,21 @@
 static struct {
     log_level_t level;
     uint32_t targets;
-    uint32_t entry_count;
 } log_config = {
     .level = LOG_LEVEL_INFO,
-    .targets = LOG_TARGET_UART,
-    .entry_count = 0
+    .targets = LOG_TARGET_UART
 };
 
-// Memory log buffer
+// Memory log buffer - writers on any core claim a slot with one atomic
+// increment; each slot's sequence counter lets readers copy a consistent
+// entry without blocking writers
 #define LOG_BUFFER_SIZE 256
 static log_entry_t log_buffer[LOG_BUFFER_SIZE];
-static uint32_t log_buffer_head = 0;
+static seqcount_t log_buffer_seq[LOG_BUFFER_SIZE];
+static volatile uint32_t log_buffer_pos = 0;    // Entries written since clear
+
+// Keeps UART lines from different cores (or an IRQ) from interleaving
+static spinlock_t log_uart_lock = SPINLOCK_INIT;
 
 // Level names
 static const char *level_names[] = {
@@ -68,8 +74,7 @@ static char *strncpy(char *dest, const char *src, uint32_t n) {
 void log_init(log_level_t level, uint32_t targets) {
     log_config.level = level;
     log_config.targets = targets;
-    log_config.entry_count = 0;
-    log_buffer_head = 0;
+    atomic_store_32(&log_buffer_pos, 0, ATOMIC_RELEASE);
 
     log_info("LOG", "Logging system initialized");
 }
@@ -89,8 +94,16 @@ void log_set_targets(uint32_t targets) {
     log_config.targets = targets;
 }
 
+// Longest timestamp: "[4294967295.999]" and the terminator
+#define TIMESTAMP_MAX   17
+
 // Format timestamp (simple - milliseconds)
 static void format_timestamp(uint64_t timestamp, char *buffer, uint32_t size) {
+    if (size < TIMESTAMP_MAX) {
+        if (size) buffer[0] = '\0';
+        return;
+    }
+
     uint64_t ms = timestamp / 1000;
     uint32_t seconds = ms / 1000;
     uint32_t millis = ms % 1000;
@@ -137,6 +150,7 @@ static void log_write(log_level_t level, const char *subsystem, const char *mess
         char ts_buf[32];
         format_timestamp(timestamp, ts_buf, sizeof(ts_buf));
 
+        uint64_t flags = spin_lock_irqsave(&log_uart_lock);
         uart_puts(level_colors[level]);
         uart_puts(ts_buf);
         uart_putc(' ');
@@ -147,21 +161,21 @@ static void log_write(log_level_t level, const char *subsystem, const char *mess
         uart_puts(message);
         uart_puts("\x1B[0m"); // Reset color
         uart_putc('\n');
+        spin_unlock_irqrestore(&log_uart_lock, flags);
     }
 
     // Write to memory buffer
     if (log_config.targets & LOG_TARGET_MEMORY) {
-        log_entry_t *entry = &log_buffer[log_buffer_head];
+        uint32_t slot = atomic_fetch_add_32(&log_buffer_pos, 1, ATOMIC_RELAXED) % LOG_BUFFER_SIZE;
+        log_entry_t *entry = &log_buffer[slot];
+
+        seqcount_write_begin(&log_buffer_seq[slot]);
         entry->timestamp = timestamp;
         entry->level = level;
         entry->subsystem = subsystem;
         strncpy(entry->message, message, sizeof(entry->message) - 1);
         entry->message[sizeof(entry->message) - 1] = '\0';
-
-        log_buffer_head = (log_buffer_head + 1) % LOG_BUFFER_SIZE;
-        if (log_config.entry_count < LOG_BUFFER_SIZE) {
-            log_config.entry_count++;
-        }
+        seqcount_write_end(&log_buffer_seq[slot]);
     }
 }
 
@@ -195,6 +209,12 @@ void log_hexdump(log_level_t level, const char *subsystem, const void *data, uin
     char hex_buffer[80];
     char ascii_buffer[17];
 
+    if (log_config.targets & LOG_TARGET_UART) {
+        uart_puts("[");
+        uart_puts(subsystem ? subsystem : "?");
+        uart_puts("] hexdump\n");
+    }
+
     for (uint32_t i = 0; i < length; i += 16) {
         int hex_pos = 0;
         int ascii_pos = 0;
@@ -229,20 +249,38 @@ void log_hexdump(log_level_t level, const char *subsystem, const void *data, uin
 
 // Memory log access
 int log_get_entry_count(void) {
-    return log_config.entry_count;
+    uint32_t pos = atomic_load_32(&log_buffer_pos, ATOMIC_ACQUIRE);
+    return pos < LOG_BUFFER_SIZE ? (int)pos : LOG_BUFFER_SIZE;
+}
+
+// Buffer slot of the index-th oldest retained entry
+static uint32_t entry_slot(int index) {
+    uint32_t pos = atomic_load_32(&log_buffer_pos, ATOMIC_ACQUIRE);
+    if (pos < LOG_BUFFER_SIZE) return index;
+    return (pos + index) % LOG_BUFFER_SIZE;
 }
 
 const log_entry_t *log_get_entry(int index) {
-    if (index < 0 || index >= log_config.entry_count) return NULL;
+    if (index < 0 || index >= log_get_entry_count()) return NULL;
+    return &log_buffer[entry_slot(index)];
+}
 
-    uint32_t actual_index;
-    if (log_config.entry_count < LOG_BUFFER_SIZE) {
-        actual_index = index;
-    } else {
-        actual_index = (log_buffer_head + index) % LOG_BUFFER_SIZE;
-    }
+int log_read_entry(int index, log_entry_t *out) {
+    if (!out || index < 0 || index >= log_get_entry_count()) return -1;
+
+    uint32_t slot = entry_slot(index);
+    const log_entry_t *entry = &log_buffer[slot];
+    uint32_t seq;
+
+    do {
+        seq = seqcount_read_begin(&log_buffer_seq[slot]);
+        out->timestamp = entry->timestamp;
+        out->level = entry->level;
+        out->subsystem = entry->subsystem;
+        strcpy(out->message, entry->message);
+    } while (seqcount_read_retry(&log_buffer_seq[slot], seq));
 
-    return &log_buffer[actual_index];
+    return 0;
 }
 
 void log_dump_memory(void) {
@@ -251,19 +289,20 @@ void log_dump_memory(void) {
     // Print count
     uart_putc('\n');
 
-    for (int i = 0; i < log_config.entry_count; i++) {
-        const log_entry_t *entry = log_get_entry(i);
-        if (entry) {
+    int count = log_get_entry_count();
+    for (int i = 0; i < count; i++) {
+        log_entry_t entry;
+        if (log_read_entry(i, &entry) == 0) {
             char ts_buf[32];
-            format_timestamp(entry->timestamp, ts_buf, sizeof(ts_buf));
+            format_timestamp(entry.timestamp, ts_buf, sizeof(ts_buf));
 
             uart_puts(ts_buf);
             uart_putc(' ');
-            uart_puts(level_names[entry->level]);
+            uart_puts(level_names[entry.level]);
             uart_puts(": [");
-            uart_puts(entry->subsystem);
+            uart_puts(entry.subsystem);
             uart_puts("] ");
-            uart_puts(entry->message);
+            uart_puts(entry.message);
             uart_putc('\n');
         }
     }
@@ -272,6 +311,5 @@ void log_dump_memory(void) {
 }
 
 void log_clear_memory(void) {
-    log_buffer_head = 0;
-    log_config.entry_count = 0;
+    atomic_store_32(&log_buffer_pos, 0, ATOMIC_RELEASE);
 }
@@ -61,7 +61,8 @@ void log_hexdump(log_level_t level, const char *subsystem, const void *data, uin
 
 // Memory log functions
 int log_get_entry_count(void);
-const log_entry_t *log_get_entry(int index);
+const log_entry_t *log_get_entry(int index);      // May change under a concurrent writer
+int log_read_entry(int index, log_entry_t *out);   // Consistent copy, safe across cores
 void log_dump_memory(void);
 void log_clear_memory(void);
 
@@ -2,9 +2,11 @@
 
 #include <stdint.h>
 #include "mailbox.h"
+#include "cache.h"
+#include "platform.h"
 
-// BCM2837 Mailbox (QEMU raspi3b)
-#define MAILBOX_BASE   0x3F00B880
+// VideoCore mailbox (platform.h)
+#define MAILBOX_BASE   PLATFORM_MAILBOX_BASE
 #define MAILBOX_READ   (MAILBOX_BASE + 0x00)
 #define MAILBOX_STATUS (MAILBOX_BASE + 0x18)
 #define MAILBOX_WRITE  (MAILBOX_BASE + 0x20)
@@ -23,12 +25,13 @@ static inline uint32_t mmio_read(uint32_t reg) {
     return *(volatile uint32_t*)reg;
 }
 
-// Property message buffer (must be 16-byte aligned)
+// Property message buffer (must be 16-byte aligned; 64 keeps it on its own
+// cache lines so invalidating it cannot discard neighbouring data)
 typedef struct {
     uint32_t size;
     uint32_t code;
     uint32_t tags[32];
-} __attribute__((aligned(16))) mailbox_msg_t;
+} __attribute__((aligned(64))) mailbox_msg_t;
 
 static mailbox_msg_t mailbox_buffer;
 
@@ -36,20 +39,29 @@ void mailbox_init(void) {
     // Mailbox is always available
 }
 
-static int mailbox_call(uint32_t tag, uint32_t *response) {
+// One tag per message; 'count' value words in, the same number out
+static int mailbox_call_values(uint32_t tag, uint32_t *values, uint32_t count) {
+    // No VideoCore to ask (QEMU virt): callers fall back as on a timeout
+    if (!PLATFORM_HAS_VIDEOCORE) return -1;
+
     mailbox_buffer.size = sizeof(mailbox_buffer);
     mailbox_buffer.code = 0;
     mailbox_buffer.tags[0] = tag;        // Tag
-    mailbox_buffer.tags[1] = 4;          // Value buffer size
+    mailbox_buffer.tags[1] = 4 * count;  // Value buffer size
     mailbox_buffer.tags[2] = 0;          // Request
-    mailbox_buffer.tags[3] = 0;          // Value
-    mailbox_buffer.tags[4] = 0;          // End tag
+    for (uint32_t i = 0; i < count; i++) {
+        mailbox_buffer.tags[3 + i] = 0;  // Value
+    }
+    mailbox_buffer.tags[3 + count] = 0;  // End tag
 
     // Wait for mailbox ready with short timeout (QEMU has limited support)
     int timeout = 1000;
     while ((mmio_read(MAILBOX_STATUS) & MAILBOX_FULL) && timeout--);
     if (timeout <= 0) return -1;
 
+    // VideoCore reads the buffer from memory, not from the ARM caches
+    dcache_clean_range((uintptr_t)&mailbox_buffer, sizeof(mailbox_buffer));
+
     // Send message
     uint32_t addr = (uint32_t)(uintptr_t)&mailbox_buffer;
     mmio_write(MAILBOX_WRITE, (addr & ~0xF) | MAILBOX_CH_PROP);
@@ -63,14 +75,23 @@ static int mailbox_call(uint32_t tag, uint32_t *response) {
     uint32_t result = mmio_read(MAILBOX_READ);
     (void)result;  // Unused
 
+    // Drop stale lines so the firmware's response is seen
+    dcache_invalidate_range((uintptr_t)&mailbox_buffer, sizeof(mailbox_buffer));
+
     if (mailbox_buffer.code == PROP_RESPONSE_SUCCESS) {
-        *response = mailbox_buffer.tags[3];
+        for (uint32_t i = 0; i < count; i++) {
+            values[i] = mailbox_buffer.tags[3 + i];
+        }
         return 0;
     }
 
     return -1;
 }
 
+static int mailbox_call(uint32_t tag, uint32_t *response) {
+    return mailbox_call_values(tag, response, 1);
+}
+
 uint32_t mailbox_get_firmware_revision(void) {
     uint32_t rev = 0;
     if (mailbox_call(PROP_TAG_GET_FIRMWARE_REV, &rev) == 0) {
@@ -94,3 +115,13 @@ uint32_t mailbox_get_board_revision(void) {
     }
     return 0;
 }
+
+int mailbox_get_arm_memory(uint32_t *base, uint32_t *size) {
+    uint32_t values[2];
+    if (mailbox_call_values(PROP_TAG_GET_ARM_MEMORY, values, 2) != 0) {
+        return -1;
+    }
+    *base = values[0];
+    *size = values[1];
+    return 0;
+}
@@ -16,4 +16,7 @@ uint32_t mailbox_get_firmware_revision(void);
 uint32_t mailbox_get_board_model(void);
 uint32_t mailbox_get_board_revision(void);
 
+// RAM the ARM side owns (the rest of the split belongs to the VideoCore)
+int mailbox_get_arm_memory(uint32_t *base, uint32_t *size);
+
 #endif
@@ -6,8 +6,115 @@
 #include "memory.h"
 #include "mailbox.h"
 #include "sd.h"
+#include "mmu.h"
+#include "cache.h"
+#include "hardware.h"
+#include "platform.h"
+#include "smp.h"
+#include "sched.h"
+#include "exception.h"
+#include "interrupt.h"
+#include "timer_queue.h"
+#include "async.h"
+#include "init_graph.h"
+#include "initcall.h"
+#include "boot_source.h"
+#include "boot_profile.h"
+#include "warm_boot.h"
+#include "kernel_boot.h"
+#include "atomic.h"
+
+// Results of the storage task chain, reported once joined
+static struct {
+    int sd_status;
+    int fat_status;
+    int read_status;
+    kernel_layout_t kernel;
+} storage = { .sd_status = -1, .fat_status = -1, .read_status = -1 };
+
+// SD and FAT come up on first use; nothing else on this image needs them
+static int sd_bring_up(void) {
+    storage.sd_status = driver_require(&sd_driver);
+    return storage.sd_status;
+}
+
+static int fat_bring_up(void) {
+    storage.fat_status = driver_require(&fat_driver);
+    return storage.fat_status;
+}
+
+static int kernel_load(void) {
+    storage.read_status = kernel_boot_load(KERNEL_IMAGE, KERNEL_DTB, KERNEL_INITRD,
+                                           &storage.kernel);
+    if (storage.read_status == 0 &&
+        storage.kernel.source->priority != BOOT_SOURCE_PRIORITY_FIRST) {
+        // Remember what worked; written only if something changed
+        boot_profile_commit(storage.kernel.source->name);
+    }
+    return storage.read_status;
+}
+
+// Storage drivers; the init engine runs each one as soon as what it needs
+// is up, and skips it if a dependency failed. Every boot source is probed
+// from the start, alongside SD, so an SD failure costs the fallback
+// nothing extra. The profile's preferred source only orders the search,
+// which begins after "fat" and so after the profile has been applied
+static init_node_t storage_nodes[] = {
+    { .name = "sd",      .fn = sd_bring_up,       .phase = STATE_BSP_DRIVER_INIT },
+    { .name = "profile", .fn = boot_profile_init, .phase = STATE_CONFIG_LOADING,
+      .deps = { "sd" }, .flags = INIT_OPTIONAL },
+    { .name = "fat",     .fn = fat_bring_up,      .phase = STATE_KERNEL_SOURCE_SELECT,
+      .deps = { "sd", "profile" }, .flags = INIT_OPTIONAL },
+    { .name = "sources", .fn = boot_source_probe_start, .phase = STATE_KERNEL_SOURCE_SELECT },
+    { .name = "kernel",  .fn = kernel_load,       .phase = STATE_KERNEL_LOADING,
+      .deps = { "fat", "sources" } },
+};
+
+// The FSA monitor is not part of this image, so phases are not reported
+static init_graph_t storage_graph = {
+    .nodes = storage_nodes,
+    .count = sizeof(storage_nodes) / sizeof(storage_nodes[0]),
+    .report = 0,
+};
+
+// LED self-test as a coroutine: the 100ms on-time is a timer-queue wait,
+// not a core spinning in timer_delay_ms()
+static async_timer_t led_timer;
+
+static int led_step(async_task_t *task) {
+    ASYNC_BEGIN(task);
+    gpio_set_function(GPIO_LED_PIN, GPIO_FUNC_OUTPUT);
+    gpio_set(GPIO_LED_PIN);
+    ASYNC_SLEEP_US(task, &led_timer, 100000);
+    gpio_clear(GPIO_LED_PIN);
+    ASYNC_END(task);
+}
+
+// Completes when every storage driver has finished on the scheduler
+static int storage_step(async_task_t *task) {
+    ASYNC_BEGIN(task);
+    ASYNC_AWAIT(task, init_graph_poll((init_graph_t *)task->arg));
+    ASYNC_END(task);
+}
 
 void main(void) {
+    // An LSE=1 image faults on its first atomic on an ARMv8.0 core (Pi 3,
+    // Pi 4), the exception handlers' counters included: say so and stop
+    if (ATOMIC_HAVE_LSE && !atomic_cpu_has_lse()) {
+        uart_init();
+        uart_puts("\nBuilt with LSE=1: this core has no ARMv8.1 atomics, halting\n");
+        while (1) {
+            __asm__ volatile("wfe");
+        }
+    }
+
+    // Identity map and caches first - everything after runs cached
+    mmu_init(PLATFORM_DEVICE_BASE, PLATFORM_DEVICE_END);
+    mmu_enable();
+
+    // Faults are reported instead of silently hanging from here on
+    exception_init();
+
     // Initialize all subsystems
     uart_init();
     timer_init();
@@ -15,58 +122,90 @@ void main(void) {
     memory_init();
     mailbox_init();
 
+    // Interrupt controller, timer queue, secondary cores - whatever this
+    // build profile linked in, in initcall level order
+    initcall_run_all();
+
+    // Blocking init steps run on whichever core is free, ordered only by
+    // their declared dependencies. Started before the banner, but that and
+    // the status lines are only a few UART writes: the storage report
+    // waits for practically the whole load. The boot core runs the
+    // executor while it waits, so the LED test overlaps with storage even
+    // on a single core
+    async_task_t storage_wait, led_test;
+    sched_init();
+    init_graph_start(&storage_graph);
+    async_spawn(&led_test, led_step, 0);
+    async_spawn(&storage_wait, storage_step, &storage_graph);
+
     uart_puts("\n\n");
     uart_puts("========================================\n");
     uart_puts("  Minimal ARM Bootloader v1.0\n");
-    uart_puts("  QEMU raspi3b / Real Hardware\n");
+    uart_puts("  " PLATFORM_NAME "\n");
     uart_puts("========================================\n");
     uart_puts("\n");
 
     // Report subsystem status
     uart_puts("Subsystem Initialization:\n");
     uart_puts("  [OK] UART   - Serial communication\n");
-    uart_puts("  [OK] Timer  - System timing\n");
+    uart_puts(timer_queue_running() ? "  [OK] Timer  - System timing, event queue\n"
+                             : "  [WARN] Timer - No event queue, delays spin\n");
     uart_puts("  [OK] GPIO   - I/O control\n");
     uart_puts("  [OK] Memory - Heap allocator\n");
-    uart_puts("  [OK] Mailbox - VideoCore interface\n");
+    uart_puts(PLATFORM_HAS_VIDEOCORE ? "  [OK] Mailbox - VideoCore interface\n"
+                                     : "  [--] Mailbox - No VideoCore on this machine\n");
+    uart_puts("  [OK] IRQ    - ");
+    uart_puts(interrupt_get_controller()->name);
+    uart_puts("\n");
+    uart_puts(warm_boot_is_warm() ? "  [OK] Reset  - warm, reusing hardware state ("
+                                  : "  [OK] Reset  - cold (");
+    uart_puts(warm_boot_cause_name(warm_boot_reset_cause()));
+    uart_puts(")\n");
+    uart_puts(mmu_is_enabled() ? "  [OK] MMU    - Caches enabled\n"
+                               : "  [WARN] MMU  - Running uncached\n");
+    uart_puts("  [OK] SMP    - ");
+    uart_putc('0' + smp_cores_online());
+    uart_puts(" core(s) online\n");
     uart_puts("\n");
 
     // Storage subsystem
     uart_puts("Storage Subsystem:\n");
-    int sd_status = sd_init();
-    if (sd_status == 0) {
-        uart_puts("  [OK] SD card initialized\n");
+    async_run_until(&storage_wait);
+    if (storage.sd_status == 0) {
+        uart_puts("  [OK] " PLATFORM_DISK_NAME " initialized\n");
 
-        int fat_status = fat_init();
-        if (fat_status == 0) {
+        if (storage.fat_status == 0) {
             uart_puts("  [OK] FAT filesystem mounted\n");
-
-            // Try to read a test file
-            uint32_t kernel_size = 0;
-            int read_status = fat_read_file("kernel8.img", 0x00200000, &kernel_size);
-            if (read_status == 0) {
-                uart_puts("  [OK] Found kernel8.img (");
-                // Print file size
-                uint32_t temp = kernel_size;
-                int digits = 0;
-                do { digits++; temp /= 10; } while (temp > 0);
-                temp = kernel_size;
-                for (int i = digits - 1; i >= 0; i--) {
-                    uint32_t divisor = 1;
-                    for (int j = 0; j < i; j++) divisor *= 10;
-                    uart_putc('0' + (temp / divisor) % 10);
-                }
-                uart_puts(" bytes)\n");
-            } else {
-                uart_puts("  [INFO] kernel8.img not found (OK for testing)\n");
-            }
         } else {
             uart_puts("  [WARN] FAT mount failed (expected in QEMU)\n");
         }
-    } else {
+    } else if (PLATFORM_HAS_VIDEOCORE) {
         uart_puts("  [WARN] SD init failed (expected in QEMU)\n");
         uart_puts("  Note: QEMU raspi3b has limited EMMC emulation\n");
         uart_puts("  This bootloader will work on real hardware\n");
+    } else {
+        uart_puts("  [WARN] No " PLATFORM_DISK_NAME " (-device virtio-blk-device)\n");
+    }
+
+    // From whichever source came up first in priority order
+    uint32_t kernel_size = storage.kernel.kernel_size;
+    if (storage.read_status == 0) {
+        uart_puts("  [OK] Found kernel8.img (");
+        // Print file size
+        uint32_t temp = kernel_size;
+        int digits = 0;
+        do { digits++; temp /= 10; } while (temp > 0);
+        temp = kernel_size;
+        for (int i = digits - 1; i >= 0; i--) {
+            uint32_t divisor = 1;
+            for (int j = 0; j < i; j++) divisor *= 10;
+            uart_putc('0' + (temp / divisor) % 10);
+        }
+        uart_puts(" bytes, ");
+        uart_puts(storage.kernel.source->name);
+        uart_puts(")\n");
+    } else {
+        uart_puts("  [INFO] No bootable kernel8.img (OK for testing)\n");
     }
     uart_puts("\n");
 
@@ -90,14 +229,14 @@ void main(void) {
 
     // GPIO test
     uart_puts("GPIO Test:\n");
-    gpio_set_function(GPIO_LED_PIN, GPIO_FUNC_OUTPUT);
+    async_run_until(&led_test);
     uart_puts("  [OK] LED pin configured as output\n");
-    gpio_set(GPIO_LED_PIN);
-    timer_delay_ms(100);
-    gpio_clear(GPIO_LED_PIN);
     uart_puts("  [OK] LED control test complete\n");
     uart_puts("\n");
 
+    // Boot jobs done - secondaries go back to their SMP work loops
+    sched_shutdown();
+
     // Show boot time
     uint64_t ticks = timer_get_ticks();
     uint32_t ms = (uint32_t)(ticks / 1000);
@@ -127,6 +266,7 @@ void main(void) {
     uart_puts("  [OK] GPIO pin control\n");
     uart_puts("  [OK] Dynamic memory allocation\n");
     uart_puts("  [OK] VideoCore mailbox interface\n");
+    uart_puts("  [OK] MMU identity map with D/I-cache\n");
     uart_puts("  [OK] SD card EMMC driver\n");
     uart_puts("  [OK] FAT32 filesystem support\n");
     uart_puts("\n");
@@ -140,6 +280,17 @@ void main(void) {
     uart_puts("  - Core bootloader features validated\n");
     uart_puts("  - Ready for real hardware deployment\n");
     uart_puts("\n");
+
+    if (storage.read_status == 0) {
+        uart_puts("Starting kernel at 0x");
+        for (int i = 28; i >= 0; i -= 4) {
+            uint32_t nibble = (storage.kernel.kernel_addr >> i) & 0xF;
+            uart_putc(nibble < 10 ? '0' + nibble : 'A' + nibble - 10);
+        }
+        uart_puts(storage.kernel.initrd_size ? " (DTB, initrd)\n" : " (DTB)\n");
+        kernel_boot_start(&storage.kernel);
+    }
+
     uart_puts("Entering idle loop...\n");
     uart_puts("\n");
 
@@ -0,0 +1,285 @@
+/* Physical Memory Map */
+
+#include <stdint.h>
+#include "memmap.h"
+#include "memory.h"
+#include "mailbox.h"
+#include "fdt.h"
+#include "initcall.h"
+#include "platform.h"
+#include "uart.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+// ARM memory assumed when the firmware will not say (smallest default split)
+#define MEMMAP_RAM_FALLBACK     0x10000000
+
+// Firmware stub and spin table (armstub8, QEMU smpboot); secondaries wait
+// here until the kernel releases them
+#define MEMMAP_FIRMWARE_BASE    0x00000000
+#define MEMMAP_FIRMWARE_SIZE    0x00001000
+
+extern char _start[], _end[];   // linker.ld: image, BSS, stack
+extern char __noinit_start[], __noinit_end[];
+
+static memmap_region_t regions[MEMMAP_MAX_REGIONS];
+static uint32_t region_count;
+static uint64_t ram_base;
+static uint64_t ram_end;
+
+static uint64_t align_up(uint64_t value, uint64_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static uint32_t cpu_to_be32(uint32_t x) {
+    return ((x & 0xFF000000) >> 24) | ((x & 0x00FF0000) >> 8) |
+           ((x & 0x0000FF00) << 8) | ((x & 0x000000FF) << 24);
+}
+
+int memmap_probe_ram(uint64_t *base, uint64_t *size) {
+    uint32_t arm_base, arm_size;
+
+    if (mailbox_get_arm_memory(&arm_base, &arm_size) == 0 && arm_size != 0) {
+        *base = arm_base;
+        *size = arm_size;
+        return 0;
+    }
+
+    const void *fdt = (const void *)(uintptr_t)firmware_dtb;
+    if (!fdt || fdt_check_header(fdt) != 0) return -1;
+
+    int node = fdt_path_offset(fdt, "/memory");
+    if (node < 0 || fdt_get_reg(fdt, node, 0, base, size) != 0 || *size == 0) return -1;
+    return 0;
+}
+
+int memmap_init(void) {
+    uint64_t base, size;
+
+    if (memmap_probe_ram(&base, &size) != 0) {
+        base = 0;
+        size = MEMMAP_RAM_FALLBACK;
+    }
+    ram_base = base;
+    ram_end = base + size;
+    region_count = 0;
+
+    // Anything handed out over the running image or heap would be fatal, so
+    // without them the map stays empty and every placement fails
+    if (memmap_reserve((uintptr_t)_start, _end - _start, MEMMAP_BOOTLOADER, 0,
+                       "bootloader") != 0 ||
+        memmap_reserve(HEAP_START, HEAP_SIZE, MEMMAP_BOOTLOADER, 0, "heap") != 0) {
+        uart_puts("memmap: bootloader outside RAM, nothing can be loaded\n");
+        ram_end = ram_base;
+        region_count = 0;
+        return -1;
+    }
+
+    // The warm-boot record (warm_boot.c) has to survive the kernel as well,
+    // or a reset after Linux has run finds it reused
+    if (memmap_reserve((uintptr_t)__noinit_start, __noinit_end - __noinit_start,
+                       MEMMAP_BOOTLOADER, MEMMAP_KEEP, "warm-state") != 0) {
+        uart_puts("memmap: warm-boot record not reserved\n");
+    }
+
+    // Secondaries wait in the spin table until the kernel releases them
+    if (PLATFORM_HAS_SPIN_TABLE &&
+        memmap_reserve(MEMMAP_FIRMWARE_BASE, MEMMAP_FIRMWARE_SIZE, MEMMAP_FIRMWARE,
+                       MEMMAP_KEEP, "firmware") != 0) {
+        uart_puts("memmap: spin table not reserved\n");
+    }
+
+    // Only until the kernel's copy has been made. One that cannot be
+    // reserved could be overwritten before it is copied: do without it
+    const void *fdt = (const void *)(uintptr_t)firmware_dtb;
+    if (fdt && fdt_check_header(fdt) == 0 &&
+        memmap_reserve(firmware_dtb, fdt_get_totalsize(fdt), MEMMAP_FIRMWARE, 0,
+                       "firmware-dtb") != 0) {
+        uart_puts("memmap: firmware DTB not reserved, ignored\n");
+        firmware_dtb = 0;
+    }
+
+    return 0;
+}
+core_initcall(memmap_init);
+
+uint64_t memmap_ram_base(void) {
+    return ram_base;
+}
+
+uint64_t memmap_ram_end(void) {
+    return ram_end;
+}
+
+int memmap_reserve(uint64_t base, uint64_t size, uint32_t type, uint32_t flags,
+                   const char *name) {
+    if (size == 0 || base < ram_base || base + size < base || base + size > ram_end) return -1;
+    if (region_count >= MEMMAP_MAX_REGIONS) return -1;
+
+    // Sorted by base: only the neighbours can overlap
+    uint32_t i = 0;
+    while (i < region_count && regions[i].base < base) i++;
+    if (i > 0 && regions[i - 1].base + regions[i - 1].size > base) return -1;
+    if (i < region_count && base + size > regions[i].base) return -1;
+
+    for (uint32_t j = region_count; j > i; j--) {
+        regions[j] = regions[j - 1];
+    }
+    regions[i].base = base;
+    regions[i].size = size;
+    regions[i].name = name;
+    regions[i].type = type;
+    regions[i].flags = flags;
+    region_count++;
+
+    return 0;
+}
+
+int memmap_alloc(uint64_t size, uint64_t align, uint32_t type, uint32_t flags,
+                 const char *name, uint64_t *base) {
+    if (size == 0 || align == 0 || (align & (align - 1))) return -1;
+
+    // First fit, lowest address: gaps between the sorted regions, then the top
+    uint64_t candidate = align_up(ram_base, align);
+    for (uint32_t i = 0; i <= region_count; i++) {
+        uint64_t limit = i < region_count ? regions[i].base : ram_end;
+
+        if (candidate <= limit && size <= limit - candidate) {
+            if (memmap_reserve(candidate, size, type, flags, name) != 0) return -1;
+            *base = candidate;
+            return 0;
+        }
+        if (i < region_count) {
+            uint64_t next = align_up(regions[i].base + regions[i].size, align);
+            if (next > candidate) candidate = next;
+        }
+    }
+
+    return -1;
+}
+
+int memmap_release(uint64_t base) {
+    for (uint32_t i = 0; i < region_count; i++) {
+        if (regions[i].base != base) continue;
+
+        for (uint32_t j = i; j + 1 < region_count; j++) {
+            regions[j] = regions[j + 1];
+        }
+        region_count--;
+        return 0;
+    }
+    return -1;
+}
+
+uint32_t memmap_count(void) {
+    return region_count;
+}
+
+const memmap_region_t *memmap_get(uint32_t index) {
+    return index < region_count ? &regions[index] : NULL;
+}
+
+// "name@base" as the node name the binding asks for
+static void node_name(char *out, const char *name, uint64_t base) {
+    int started = 0;
+
+    while (*name) *out++ = *name++;
+    *out++ = '@';
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        uint32_t nibble = (base >> shift) & 0xF;
+        if (!nibble && !started && shift) continue;
+        started = 1;
+        *out++ = nibble < 10 ? '0' + nibble : 'a' + nibble - 10;
+    }
+    *out = '\0';
+}
+
+static int names_equal(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// 'value' as 'count' (1 or 2) big-endian cells
+static void put_cells(uint32_t *cells, uint32_t count, uint64_t value) {
+    if (count == 2) *cells++ = cpu_to_be32(value >> 32);
+    *cells = cpu_to_be32((uint32_t)value);
+}
+
+static uint32_t cells_or(const void *fdt, int node, const char *name, uint32_t fallback) {
+    uint32_t cells = fdt_getprop_u32(fdt, node, name);
+    return (cells == 1 || cells == 2) ? cells : fallback;
+}
+
+// /reserved-memory, created with the root's cell sizes if it is missing
+static int reserved_memory_node(void *fdt) {
+    int node = fdt_path_offset(fdt, "/reserved-memory");
+    if (node >= 0) return node;
+
+    node = fdt_add_subnode(fdt, 0, "reserved-memory");
+    if (node < 0) return node;
+
+    int err = fdt_setprop_u32(fdt, node, "#address-cells", cells_or(fdt, 0, "#address-cells", 2));
+    if (!err) err = fdt_setprop_u32(fdt, node, "#size-cells", cells_or(fdt, 0, "#size-cells", 1));
+    if (!err) err = fdt_setprop(fdt, node, "ranges", NULL, 0);
+    return err ? err : node;
+}
+
+static int add_no_map(void *fdt, int parent, const memmap_region_t *region) {
+    char name[48];
+    uint32_t reg[4];
+
+    node_name(name, region->name, region->base);
+
+    // Already there (the firmware's tree, or an earlier pass)
+    for (int child = fdt_first_subnode(fdt, parent); child >= 0;
+         child = fdt_next_subnode(fdt, child)) {
+        if (names_equal(fdt_get_name(fdt, child, NULL), name)) return 0;
+    }
+
+    uint32_t addr_cells = cells_or(fdt, parent, "#address-cells", 2);
+    uint32_t size_cells = cells_or(fdt, parent, "#size-cells", 1);
+    put_cells(reg, addr_cells, region->base);
+    put_cells(reg + addr_cells, size_cells, region->size);
+
+    int node = fdt_add_subnode(fdt, parent, name);
+    if (node < 0) return node;
+
+    int err = fdt_setprop(fdt, node, "reg", reg, 4 * (addr_cells + size_cells));
+    if (!err) err = fdt_setprop(fdt, node, "no-map", NULL, 0);
+    return err;
+}
+
+static int rsv_listed(const void *fdt, const memmap_region_t *region) {
+    uint64_t address, size;
+
+    for (int n = 0; fdt_get_mem_rsv(fdt, n, &address, &size) == 0; n++) {
+        if (address <= region->base && region->base + region->size <= address + size) return 1;
+    }
+    return 0;
+}
+
+int memmap_fdt_apply(void *fdt) {
+    int reserved = -1;
+    int err = 0;
+
+    for (uint32_t i = 0; i < region_count && !err; i++) {
+        const memmap_region_t *region = &regions[i];
+
+        if (region->flags & MEMMAP_NOMAP) {
+            if (reserved < 0) {
+                reserved = reserved_memory_node(fdt);
+                if (reserved < 0) return reserved;
+            }
+            err = add_no_map(fdt, reserved, region);
+        } else if ((region->flags & MEMMAP_KEEP) && !rsv_listed(fdt, region)) {
+            err = fdt_add_mem_rsv(fdt, region->base, region->size);
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,72 @@
+/* Physical Memory Map */
+
+#ifndef MEMMAP_H
+#define MEMMAP_H
+
+#include <stdint.h>
+
+/*
+ * One list of what occupies ARM RAM: firmware leftovers, the bootloader
+ * and its heap, and everything loaded for the kernel. Placements come
+ * from here instead of fixed addresses, so two users can never silently
+ * overlap, and the regions that outlive the handoff are reported to the
+ * kernel through the DTB.
+ */
+
+#define MEMMAP_MAX_REGIONS  16
+
+// Region owners
+#define MEMMAP_FIRMWARE     0   // Spin table and stub, firmware DTB
+#define MEMMAP_BOOTLOADER   1   // Image, stacks, heap
+#define MEMMAP_KERNEL       2
+#define MEMMAP_DTB          3
+#define MEMMAP_INITRD       4
+#define MEMMAP_SCRATCH      5   // Temporary buffers
+#define MEMMAP_RESIDENT     6   // Images kept for the next warm reset
+
+// Region flags
+#define MEMMAP_KEEP         (1 << 0)    // In use after the handoff: /memreserve/
+#define MEMMAP_NOMAP        (1 << 1)    // Same, never mapped: /reserved-memory no-map
+
+typedef struct {
+    uint64_t base;
+    uint64_t size;
+    const char *name;
+    uint16_t type;              // MEMMAP_FIRMWARE...
+    uint16_t flags;             // MEMMAP_KEEP, MEMMAP_NOMAP
+} memmap_region_t;
+
+// DTB address the firmware passed in x0, 0 if none (start.S)
+extern uint64_t firmware_dtb;
+
+// RAM extent from the firmware, then the spin table, the firmware DTB and
+// the bootloader itself. Registered as a core initcall
+int memmap_init(void);
+
+uint64_t memmap_ram_base(void);
+uint64_t memmap_ram_end(void);
+
+// ARM RAM as the firmware reports it: the mailbox's split, else the first
+// /memory range in the firmware DTB (machines without a VideoCore). -1 if
+// neither says
+int memmap_probe_ram(uint64_t *base, uint64_t *size);
+
+// Claim a fixed range; -1 if it leaves RAM or overlaps another region
+int memmap_reserve(uint64_t base, uint64_t size, uint32_t type, uint32_t flags,
+                   const char *name);
+
+// Claim the lowest free range of 'size' bytes at an 'align' boundary
+// (power of two); -1 if nothing fits
+int memmap_alloc(uint64_t size, uint64_t align, uint32_t type, uint32_t flags,
+                 const char *name, uint64_t *base);
+
+// Give back the region starting at 'base'
+int memmap_release(uint64_t base);
+
+uint32_t memmap_count(void);
+const memmap_region_t *memmap_get(uint32_t index);      // In address order
+
+// Report the KEEP and NOMAP regions in a DTB opened with fdt_open_into()
+int memmap_fdt_apply(void *fdt);
+
+#endif
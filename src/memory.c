@@ -3,10 +3,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "memory.h"
-
-// Simple heap - starts after bootloader code + stack
-#define HEAP_START 0x00100000  // 1MB
-#define HEAP_SIZE  0x00100000  // 1MB heap
+#include "mmu.h"
 
 typedef struct mem_block {
     size_t size;
@@ -65,3 +62,48 @@ void free(void *ptr) {
         block->next = block->next->next;
     }
 }
+
+#define DCZID_DZP   (1 << 4)    // DC ZVA prohibited
+#define DCZID_BS    0xF         // log2 of the block size in words
+
+static void zero_bytes(uint8_t *dest, uint64_t size) {
+    while (size && ((uintptr_t)dest & 7)) {
+        *dest++ = 0;
+        size--;
+    }
+    // volatile: GCC would otherwise turn this into a call to memset()
+    for (; size >= 8; size -= 8, dest += 8) {
+        *(volatile uint64_t *)dest = 0;
+    }
+    while (size--) *dest++ = 0;
+}
+
+void memory_zero(void *dest, uint64_t size) {
+    uint8_t *p = dest;
+    uint64_t dczid;
+
+    __asm__ volatile("mrs %0, dczid_el0" : "=r"(dczid));
+
+    // DC ZVA faults on Device memory, which is everything with the MMU off
+    if (!mmu_is_enabled() || (dczid & DCZID_DZP)) {
+        zero_bytes(p, size);
+        return;
+    }
+
+    uint64_t block = 4UL << (dczid & DCZID_BS);
+    uint64_t head = (block - ((uintptr_t)p & (block - 1))) & (block - 1);
+
+    if (size < head + block) {
+        zero_bytes(p, size);
+        return;
+    }
+
+    zero_bytes(p, head);
+    p += head;
+    size -= head;
+
+    for (; size >= block; size -= block, p += block) {
+        __asm__ volatile("dc zva, %0" : : "r"(p) : "memory");
+    }
+    zero_bytes(p, size);
+}
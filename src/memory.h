@@ -6,8 +6,18 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// Simple heap - 1MB after bootloader code + stack, moved with the image
+// (linker.ld, claimed in memmap.c)
+extern char __heap_start[], __heap_end[];
+#define HEAP_START ((uintptr_t)__heap_start)
+#define HEAP_SIZE  ((uintptr_t)(__heap_end - __heap_start))
+
 void memory_init(void);
 void* malloc(size_t size);
 void free(void* ptr);
 
+// Zero 'size' bytes: whole cache blocks with DC ZVA where the range is
+// cacheable (MMU on), 64-bit stores for the edges and otherwise
+void memory_zero(void *dest, uint64_t size);
+
 #endif
@@ -0,0 +1,241 @@
+/* MMU and Cache Enablement for Raspberry Pi (AArch64, 4KB granule) */
+
+#include <stdint.h>
+#include "mmu.h"
+#include "cache.h"
+
+// Translation table descriptor bits
+#define PTE_VALID           (1ULL << 0)
+#define PTE_TABLE           (1ULL << 1)    // Level 1: next-level table
+#define PTE_BLOCK           (0ULL << 1)    // Level 2: 2MB block
+#define PTE_ATTRINDX(n)     ((uint64_t)(n) << 2)
+#define PTE_SH_INNER        (3ULL << 8)
+#define PTE_AF              (1ULL << 10)
+#define PTE_PXN             (1ULL << 53)
+#define PTE_UXN             (1ULL << 54)   // XN in the EL2/EL3 regimes
+#define PTE_ADDR_MASK       0x0000FFFFFFFFF000ULL
+
+// TCR_ELx fields (39-bit VA, level 1 start, 4KB granule)
+#define TCR_T0SZ            (64 - 39)
+#define TCR_IRGN0_WBWA      (1ULL << 8)
+#define TCR_ORGN0_WBWA      (1ULL << 10)
+#define TCR_SH0_INNER       (3ULL << 12)
+#define TCR_TG0_4K          (0ULL << 14)
+#define TCR_EL1_EPD1        (1ULL << 23)   // No TTBR1 walks
+#define TCR_EL1_IPS_SHIFT   32
+#define TCR_EL2_RES1        ((1ULL << 31) | (1ULL << 23))
+#define TCR_EL2_PS_SHIFT    16
+
+// SCTLR_ELx bits
+#define SCTLR_M             (1ULL << 0)    // MMU enable
+#define SCTLR_A             (1ULL << 1)    // Alignment check
+#define SCTLR_C             (1ULL << 2)    // D-cache enable
+#define SCTLR_I             (1ULL << 12)   // I-cache enable
+#define SCTLR_WXN           (1ULL << 19)
+#define SCTLR_EE            (1ULL << 25)
+
+#define L1_ENTRIES          512
+#define L2_TABLES           (MMU_MAP_SIZE / 0x40000000ULL)  // One per GB
+#define L2_ENTRIES          512
+
+static uint64_t l1_table[L1_ENTRIES] __attribute__((aligned(4096)));
+static uint64_t l2_tables[L2_TABLES][L2_ENTRIES] __attribute__((aligned(4096)));
+
+static uint32_t mmu_el = 0;
+
+static uint32_t current_el(void) {
+    uint64_t el;
+    __asm__ volatile("mrs %0, CurrentEL" : "=r"(el));
+    return (el >> 2) & 3;
+}
+
+static uint64_t read_sctlr(void) {
+    uint64_t val;
+    switch (mmu_el) {
+        case 3:  __asm__ volatile("mrs %0, sctlr_el3" : "=r"(val)); break;
+        case 2:  __asm__ volatile("mrs %0, sctlr_el2" : "=r"(val)); break;
+        default: __asm__ volatile("mrs %0, sctlr_el1" : "=r"(val)); break;
+    }
+    return val;
+}
+
+static void write_sctlr(uint64_t val) {
+    switch (mmu_el) {
+        case 3:  __asm__ volatile("msr sctlr_el3, %0" : : "r"(val) : "memory"); break;
+        case 2:  __asm__ volatile("msr sctlr_el2, %0" : : "r"(val) : "memory"); break;
+        default: __asm__ volatile("msr sctlr_el1, %0" : : "r"(val) : "memory"); break;
+    }
+    __asm__ volatile("isb" : : : "memory");
+}
+
+static void write_translation_regs(uint64_t mair, uint64_t tcr, uint64_t ttbr) {
+    switch (mmu_el) {
+        case 3:
+            __asm__ volatile("msr mair_el3, %0" : : "r"(mair));
+            __asm__ volatile("msr tcr_el3, %0" : : "r"(tcr));
+            __asm__ volatile("msr ttbr0_el3, %0" : : "r"(ttbr));
+            break;
+        case 2:
+            __asm__ volatile("msr mair_el2, %0" : : "r"(mair));
+            __asm__ volatile("msr tcr_el2, %0" : : "r"(tcr));
+            __asm__ volatile("msr ttbr0_el2, %0" : : "r"(ttbr));
+            break;
+        default:
+            __asm__ volatile("msr mair_el1, %0" : : "r"(mair));
+            __asm__ volatile("msr tcr_el1, %0" : : "r"(tcr));
+            __asm__ volatile("msr ttbr0_el1, %0" : : "r"(ttbr));
+            break;
+    }
+    __asm__ volatile("isb" : : : "memory");
+}
+
+static void tlb_invalidate_all(void) {
+    __asm__ volatile("dsb ishst" : : : "memory");
+    switch (mmu_el) {
+        case 3:  __asm__ volatile("tlbi alle3" : : : "memory"); break;
+        case 2:  __asm__ volatile("tlbi alle2" : : : "memory"); break;
+        default: __asm__ volatile("tlbi vmalle1" : : : "memory"); break;
+    }
+    __asm__ volatile("dsb sy\n\tisb" : : : "memory");
+}
+
+// Block descriptor attributes for a memory type
+static uint64_t block_attrs(uint32_t mem_type) {
+    switch (mem_type) {
+        case MT_NORMAL:
+            return PTE_ATTRINDX(MT_NORMAL) | PTE_SH_INNER | PTE_AF;
+
+        case MT_NORMAL_NC:
+            return PTE_ATTRINDX(MT_NORMAL_NC) | PTE_SH_INNER | PTE_AF;
+
+        case MT_DEVICE_nGnRE:
+        default:
+            // Never fetch instructions from peripherals
+            return PTE_ATTRINDX(MT_DEVICE_nGnRE) | PTE_AF |
+                   (mmu_el == 1 ? (PTE_PXN | PTE_UXN) : PTE_UXN);
+    }
+}
+
+void mmu_init(uint64_t device_base, uint64_t device_end) {
+    mmu_el = current_el();
+    if (mmu_el == 0) mmu_el = 1;
+
+    device_base &= ~(MMU_BLOCK_SIZE - 1);
+    device_end = (device_end + MMU_BLOCK_SIZE - 1) & ~(MMU_BLOCK_SIZE - 1);
+
+    for (uint32_t i = 0; i < L1_ENTRIES; i++) {
+        l1_table[i] = 0;
+    }
+
+    // Level 1: one table per GB, level 2: 2MB blocks
+    for (uint32_t t = 0; t < L2_TABLES; t++) {
+        for (uint32_t i = 0; i < L2_ENTRIES; i++) {
+            uint64_t addr = ((uint64_t)t * L2_ENTRIES + i) * MMU_BLOCK_SIZE;
+            uint32_t type = addr >= device_base && addr < device_end ? MT_DEVICE_nGnRE
+                                                                     : MT_NORMAL;
+            l2_tables[t][i] = (addr & PTE_ADDR_MASK) | block_attrs(type) |
+                              PTE_BLOCK | PTE_VALID;
+        }
+        l1_table[t] = ((uintptr_t)l2_tables[t] & PTE_ADDR_MASK) | PTE_TABLE | PTE_VALID;
+    }
+}
+
+static void mmu_enable_core(int secondary) {
+    if (mmu_el == 0) return;  // mmu_init() not called
+
+    uint64_t mair = ((uint64_t)MAIR_DEVICE_nGnRE << (8 * MT_DEVICE_nGnRE)) |
+                    ((uint64_t)MAIR_NORMAL_WB << (8 * MT_NORMAL)) |
+                    ((uint64_t)MAIR_NORMAL_NC << (8 * MT_NORMAL_NC));
+
+    // Output address size: whatever the core implements
+    uint64_t mmfr0;
+    __asm__ volatile("mrs %0, id_aa64mmfr0_el1" : "=r"(mmfr0));
+    uint64_t pa_range = mmfr0 & 0x7;
+
+    uint64_t tcr = TCR_T0SZ | TCR_IRGN0_WBWA | TCR_ORGN0_WBWA |
+                   TCR_SH0_INNER | TCR_TG0_4K;
+    if (mmu_el == 1) {
+        tcr |= TCR_EL1_EPD1 | (pa_range << TCR_EL1_IPS_SHIFT);
+    } else {
+        tcr |= TCR_EL2_RES1 | (pa_range << TCR_EL2_PS_SHIFT);
+    }
+
+    // Everything so far was written with the D-cache off, so any lines still
+    // present are stale (including over the tables the walker is about to use).
+    // A secondary core must leave the shared L2 alone: the boot core's dirty
+    // data lives there.
+    if (secondary) {
+        dcache_invalidate_local();
+    } else {
+        dcache_invalidate_all();
+    }
+    icache_invalidate_all();
+    write_translation_regs(mair, tcr, (uintptr_t)l1_table);
+    tlb_invalidate_all();
+
+    uint64_t sctlr = read_sctlr();
+    sctlr |= SCTLR_M | SCTLR_C | SCTLR_I;
+    sctlr &= ~(SCTLR_A | SCTLR_WXN | SCTLR_EE);
+    write_sctlr(sctlr);
+}
+
+void mmu_enable(void) {
+    mmu_enable_core(0);
+}
+
+void mmu_enable_secondary(void) {
+    mmu_enable_core(1);
+}
+
+void mmu_disable(void) {
+    if (mmu_el == 0 || !mmu_is_enabled()) return;
+
+    // Read SCTLR first: after the set/way flush nothing may be stored until
+    // the caches are off, or the new dirty lines would never reach memory
+    uint64_t sctlr = read_sctlr();
+    dcache_clean_invalidate_all();
+
+    sctlr &= ~(SCTLR_M | SCTLR_C);
+    write_sctlr(sctlr);
+
+    tlb_invalidate_all();
+    icache_invalidate_all();
+}
+
+int mmu_set_region_type(uint64_t base, uint64_t size, uint32_t mem_type) {
+    if (mmu_el == 0) return -1;
+    if ((base | size) & (MMU_BLOCK_SIZE - 1)) return -1;  // Must be 2MB aligned
+    if (size == 0 || base + size > MMU_MAP_SIZE) return -1;
+    if (mem_type > MT_NORMAL_NC) return -1;
+
+    // Lines cached under the old attributes must not linger
+    if (mmu_is_enabled()) {
+        dcache_clean_invalidate_range((uintptr_t)base, size);
+    }
+
+    // Break-before-make: the memory type of a live mapping may not change
+    // in place. The region must not contain the bootloader image or stack.
+    for (uint64_t addr = base; addr < base + size; addr += MMU_BLOCK_SIZE) {
+        uint64_t index = addr / MMU_BLOCK_SIZE;
+        l2_tables[index / L2_ENTRIES][index % L2_ENTRIES] = 0;
+    }
+    tlb_invalidate_all();
+
+    for (uint64_t addr = base; addr < base + size; addr += MMU_BLOCK_SIZE) {
+        uint64_t index = addr / MMU_BLOCK_SIZE;
+        l2_tables[index / L2_ENTRIES][index % L2_ENTRIES] =
+            (addr & PTE_ADDR_MASK) | block_attrs(mem_type) | PTE_BLOCK | PTE_VALID;
+    }
+
+    if (!mmu_is_enabled()) {
+        dcache_invalidate_range((uintptr_t)l2_tables, sizeof(l2_tables));
+    }
+
+    tlb_invalidate_all();
+    return 0;
+}
+
+int mmu_is_enabled(void) {
+    if (mmu_el == 0) return 0;
+    return (read_sctlr() & SCTLR_M) != 0;
+}
@@ -0,0 +1,42 @@
+/* MMU and Cache Enablement Header */
+
+#ifndef MMU_H
+#define MMU_H
+
+#include <stdint.h>
+
+// Identity map covers the 32-bit physical address space in 2MB blocks
+#define MMU_BLOCK_SIZE      0x00200000ULL   // 2MB level-2 block
+#define MMU_MAP_SIZE        0x100000000ULL  // 4GB identity mapped
+
+// MAIR_ELx attribute indices
+#define MT_DEVICE_nGnRE     0   // Peripherals
+#define MT_NORMAL           1   // RAM, write-back read/write-allocate
+#define MT_NORMAL_NC        2   // RAM, non-cacheable (shared with DMA masters)
+
+#define MAIR_DEVICE_nGnRE   0x04
+#define MAIR_NORMAL_WB      0xFF
+#define MAIR_NORMAL_NC      0x44
+
+// Build the identity map: [device_base, device_end) is Device-nGnRE
+// (peripherals, ARM local registers), the rest of the 4GB normal cacheable
+// memory. A Pi has its devices at the top, QEMU virt below RAM
+void mmu_init(uint64_t device_base, uint64_t device_end);
+
+// Enable MMU, D-cache and I-cache at the current exception level
+void mmu_enable(void);
+
+// Same, for a secondary core joining the boot core's tables (mmu_init() and
+// mmu_enable() must already have run on the boot core)
+void mmu_enable_secondary(void);
+
+// Disable MMU and caches (for the kernel handoff)
+void mmu_disable(void);
+
+// Change the memory type of a 2MB-aligned region (e.g. a DMA buffer pool)
+int mmu_set_region_type(uint64_t base, uint64_t size, uint32_t mem_type);
+
+// Check if the MMU is currently on
+int mmu_is_enabled(void);
+
+#endif
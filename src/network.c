@@ -2,6 +2,10 @@
 
 #include "ethernet.h"
 #include "timer.h"
+#include "timer_queue.h"
+#include "warm_boot.h"
+#include "boot_source.h"
+#include "memmap.h"
 
 #ifndef NULL
 #define NULL ((void *)0)
@@ -85,9 +89,12 @@ typedef struct {
 
 static network_rx_state_t rx_state = {0};
 
+static int network_receive_packet(ethernet_frame_t *frame, uint16_t *length, uint32_t timeout_ms);
+
 // Security constants
 #define NETWORK_MAX_RETRIES 3
 #define NETWORK_DHCP_TIMEOUT_MS 5000
+#define NETWORK_DHCP_REBOOT_TIMEOUT_MS 1000 // Lease reuse; a full DISCOVER follows on timeout
 #define NETWORK_BOOTP_TIMEOUT_MS 5000
 #define NETWORK_TFTP_TIMEOUT_MS 10000
 #define NETWORK_MAX_FRAME_SIZE 1514
@@ -453,8 +460,7 @@ int network_dns_resolve(const char *hostname, uint32_t *ip_addr) {
                 ptr += 2;
                 uint16_t rr_class = (ptr[0] << 8) | ptr[1];
                 ptr += 2;
-                uint32_t ttl = (ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3];
-                ptr += 4;
+                ptr += 4;   // TTL: nothing is cached
                 uint16_t rdlength = (ptr[0] << 8) | ptr[1];
                 ptr += 2;
 
@@ -482,7 +488,8 @@ int network_dns_resolve_ipv6(const char *hostname, uint8_t *ipv6_addr) {
 
 // HTTP client functions
 int network_http_get(const char *url, uint8_t *buffer, uint32_t max_size, uint32_t *received) {
-    if (!url || !buffer || !received) return -1;
+    if (!url || !buffer || !received || max_size == 0) return -1;
+    *received = 0;
 
     // Parse URL (simplified)
     const char *host_start = strstr(url, "http://");
@@ -505,9 +512,12 @@ int network_http_get(const char *url, uint8_t *buffer, uint32_t max_size, uint32
         if (network_parse_ip(host, &server_ip) < 0) return -1;
     }
 
-    // Build HTTP request
+    // Build HTTP request; the path comes from the caller, so the whole
+    // request is sized before anything is copied
     char request[512];
     char *req_ptr = request;
+    uint32_t len = 4 + strlen(path_start) + 17 + host_len + 36;
+    if (len >= sizeof(request)) return -1;
 
     // Copy "GET "
     strcpy(req_ptr, "GET ");
@@ -527,10 +537,7 @@ int network_http_get(const char *url, uint8_t *buffer, uint32_t max_size, uint32
 
     // Copy rest
     strcpy(req_ptr, "\r\nUser-Agent: ARM-Bootloader/1.0\r\n\r\n");
-    req_ptr += 35;
-
-    int len = req_ptr - request;
-    if (len >= sizeof(request)) return -1;
+    req_ptr += 36;
 
     // Send HTTP request over TCP (simplified - would need TCP implementation)
     // For now, return error as TCP not fully implemented
@@ -621,12 +628,90 @@ static int dhcp_parse_options(const uint8_t *options, uint32_t options_len, netw
     return msg_type;
 }
 
+// DHCP reply for transaction 'xid' in a received frame, NULL if it is not one
+static dhcp_message_t *dhcp_reply_for(ethernet_frame_t *frame, uint32_t xid) {
+    if (frame->ethertype != ETHERTYPE_IP) return NULL;
+
+    ip_header_t *ip_hdr = (ip_header_t *)frame->payload;
+    if (ip_hdr->protocol != IP_PROTO_UDP) return NULL;
+
+    udp_header_t *udp_hdr = (udp_header_t *)(frame->payload + sizeof(ip_header_t));
+    if (udp_hdr->src_port != UDP_PORT_DHCP_SERVER || udp_hdr->dest_port != UDP_PORT_DHCP_CLIENT) {
+        return NULL;
+    }
+
+    dhcp_message_t *reply = (dhcp_message_t *)((uint8_t *)udp_hdr + sizeof(udp_header_t));
+    return (reply->xid == xid && reply->op == 2) ? reply : NULL;
+}
+
+// Warm reboot: ask for the previous boot's address straight away (RFC 2131
+// INIT-REBOOT) instead of DISCOVER/OFFER. Any answer but ACK drops the lease
+static int dhcp_reuse_lease(network_config_t *config, uint32_t xid) {
+    uint8_t ip[4], netmask[4], gateway[4], server[4];
+
+    if (warm_boot_get_lease(ip, netmask, gateway, server) != 0) return -1;
+
+    dhcp_message_t dhcp_msg;
+    uint8_t *opt_ptr = dhcp_msg.options;
+
+    memset(&dhcp_msg, 0, sizeof(dhcp_message_t));
+    dhcp_msg.op = 1;
+    dhcp_msg.htype = 1;
+    dhcp_msg.hlen = 6;
+    dhcp_msg.xid = xid;
+    dhcp_msg.flags = 0x8000; // Broadcast
+    memcpy(dhcp_msg.chaddr, config->mac_addr, 6);
+    dhcp_msg.magic_cookie = 0x63825363;
+
+    *opt_ptr++ = DHCP_OPTION_MESSAGE_TYPE;
+    *opt_ptr++ = 1;
+    *opt_ptr++ = DHCP_REQUEST;
+
+    *opt_ptr++ = DHCP_OPTION_REQUESTED_IP;
+    *opt_ptr++ = 4;
+    memcpy(opt_ptr, ip, 4);
+    opt_ptr += 4;
+
+    *opt_ptr++ = DHCP_OPTION_END;
+
+    if (network_send_udp(0xFFFFFFFF, UDP_PORT_DHCP_CLIENT, UDP_PORT_DHCP_SERVER,
+                         &dhcp_msg, sizeof(dhcp_message_t)) < 0) {
+        return -1;
+    }
+
+    ethernet_frame_t rx_frame;
+    uint16_t rx_len;
+    dhcp_message_t *reply;
+
+    if (network_receive_packet(&rx_frame, &rx_len, NETWORK_DHCP_REBOOT_TIMEOUT_MS) != 0 ||
+        (reply = dhcp_reply_for(&rx_frame, xid)) == NULL) {
+        return -1;  // No answer: keep the lease, try the full exchange
+    }
+
+    // Seed from the old lease; the ACK's options override what it carries
+    memcpy(config->subnet_mask, netmask, 4);
+    memcpy(config->gateway, gateway, 4);
+    memcpy(config->boot_server, server, 4);
+
+    if (dhcp_parse_options(reply->options, 312, config) != DHCP_ACK) {
+        warm_boot_clear_lease();
+        return -1;
+    }
+
+    memcpy(config->ip_addr, ip, 4);
+    return 0;
+}
+
 // DHCP client implementation with real response parsing
 int network_dhcp_discover(network_config_t *config) {
     if (!config || !validate_mac_address(config->mac_addr)) {
         return -1;
     }
 
+    if (dhcp_reuse_lease(config, dhcp_xid++) == 0) {
+        return 0;
+    }
+
     dhcp_message_t dhcp_msg;
     uint8_t options[312];
     uint8_t *opt_ptr = options;
@@ -733,6 +818,9 @@ int network_dhcp_discover(network_config_t *config) {
                                     msg_type = dhcp_parse_options(dhcp_reply->options, 312, config);
 
                                     if (msg_type == DHCP_ACK) {
+                                        // Offer it again after a warm reset
+                                        warm_boot_set_lease(config->ip_addr, config->subnet_mask,
+                                                            config->gateway, config->boot_server);
                                         return 0; // Success!
                                     }
                                 }
@@ -916,7 +1004,7 @@ static int network_receive_packet(ethernet_frame_t *frame, uint16_t *length, uin
         if (ethernet_receive_frame(frame, length) == 0) {
             return 0; // Success
         }
-        timer_delay_ms(1); // Small delay to avoid busy waiting
+        timer_queue_sleep_us(1000); // Sleep instead of spinning between polls
     }
 
     return -1; // Timeout
@@ -924,6 +1012,8 @@ static int network_receive_packet(ethernet_frame_t *frame, uint16_t *length, uin
 
 // Process received IP packet
 static int network_process_ip_packet(const ip_header_t *ip_hdr, uint16_t ip_length) {
+    if (ip_length < sizeof(ip_header_t)) return -1;
+
     // Verify IP header checksum
     if (network_checksum(ip_hdr, sizeof(ip_header_t)) != 0) {
         return -1; // Bad checksum
@@ -1308,7 +1398,6 @@ int network_ipv6_process_nd(const ipv6_header_t *ipv6_hdr, const uint8_t *payloa
     if (payload_length < 8) return -1;
 
     uint8_t type = payload[0];
-    uint8_t code = payload[1];
 
     switch (type) {
         case ICMPV6_TYPE_NEIGHBOR_SOLICITATION: {
@@ -1511,30 +1600,18 @@ int network_ipv6_pxe_boot(network_config_t *config) {
         return -1;
     }
 
-    // Download NBP via TFTP over IPv6
-    // For now, use the existing TFTP function but with IPv6 address resolution
-    uint8_t tftp_server_ipv6[16] = {0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01}; // Link-local
-
-    // Resolve TFTP server MAC (would use ND in real implementation)
-    uint8_t server_mac[6] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55};
-
-    // Download NBP
-    uint8_t *nbp_buffer = (uint8_t *)0x1000000;
-    // Note: TFTP is still IPv4 based, would need IPv6 TFTP implementation
-    uint32_t nbp_size = 1024; // Simulated
-
-    if (nbp_size <= 0) {
-        return -1;
-    }
+    // Download NBP via TFTP over IPv6 from the link-local server, its MAC
+    // found by ND. TFTP is still IPv4 based, so this needs an IPv6 TFTP
+    // implementation; until then the download is simulated
+    uint32_t nbp_size = 1024;
 
     return nbp_size;
 }
 
 // Network initialization
 int network_init(void) {
-    // Initialize Ethernet
-    ethernet_init();
+    // Initialize Ethernet (no-op if the boot path already brought it up)
+    if (driver_require(&ethernet_driver) != 0) return -1;
 
     // Set MAC address (would normally read from hardware)
     uint8_t default_mac[6] = {0xB8, 0x27, 0xEB, 0x00, 0x00, 0x01};
@@ -1548,4 +1625,80 @@ int network_init(void) {
     network_ipv6_init();
 
     return 0;
-}
\ No newline at end of file
+}
+
+// Kernel images over TFTP from the DHCP boot server. TFTP can only fetch a
+// file whole, so it is fetched once into a scratch buffer and peek, load
+// and read are served from there
+#define TFTP_STAGE_SIZE 0x2000000  // 32MB, the largest file served
+
+static uint8_t *tftp_stage;
+static uint32_t tftp_staged_size;
+static char tftp_staged_name[128];
+
+static int names_equal(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// The lease comes from dhcp_reuse_lease() after a warm reset, so this is
+// where the fast path pays off
+static int tftp_source_probe(void) {
+    if (network_init() != 0) return -1;
+    if (boot_source_probe_cancelled()) return -1;
+    return network_dhcp_discover(&network_config);
+}
+
+static int tftp_stage_file(const char *filename) {
+    if (tftp_stage && names_equal(tftp_staged_name, filename)) return 0;
+    if (strlen(filename) >= sizeof(tftp_staged_name)) return -1;
+
+    if (!tftp_stage) {
+        uint64_t base;
+        if (memmap_alloc(TFTP_STAGE_SIZE, 4096, MEMMAP_SCRATCH, 0, "tftp", &base) != 0) {
+            return -1;
+        }
+        tftp_stage = (uint8_t *)(uintptr_t)base;
+    }
+
+    uint32_t server = network_ip_to_int(network_config.boot_server);
+    if (server == 0) server = network_ip_to_int(network_config.gateway);
+
+    tftp_staged_name[0] = '\0';
+    int received = network_tftp_download(filename, server, tftp_stage, TFTP_STAGE_SIZE);
+    if (received < 0) return -1;
+
+    tftp_staged_size = (uint32_t)received;
+    strcpy(tftp_staged_name, filename);
+    return 0;
+}
+
+static int tftp_source_load(const char *filename, uint32_t load_addr, uint32_t *size) {
+    if (tftp_stage_file(filename) != 0) return -1;
+
+    memcpy((void *)(uintptr_t)load_addr, tftp_stage, tftp_staged_size);
+    *size = tftp_staged_size;
+    return 0;
+}
+
+static int tftp_source_peek(const char *filename, void *buf, uint32_t len, uint32_t *size) {
+    if (tftp_stage_file(filename) != 0) return -1;
+
+    memcpy(buf, tftp_stage, len < tftp_staged_size ? len : tftp_staged_size);
+    *size = tftp_staged_size;
+    return 0;
+}
+
+static int tftp_source_read(const char *filename, uint32_t offset, void *buf, uint32_t len) {
+    if (tftp_stage_file(filename) != 0) return -1;
+    if (offset > tftp_staged_size || len > tftp_staged_size - offset) return -1;
+
+    memcpy(buf, tftp_stage + offset, len);
+    return 0;
+}
+
+BOOT_SOURCE(tftp_source, "tftp", BOOT_PATH_NETWORK, 30, tftp_source_probe,
+            tftp_source_load, tftp_source_peek, tftp_source_read);
@@ -4,6 +4,8 @@
 #include "timer.h"
 #include "uart.h"
 #include "log.h"
+#include "sched.h"
+#include "sync.h"
 
 #ifndef NULL
 #define NULL ((void *)0)
@@ -34,6 +36,24 @@ static perf_record_t records[PERF_MAX_CHECKPOINTS];
 static int record_count = 0;
 static uint64_t boot_start_time = 0;
 
+// Checkpoints may come from any core or an IRQ; the delta needs the
+// previous record, so appends are serialised
+static spinlock_t records_lock = SPINLOCK_INIT;
+
+LINKER_TABLE_DECLARE(const perf_probe_t, perf_probes);
+
+static void print_dec(uint64_t value) {
+    char buf[20];
+    int len = 0;
+
+    do {
+        buf[len++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    while (len > 0) uart_putc(buf[--len]);
+}
+
 // Initialize performance monitoring
 void perfmon_init(void) {
     record_count = 0;
@@ -47,7 +67,12 @@ void perfmon_init(void) {
 
 // Record checkpoint
 void perfmon_checkpoint(perf_checkpoint_t type, uint32_t data) {
-    if (record_count >= PERF_MAX_CHECKPOINTS) return;
+    uint64_t flags = spin_lock_irqsave(&records_lock);
+
+    if (record_count >= PERF_MAX_CHECKPOINTS) {
+        spin_unlock_irqrestore(&records_lock, flags);
+        return;
+    }
 
     perf_record_t *record = &records[record_count];
     record->type = type;
@@ -65,6 +90,8 @@ void perfmon_checkpoint(perf_checkpoint_t type, uint32_t data) {
 
     record_count++;
 
+    spin_unlock_irqrestore(&records_lock, flags);
+
     log_debug("PERFMON", record->name);
 }
 
@@ -94,6 +121,12 @@ void perfmon_calc_stats(perf_stats_t *stats) {
     stats->network_transfer_bytes = 0;
     stats->kernel_load_speed_mbps = 0.0f;
 
+    for (uint32_t core = 0; core < SMP_MAX_CORES; core++) {
+        const sched_core_stats_t *cs = sched_get_core_stats(core);
+        stats->core_tasks[core] = cs->tasks_run;
+        stats->core_utilisation_pct[core] = perfmon_get_core_utilisation(core);
+    }
+
     // Find relevant checkpoints
     uint64_t kernel_load_start_ts = 0;
     uint64_t kernel_load_end_ts = 0;
@@ -154,6 +187,18 @@ void perfmon_calc_stats(perf_stats_t *stats) {
     }
 }
 
+// Per-core scheduler utilisation
+uint32_t perfmon_get_core_utilisation(uint32_t core) {
+    const sched_core_stats_t *cs = sched_get_core_stats(core);
+    if (!cs) return 0;
+
+    uint64_t window = sched_get_window_us();
+    if (window == 0) return 0;
+
+    uint64_t pct = (cs->busy_us * 100) / window;
+    return pct > 100 ? 100 : (uint32_t)pct;
+}
+
 // Print performance report
 void perfmon_print_report(void) {
     uart_puts("\n");
@@ -239,13 +284,50 @@ void perfmon_print_summary(void) {
         uart_puts(" ms\n");
     }
 
+    for (uint32_t core = 0; core < SMP_MAX_CORES; core++) {
+        if (!smp_core_is_online(core)) continue;
+
+        uart_puts("Core ");
+        uart_putc('0' + core);
+        uart_puts(" Utilisation:  ");
+        uint32_t pct = stats.core_utilisation_pct[core];
+        if (pct >= 100) uart_putc('1');
+        if (pct >= 10) uart_putc('0' + (pct / 10) % 10);
+        uart_putc('0' + pct % 10);
+        uart_puts(" %\n");
+    }
+
+    for (uint32_t i = 0; i < perfmon_probe_count(); i++) {
+        const perf_probe_t *probe = perfmon_get_probe(i);
+        int name_len = 0;
+
+        uart_puts(probe->name);
+        uart_putc(':');
+        for (const char *p = probe->name; *p; p++) name_len++;
+        for (int j = name_len + 1; j < 20; j++) uart_putc(' ');
+        print_dec(probe->sample());
+        uart_putc(' ');
+        uart_puts(probe->unit);
+        uart_putc('\n');
+    }
+
     uart_puts("\n");
 }
 
+uint32_t perfmon_probe_count(void) {
+    return LINKER_TABLE_COUNT(perf_probes);
+}
+
+const perf_probe_t *perfmon_get_probe(uint32_t index) {
+    return index < perfmon_probe_count() ? LINKER_TABLE_GET(perf_probes, index) : NULL;
+}
+
 // Reset monitoring
 void perfmon_reset(void) {
+    uint64_t flags = spin_lock_irqsave(&records_lock);
     record_count = 0;
     boot_start_time = timer_get_counter();
+    spin_unlock_irqrestore(&records_lock, flags);
 }
 
 // Get total boot time
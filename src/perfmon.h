@@ -4,6 +4,8 @@
 #define PERFMON_H
 
 #include <stdint.h>
+#include "smp.h"
+#include "initcall.h"
 
 // Performance checkpoint types
 typedef enum {
@@ -46,8 +48,27 @@ typedef struct {
     uint32_t kernel_size_bytes;
     uint32_t network_transfer_bytes;
     float kernel_load_speed_mbps;
+    uint32_t core_tasks[SMP_MAX_CORES];           // Scheduler tasks run per core
+    uint32_t core_utilisation_pct[SMP_MAX_CORES]; // Busy time / scheduler window
 } perf_stats_t;
 
+// Live counter sampled by the summary. Defined next to the data it reads,
+// so a module that is not linked in has no probe in the report
+typedef struct {
+    const char *name;
+    const char *unit;
+    uint64_t (*sample)(void);
+} perf_probe_t;
+
+#define PERFMON_PROBE(var, probe_name, probe_unit, sample_fn) \
+    static const perf_probe_t var = { .name = (probe_name), .unit = (probe_unit), \
+                                      .sample = (sample_fn) }; \
+    static const perf_probe_t *const __perf_probe_entry_##var \
+        LINKER_TABLE_ENTRY(".table.perf_probes") = &var
+
+uint32_t perfmon_probe_count(void);
+const perf_probe_t *perfmon_get_probe(uint32_t index);
+
 // Initialize performance monitoring
 void perfmon_init(void);
 
@@ -63,6 +84,9 @@ const perf_record_t *perfmon_get_checkpoint(int index);
 // Calculate statistics
 void perfmon_calc_stats(perf_stats_t *stats);
 
+// Per-core scheduler utilisation (0-100) since sched_init()
+uint32_t perfmon_get_core_utilisation(uint32_t core);
+
 // Print performance report
 void perfmon_print_report(void);
 
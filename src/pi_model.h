@@ -38,4 +38,7 @@ typedef enum {
     PI_MODEL_MAX      // Keep last for bounds checking
 } pi_model_t;
 
+// Decode the firmware board revision (mailbox) into a model
+pi_model_t pi_get_model(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+/* Target Platform */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include "hardware.h"
+
+/*
+ * The machine the image is built for, chosen with PLATFORM= in the
+ * Makefile. rpi (the default) is a Raspberry Pi, its SoC chosen with
+ * SOC= (below). virt (-DPLATFORM_VIRT) is QEMU's virt board: no VideoCore, so no
+ * mailbox, GPIO, EMMC or PM watchdog; a GICv2; RAM from 1GB with every
+ * device below it; secondaries started through PSCI; and virtio-mmio
+ * slots for the disk (virtio_blk.c) and network (virtio_net.c).
+ */
+
+#ifdef PLATFORM_VIRT
+
+#define PLATFORM_NAME           "QEMU virt"
+#define PLATFORM_DISK_NAME      "virtio-blk disk"
+
+#define PLATFORM_DEVICE_BASE    0x00000000  // Flash, GIC, UART, virtio-mmio
+#define PLATFORM_DEVICE_END     0x40000000  // RAM from here
+#define PLATFORM_UART_BASE      0x09000000  // PL011
+#define PLATFORM_GICD_BASE      0x08000000
+#define PLATFORM_GICC_BASE      0x08010000
+
+#define PLATFORM_VIRTIO_BASE    0x0A000000  // First virtio-mmio slot
+#define PLATFORM_VIRTIO_STRIDE  0x200
+#define PLATFORM_VIRTIO_SLOTS   32
+
+// No BCM blocks: their users check PLATFORM_HAS_VIDEOCORE first
+#define PLATFORM_GPIO_BASE      0
+#define PLATFORM_TIMER_BASE     0
+#define PLATFORM_EMMC_BASE      0
+#define PLATFORM_ARM_TIMER_BASE 0
+#define PLATFORM_PM_BASE        0
+#define PLATFORM_MAILBOX_BASE   0
+
+#define PLATFORM_HAS_VIDEOCORE  0   // Mailbox, GPIO, EMMC, PM registers
+#define PLATFORM_HAS_BCM_IRQ    0   // BCM2836 local + BCM2835 legacy controller
+#define PLATFORM_HAS_SPIN_TABLE 0   // PSCI instead
+
+#else
+
+/*
+ * Raspberry Pi. SOC= in the Makefile fixes the peripheral layout at build
+ * time, so every register address below is a constant and an access is
+ * one immediate-addressed load or store. SOC=generic (-DSOC_GENERIC) runs
+ * on any of them instead: platform_init() picks the layout once, from the
+ * CPU type, into soc_bases, and an access costs one extra load from it.
+ */
+
+typedef struct {
+    uint32_t device;                // Start of the peripheral window
+    uint32_t uart;
+    uint32_t gpio;
+    uint32_t timer;
+    uint32_t emmc;
+    uint32_t arm_timer;
+    uint32_t pm;
+    uint32_t mailbox;
+    uint32_t bcm_irq;               // 1 for the BCM2836/2835 controllers, 0 for the GIC-400
+} soc_bases_t;
+
+extern soc_bases_t soc_bases;       // SOC=generic only; BCM2837 until platform_init()
+
+#define PLATFORM_DISK_NAME      "SD card"
+#define PLATFORM_DEVICE_END     0x100000000ULL  // Peripherals and ARM local registers
+#define PLATFORM_GICD_BASE      (GIC400_BASE_BCM2711 + 0x1000)
+#define PLATFORM_GICC_BASE      (GIC400_BASE_BCM2711 + 0x2000)
+
+#define PLATFORM_HAS_VIDEOCORE  1
+#define PLATFORM_HAS_SPIN_TABLE 1
+
+#if defined(SOC_GENERIC)
+
+#define PLATFORM_NAME           "Raspberry Pi (generic)"
+#define PLATFORM_DEVICE_BASE    soc_bases.device
+#define PLATFORM_UART_BASE      soc_bases.uart
+#define PLATFORM_GPIO_BASE      soc_bases.gpio
+#define PLATFORM_TIMER_BASE     soc_bases.timer
+#define PLATFORM_EMMC_BASE      soc_bases.emmc
+#define PLATFORM_ARM_TIMER_BASE soc_bases.arm_timer
+#define PLATFORM_PM_BASE        soc_bases.pm
+#define PLATFORM_MAILBOX_BASE   soc_bases.mailbox
+#define PLATFORM_HAS_BCM_IRQ    soc_bases.bcm_irq
+
+#elif defined(SOC_BCM2711)
+
+#define PLATFORM_NAME           "Raspberry Pi 4 / 400 (BCM2711)"
+#define PLATFORM_DEVICE_BASE    PERIPHERAL_BASE_BCM2711
+#define PLATFORM_UART_BASE      UART_BASE_BCM2711
+#define PLATFORM_GPIO_BASE      GPIO_BASE_BCM2711
+#define PLATFORM_TIMER_BASE     TIMER_BASE_BCM2711
+#define PLATFORM_EMMC_BASE      EMMC_BASE_BCM2711
+#define PLATFORM_ARM_TIMER_BASE ARM_TIMER_BASE_BCM2711
+#define PLATFORM_PM_BASE        PM_BASE_BCM2711
+#define PLATFORM_MAILBOX_BASE   MAILBOX_BASE_BCM2711
+#define PLATFORM_HAS_BCM_IRQ    0
+
+#else   // SOC_BCM2837, the default: Pi 2 v1.2, 3, Zero 2 W and QEMU raspi3b
+
+#define PLATFORM_NAME           "QEMU raspi3b / Real Hardware"
+#define PLATFORM_DEVICE_BASE    PERIPHERAL_BASE_BCM2837
+#define PLATFORM_UART_BASE      UART_BASE_BCM2837
+#define PLATFORM_GPIO_BASE      GPIO_BASE_BCM2837
+#define PLATFORM_TIMER_BASE     TIMER_BASE_BCM2837
+#define PLATFORM_EMMC_BASE      EMMC_BASE_BCM2837
+#define PLATFORM_ARM_TIMER_BASE ARM_TIMER_BASE_BCM2837
+#define PLATFORM_PM_BASE        PM_BASE_BCM2837
+#define PLATFORM_MAILBOX_BASE   MAILBOX_BASE_BCM2837
+#define PLATFORM_HAS_BCM_IRQ    1
+
+#endif
+
+#endif
+
+// Resolve soc_bases (SOC=generic; nothing to do otherwise). Called from
+// start.S before any C code touches a peripheral, so the table is in the
+// image when it relocates
+void platform_init(void);
+
+#endif
@@ -1,6 +1,7 @@
 /* PWM Controller Implementation for Raspberry Pi */
 
 #include "pwm.h"
+#include "driver.h"
 
 // Helper functions
 static void mmio_write(uint32_t reg, uint32_t data) {
@@ -19,6 +20,13 @@ void pwm_init(void) {
     mmio_write(PWM_BASE + PWM_STA, PWM_STA_BERR | PWM_STA_GAPO1 | PWM_STA_GAPO2 | PWM_STA_RERR1 | PWM_STA_WERR1);
 }
 
+static int pwm_driver_init(void) {
+    pwm_init();
+    return 0;
+}
+
+DRIVER_DEFINE(pwm_driver, "pwm", pwm_driver_init, BOOT_PATH_DIAG);
+
 void pwm_set_mode(uint8_t channel, uint8_t mode) {
     uint32_t ctl = mmio_read(PWM_BASE + PWM_CTL);
 
@@ -4,6 +4,7 @@
 #define PWM_H
 
 #include <stdint.h>
+#include "driver.h"
 
 // PWM Controller registers (Pi 4)
 #define PWM_BASE 0xFE20C000
@@ -65,4 +66,7 @@ void pwm_enable(uint8_t channel);
 void pwm_disable(uint8_t channel);
 void pwm_set_polarity(uint8_t channel, uint8_t polarity);
 
+// Lazy driver descriptor (see driver.h)
+extern driver_t pwm_driver;
+
 #endif
\ No newline at end of file
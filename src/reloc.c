@@ -0,0 +1,45 @@
+/* Bootloader Self-Relocation */
+
+#include <stdint.h>
+#include "reloc.h"
+#include "memmap.h"
+#include "fdt.h"
+
+extern char _start[], __heap_end[];     // linker.ld: image through heap
+
+static uint64_t align_down(uint64_t value, uint64_t align) {
+    return value & ~(align - 1);
+}
+
+// Highest window below 'top' that keeps the image's offset in its 2MB
+// block, so every section alignment survives the move
+static uint64_t window_below(uint64_t top, uint64_t span) {
+    uint64_t offset = (uintptr_t)_start & (RELOC_ALIGN - 1);
+
+    if (top < span + offset) return 0;
+    return align_down(top - span - offset, RELOC_ALIGN) + offset;
+}
+
+uint64_t reloc_target(void) {
+    uint64_t load = (uintptr_t)_start;
+    uint64_t span = (uintptr_t)__heap_end - load;
+    uint64_t base, size;
+
+    if (memmap_probe_ram(&base, &size) != 0) return 0;
+
+    uint64_t target = window_below(base + size, span);
+
+    // The firmware often puts its DTB near the top; it has to survive
+    // until the kernel's copy is made (kernel_boot.c)
+    const void *fdt = (const void *)(uintptr_t)firmware_dtb;
+    if (target && fdt && fdt_check_header(fdt) == 0) {
+        uint64_t dtb_end = firmware_dtb + fdt_get_totalsize(fdt);
+        if (firmware_dtb < target + span && dtb_end > target) {
+            target = window_below(firmware_dtb, span);
+        }
+    }
+
+    // Only upwards and clear of the running image; otherwise stay put
+    if (target < load + span) return 0;
+    return target;
+}
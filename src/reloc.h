@@ -0,0 +1,32 @@
+/* Bootloader Self-Relocation */
+
+#ifndef RELOC_H
+#define RELOC_H
+
+#include <stdint.h>
+
+/*
+ * The image is linked where it is loaded (LOAD_ADDR in the Makefile:
+ * 0x80000 on a Pi, RAM + 0x80000 on QEMU virt), where kernels
+ * traditionally want to be. start.S moves it (BSS, stack and heap
+ * included) to the top of ARM RAM before main() and applies the
+ * R_AARCH64_RELATIVE fixups the -pie link leaves, so the low memory is
+ * free for the kernel. The destination depends only on the RAM size and
+ * the firmware DTB, so it is the same on every boot and .noinit state
+ * (warm_boot.c) is found again after a warm reset.
+ */
+#define RELOC_ALIGN     0x00200000  // Moves by whole MMU blocks
+
+// Distance the image moved from its link address, 0 if it did not (start.S)
+extern uint64_t reloc_offset;
+
+// Where start.S should copy the image, 0 to run where it was loaded.
+// Called once on the boot core, before the move, with BSS cleared
+uint64_t reloc_target(void);
+
+// The copy of 'ptr' in the image as loaded, for cores parked there
+static inline uintptr_t reloc_load_address(const volatile void *ptr) {
+    return (uintptr_t)ptr - reloc_offset;
+}
+
+#endif
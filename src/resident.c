@@ -0,0 +1,226 @@
+/* Resident Images Across Warm Resets */
+
+#include <stdint.h>
+#include "resident.h"
+#include "boot_source.h"
+#include "warm_boot.h"
+#include "memmap.h"
+#include "crypto.h"
+#include "cache.h"
+#include "fdt.h"
+#include "driver.h"
+#include "initcall.h"
+#include "config_persist.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+#define RESIDENT_FILE_ALIGN     64
+
+static resident_manifest_t *store;      // NULL when there is none
+
+static uint64_t align_up(uint64_t value, uint64_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+// Images are large: whole words when both ends allow it
+static void copy_bytes(void *dest, const void *src, uint32_t n) {
+    uint8_t *d = dest;
+    const uint8_t *s = src;
+
+    if ((((uintptr_t)d | (uintptr_t)s) & 7) == 0) {
+        for (; n >= 8; n -= 8, d += 8, s += 8) {
+            *(uint64_t *)d = *(const uint64_t *)s;
+        }
+    }
+    while (n--) *d++ = *s++;
+}
+
+static int names_equal(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static void manifest_hash(const resident_manifest_t *manifest, uint8_t *digest) {
+    sha256_hash((const uint8_t *)manifest, (uint32_t)((uintptr_t)manifest->hash - (uintptr_t)manifest),
+                digest);
+}
+
+static int manifest_check(const resident_manifest_t *manifest, uint64_t size) {
+    uint8_t digest[32];
+
+    if (manifest->magic != RESIDENT_MAGIC || manifest->size != size) return -1;
+    if (manifest->count == 0 || manifest->count > RESIDENT_MAX_FILES) return -1;
+
+    for (uint32_t i = 0; i < manifest->count; i++) {
+        const resident_file_t *file = &manifest->files[i];
+        if (file->offset < sizeof(*manifest) || file->offset > size ||
+            file->size > size - file->offset) {
+            return -1;
+        }
+    }
+
+    manifest_hash(manifest, digest);
+    if (crypto_constant_time_compare(digest, manifest->hash, sizeof(digest)) != 0) return -1;
+
+    // Every image up front, so a boot never finds out halfway through
+    for (uint32_t i = 0; i < manifest->count; i++) {
+        const resident_file_t *file = &manifest->files[i];
+
+        sha256_hash((const uint8_t *)manifest + file->offset, file->size, digest);
+        if (crypto_constant_time_compare(digest, file->hash, sizeof(digest)) != 0) return -1;
+    }
+    return 0;
+}
+
+static const resident_file_t *find_file(const char *filename) {
+    if (!store) return NULL;
+
+    for (uint32_t i = 0; i < store->count; i++) {
+        if (names_equal(store->files[i].name, filename)) return &store->files[i];
+    }
+    return NULL;
+}
+
+static int resident_probe(void) {
+    return store ? 0 : -1;
+}
+
+// Checked when the store was claimed (resident_init)
+static int resident_load(const char *filename, uint32_t load_addr, uint32_t *size) {
+    const resident_file_t *file = find_file(filename);
+
+    if (!file) return -1;
+
+    copy_bytes((void *)(uintptr_t)load_addr, (const uint8_t *)store + file->offset, file->size);
+    *size = file->size;
+    return 0;
+}
+
+static int resident_peek(const char *filename, void *buf, uint32_t len, uint32_t *size) {
+    const resident_file_t *file = find_file(filename);
+
+    if (!file) return -1;
+
+    copy_bytes(buf, (const uint8_t *)store + file->offset, len < file->size ? len : file->size);
+    *size = file->size;
+    return 0;
+}
+
+static int resident_read(const char *filename, uint32_t offset, void *buf, uint32_t len) {
+    const resident_file_t *file = find_file(filename);
+
+    if (!file || offset > file->size || len > file->size - offset) return -1;
+
+    copy_bytes(buf, (const uint8_t *)store + file->offset + offset, len);
+    return 0;
+}
+
+BOOT_SOURCE(resident_source, "resident", BOOT_PATH_ALL, BOOT_SOURCE_PRIORITY_FIRST,
+            resident_probe, resident_load, resident_peek, resident_read);
+
+int resident_init(void) {
+    uint64_t base, size;
+
+    store = NULL;
+    kernel_boot_set_load_hook(resident_capture);
+
+    if (warm_boot_get_resident(&base, &size) != 0) return 0;
+
+    resident_manifest_t *manifest = (resident_manifest_t *)(uintptr_t)base;
+    if (size < sizeof(*manifest) || manifest_check(manifest, size) != 0 ||
+        memmap_reserve(base, size, MEMMAP_RESIDENT, MEMMAP_KEEP, "resident") != 0) {
+        warm_boot_set_resident(0, 0);
+        return 0;
+    }
+
+    store = manifest;
+    return 0;
+}
+device_initcall(resident_init);
+
+int resident_valid(void) {
+    return store != NULL;
+}
+
+void resident_drop(void) {
+    if (!store) return;
+
+    // Stale for good: the next warm reset must not find it either
+    store->magic = 0;
+    dcache_clean_range((uintptr_t)store, sizeof(*store));
+    memmap_release((uintptr_t)store);
+    warm_boot_set_resident(0, 0);
+    store = NULL;
+}
+
+static void add_file(resident_manifest_t *manifest, const char *name, uint64_t addr,
+                     uint32_t size, uint32_t *offset) {
+    resident_file_t *file = &manifest->files[manifest->count++];
+    uint8_t *dest = (uint8_t *)manifest + *offset;
+    uint32_t i = 0;
+
+    for (; name[i] && i < RESIDENT_NAME_MAX - 1; i++) file->name[i] = name[i];
+    for (; i < RESIDENT_NAME_MAX; i++) file->name[i] = '\0';
+
+    copy_bytes(dest, (const void *)(uintptr_t)addr, size);
+    sha256_hash(dest, size, file->hash);
+    file->offset = *offset;
+    file->size = size;
+    *offset = align_up(*offset + size, RESIDENT_FILE_ALIGN);
+}
+
+void resident_capture(const char *image, const char *dtb, const char *initrd,
+                      const kernel_layout_t *layout) {
+    // Turned off: the memory goes to the kernel, along with any store an
+    // earlier boot left
+    if (!config_persist_get()->keep_resident) {
+        resident_drop();
+        return;
+    }
+
+    // Booted from the store: it already holds exactly this
+    if (layout->source == &resident_source) return;
+
+    resident_drop();
+
+    // Only a flat Image can be handed back as the file it was; an ELF's
+    // segments are scattered and no longer match the stored bytes
+    if (layout->format != KERNEL_FORMAT_IMAGE) return;
+
+    // The DTB as it stands, so a firmware-provided tree is kept as well
+    uint32_t dtb_size = dtb ? fdt_get_totalsize((const void *)(uintptr_t)layout->dtb_addr) : 0;
+    uint32_t initrd_size = initrd ? layout->initrd_size : 0;
+
+    uint64_t size = align_up(sizeof(resident_manifest_t), RESIDENT_FILE_ALIGN) +
+                    align_up(layout->kernel_size, RESIDENT_FILE_ALIGN) +
+                    align_up(dtb_size, RESIDENT_FILE_ALIGN) + initrd_size;
+    uint64_t base;
+
+    if (memmap_alloc(size, RESIDENT_ALIGN, MEMMAP_RESIDENT, MEMMAP_KEEP, "resident", &base) != 0) {
+        return;     // No room: this boot simply leaves nothing behind
+    }
+
+    resident_manifest_t *manifest = (resident_manifest_t *)(uintptr_t)base;
+    uint32_t offset = align_up(sizeof(*manifest), RESIDENT_FILE_ALIGN);
+
+    // Unused entries are hashed too
+    uint8_t *bytes = (uint8_t *)manifest;
+    for (uint32_t i = 0; i < sizeof(*manifest); i++) bytes[i] = 0;
+    add_file(manifest, image, layout->kernel_addr, layout->kernel_size, &offset);
+    if (dtb_size) add_file(manifest, dtb, layout->dtb_addr, dtb_size, &offset);
+    if (initrd_size) add_file(manifest, initrd, layout->initrd_addr, initrd_size, &offset);
+
+    manifest->magic = RESIDENT_MAGIC;
+    manifest->size = size;
+    manifest_hash(manifest, manifest->hash);
+
+    // A watchdog reset discards the D-cache
+    dcache_clean_range(base, size);
+    warm_boot_set_resident(base, size);
+    store = manifest;
+}
@@ -0,0 +1,65 @@
+/* Resident Images Across Warm Resets */
+
+#ifndef RESIDENT_H
+#define RESIDENT_H
+
+#include <stdint.h>
+#include "kernel_boot.h"
+
+/*
+ * Rebooting into the same kernel should not mean fetching it again: DRAM
+ * keeps its contents over a warm reset (warm_boot.h). Each load copies the
+ * kernel, DTB and initrd into a store the DTB reserves, headed by a
+ * manifest of names, offsets and SHA-256 digests, itself hashed. After a
+ * warm reset the store is claimed back before anything else is placed and
+ * serves those files ahead of every other boot source. That costs a RAM
+ * copy and a hash check instead of an SD read or a TFTP transfer. A
+ * damaged manifest or image drops the store, and the other sources are
+ * tried as usual.
+ *
+ * The store withholds a second copy of everything it holds from the
+ * kernel. keep_resident in the persisted config (config_persist.h) turns
+ * it off; the next load then drops the store instead of replacing it.
+ *
+ * The hashes catch memory that did not survive, not a tampered store:
+ * anything able to write it could rewrite the manifest as well.
+ */
+
+#define RESIDENT_MAGIC          0x44534552  // "RESD"
+#define RESIDENT_MAX_FILES      3           // Kernel, DTB, initrd
+#define RESIDENT_NAME_MAX       32
+#define RESIDENT_ALIGN          0x00200000  // Above the firmware's load window
+
+typedef struct {
+    char     name[RESIDENT_NAME_MAX];
+    uint32_t offset;                // From the start of the store
+    uint32_t size;
+    uint8_t  hash[32];              // SHA-256 of the contents
+} resident_file_t;
+
+// At the start of the store
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t size;                  // Whole store, manifest included
+    resident_file_t files[RESIDENT_MAX_FILES];
+    uint8_t  hash[32];              // SHA-256 of everything above
+} resident_manifest_t;
+
+// Claim the store the previous boot left, if the manifest and every image
+// hash check out, and have kernel_boot_load() keep what it loads. Registered as a device
+// initcall: after warm_boot_init(), before anything is placed
+int resident_init(void);
+
+// 1 while there is a valid store to boot from
+int resident_valid(void);
+
+// kernel_load_hook_t: replace the store with what was just loaded (nothing
+// to do when that came from the store)
+void resident_capture(const char *image, const char *dtb, const char *initrd,
+                      const kernel_layout_t *layout);
+
+// Forget the store and give its memory back
+void resident_drop(void);
+
+#endif
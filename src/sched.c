@@ -0,0 +1,289 @@
+/* Work-Stealing Task Scheduler for Boot-Time Jobs */
+
+#include <stdint.h>
+#include "sched.h"
+#include "smp.h"
+#include "cache.h"
+#include "timer.h"
+#include "atomic.h"
+#include "sync.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+// Per-core ready deque: the owner pushes and pops at the bottom (LIFO keeps
+// freshly released dependents cache-warm), thieves take from the top
+typedef struct {
+    sched_task_t *slots[SCHED_DEQUE_SIZE];
+    uint32_t top;       // Oldest task (steal end)
+    uint32_t bottom;    // Next free slot (owner end)
+    spinlock_t lock;
+} __attribute__((aligned(CACHE_LINE_MAX))) sched_deque_t;
+
+static sched_deque_t deques[SMP_MAX_CORES];
+static sched_core_stats_t core_stats[SMP_MAX_CORES] __attribute__((aligned(CACHE_LINE_MAX)));
+static smp_work_t worker_work[SMP_MAX_CORES];
+static volatile uint32_t workers_running;
+static uint64_t window_start_us;
+
+static inline void send_event(void) {
+    __asm__ volatile("dsb ish\n\tsev" : : : "memory");
+}
+
+static inline void wait_event(void) {
+    __asm__ volatile("wfe" : : : "memory");
+}
+
+static int deque_push(sched_deque_t *d, sched_task_t *task) {
+    int ok = 0;
+
+    spin_lock(&d->lock);
+    if (d->bottom - d->top < SCHED_DEQUE_SIZE) {
+        d->slots[d->bottom % SCHED_DEQUE_SIZE] = task;
+        d->bottom++;
+        ok = 1;
+    }
+    spin_unlock(&d->lock);
+
+    return ok;
+}
+
+static sched_task_t *deque_pop(sched_deque_t *d) {
+    sched_task_t *task = NULL;
+
+    spin_lock(&d->lock);
+    if (d->bottom != d->top) {
+        d->bottom--;
+        task = d->slots[d->bottom % SCHED_DEQUE_SIZE];
+    }
+    spin_unlock(&d->lock);
+
+    return task;
+}
+
+static sched_task_t *deque_steal(sched_deque_t *d) {
+    sched_task_t *task = NULL;
+
+    // Cheap unlocked peek so idle thieves don't hammer busy locks
+    if (atomic_load_32(&d->bottom, ATOMIC_RELAXED) ==
+        atomic_load_32(&d->top, ATOMIC_RELAXED)) {
+        return NULL;
+    }
+
+    spin_lock(&d->lock);
+    if (d->bottom != d->top) {
+        task = d->slots[d->top % SCHED_DEQUE_SIZE];
+        d->top++;
+    }
+    spin_unlock(&d->lock);
+
+    return task;
+}
+
+static void run_task(uint32_t core, sched_task_t *task);
+
+// Make a task runnable on the calling core
+static void enqueue(sched_task_t *task) {
+    uint32_t core = smp_core_id();
+
+    atomic_store_32(&task->state, SCHED_TASK_READY, ATOMIC_RELEASE);
+
+    if (!deque_push(&deques[core], task)) {
+        // Deque full: run it here rather than drop it
+        run_task(core, task);
+        return;
+    }
+    send_event();
+}
+
+static void run_task(uint32_t core, sched_task_t *task) {
+    atomic_store_32(&task->state, SCHED_TASK_RUNNING, ATOMIC_RELAXED);
+    task->core = core;
+    task->start_us = timer_get_ticks();
+
+    task->result = task->fn(task->arg);
+
+    task->end_us = timer_get_ticks();
+    core_stats[core].busy_us += task->end_us - task->start_us;
+    core_stats[core].tasks_run++;
+
+    // Publish completion and snapshot dependents under the lock, so a
+    // concurrent sched_task_depends_on() either sees DONE or gets released
+    sched_task_t *released[SCHED_MAX_DEPENDENTS];
+    uint32_t count;
+
+    spin_lock(&task->lock);
+    count = task->dependent_count;
+    for (uint32_t i = 0; i < count; i++) {
+        released[i] = task->dependents[i];
+    }
+    atomic_store_32(&task->state, SCHED_TASK_DONE, ATOMIC_RELEASE);
+    spin_unlock(&task->lock);
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (atomic_fetch_sub_32(&released[i]->pending, 1, ATOMIC_ACQ_REL) == 1) {
+            enqueue(released[i]);
+        }
+    }
+
+    send_event();
+}
+
+// Own deque first, then steal round-robin starting after ourselves
+static sched_task_t *find_task(uint32_t core) {
+    sched_task_t *task = deque_pop(&deques[core]);
+    if (task) return task;
+
+    for (uint32_t i = 1; i < SMP_MAX_CORES; i++) {
+        uint32_t victim = (core + i) % SMP_MAX_CORES;
+        task = deque_steal(&deques[victim]);
+        if (task) {
+            core_stats[core].tasks_stolen++;
+            return task;
+        }
+    }
+
+    return NULL;
+}
+
+static void worker_loop(void *arg) {
+    uint32_t core = (uint32_t)(uintptr_t)arg;
+
+    while (atomic_load_32(&workers_running, ATOMIC_ACQUIRE)) {
+        sched_task_t *task = find_task(core);
+        if (task) {
+            run_task(core, task);
+        } else {
+            wait_event();
+        }
+    }
+}
+
+void sched_init(void) {
+    for (uint32_t i = 0; i < SMP_MAX_CORES; i++) {
+        deques[i].top = 0;
+        deques[i].bottom = 0;
+        spin_lock_init(&deques[i].lock);
+        core_stats[i].busy_us = 0;
+        core_stats[i].tasks_run = 0;
+        core_stats[i].tasks_stolen = 0;
+    }
+
+    window_start_us = timer_get_ticks();
+    atomic_store_32(&workers_running, 1, ATOMIC_RELEASE);
+
+    // The boot core works while joining; every other online core gets a
+    // long-running worker item on its SMP queue
+    uint32_t self = smp_core_id();
+    for (uint32_t core = 0; core < SMP_MAX_CORES; core++) {
+        if (core == self || !smp_core_is_online(core)) continue;
+        smp_submit(core, &worker_work[core], worker_loop, (void *)(uintptr_t)core);
+    }
+}
+
+void sched_shutdown(void) {
+    atomic_store_32(&workers_running, 0, ATOMIC_RELEASE);
+    send_event();
+
+    uint32_t self = smp_core_id();
+    for (uint32_t core = 0; core < SMP_MAX_CORES; core++) {
+        if (core == self || !smp_core_is_online(core)) continue;
+        smp_wait(&worker_work[core]);
+    }
+}
+
+void sched_task_init(sched_task_t *task, sched_fn_t fn, void *arg) {
+    if (!task) return;
+
+    task->fn = fn;
+    task->arg = arg;
+    task->result = 0;
+    task->state = SCHED_TASK_IDLE;
+    task->pending = 1;          // Held until sched_submit()
+    task->dependent_count = 0;
+    spin_lock_init(&task->lock);
+    task->core = 0;
+    task->start_us = 0;
+    task->end_us = 0;
+}
+
+int sched_task_depends_on(sched_task_t *task, sched_task_t *dependency) {
+    if (!task || !dependency || task == dependency) return -1;
+    if (task->state != SCHED_TASK_IDLE) return -1;     // Already submitted
+
+    int result = 0;
+
+    spin_lock(&dependency->lock);
+    if (dependency->state == SCHED_TASK_DONE) {
+        // Nothing to wait for
+    } else if (dependency->dependent_count >= SCHED_MAX_DEPENDENTS) {
+        result = -1;
+    } else {
+        atomic_fetch_add_32(&task->pending, 1, ATOMIC_RELAXED);
+        dependency->dependents[dependency->dependent_count++] = task;
+    }
+    spin_unlock(&dependency->lock);
+
+    return result;
+}
+
+int sched_submit(sched_task_t *task) {
+    if (!task || !task->fn) return -1;
+    if (task->state != SCHED_TASK_IDLE) return -1;
+
+    atomic_store_32(&task->state, SCHED_TASK_WAITING, ATOMIC_RELEASE);
+
+    // Drop the submit reference; the last dependency to finish enqueues otherwise
+    if (atomic_fetch_sub_32(&task->pending, 1, ATOMIC_ACQ_REL) == 1) {
+        enqueue(task);
+    }
+
+    return 0;
+}
+
+int sched_spawn(sched_task_t *task, sched_fn_t fn, void *arg) {
+    sched_task_init(task, fn, arg);
+    return sched_submit(task);
+}
+
+int sched_task_done(const sched_task_t *task) {
+    return atomic_load_32(&task->state, ATOMIC_ACQUIRE) == SCHED_TASK_DONE;
+}
+
+int sched_join(sched_task_t *task) {
+    if (!task) return -1;
+
+    uint32_t core = smp_core_id();
+
+    // Help out instead of idling; this also makes progress when no
+    // secondary cores are online
+    while (!sched_task_done(task)) {
+        sched_task_t *other = find_task(core);
+        if (other) {
+            run_task(core, other);
+        } else {
+            wait_event();
+        }
+    }
+
+    return task->result;
+}
+
+int sched_run_one(void) {
+    uint32_t core = smp_core_id();
+    sched_task_t *task = find_task(core);
+
+    if (!task) return 0;
+    run_task(core, task);
+    return 1;
+}
+
+const sched_core_stats_t *sched_get_core_stats(uint32_t core) {
+    if (core >= SMP_MAX_CORES) return NULL;
+    return &core_stats[core];
+}
+
+uint64_t sched_get_window_us(void) {
+    return timer_get_ticks() - window_start_us;
+}
@@ -0,0 +1,76 @@
+/* Work-Stealing Task Scheduler for Boot-Time Jobs */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include "smp.h"
+#include "sync.h"
+
+#define SCHED_DEQUE_SIZE        32      // Ready tasks per core
+#define SCHED_MAX_DEPENDENTS    8       // Tasks that may wait on one task
+
+// Task states
+#define SCHED_TASK_IDLE         0       // Initialised, dependencies may be added
+#define SCHED_TASK_WAITING      1       // Submitted, waiting for dependencies
+#define SCHED_TASK_READY        2       // In a deque
+#define SCHED_TASK_RUNNING      3
+#define SCHED_TASK_DONE         4
+
+typedef int (*sched_fn_t)(void *arg);
+
+// Task - doubles as its own join handle; owned by the caller
+typedef struct sched_task {
+    sched_fn_t fn;
+    void *arg;
+    int result;                     // Return value of fn
+    volatile uint32_t state;
+    volatile uint32_t pending;      // Unfinished dependencies (+1 until submitted)
+    struct sched_task *dependents[SCHED_MAX_DEPENDENTS];
+    uint32_t dependent_count;
+    spinlock_t lock;                // Guards state/dependents at completion
+    uint32_t core;                  // Core that ran the task
+    uint64_t start_us;
+    uint64_t end_us;
+} sched_task_t;
+
+// Per-core accounting (for perfmon)
+typedef struct {
+    uint64_t busy_us;               // Time spent running tasks
+    uint32_t tasks_run;
+    uint32_t tasks_stolen;
+} sched_core_stats_t;
+
+// Start worker loops on every online secondary core
+void sched_init(void);
+
+// Stop the workers (they return to the SMP work loop)
+void sched_shutdown(void);
+
+// Prepare a task; dependencies may be added until it is submitted
+void sched_task_init(sched_task_t *task, sched_fn_t fn, void *arg);
+
+// 'task' will not start before 'dependency' has finished
+int sched_task_depends_on(sched_task_t *task, sched_task_t *dependency);
+
+// Hand a task to the scheduler; it runs once all dependencies are done
+int sched_submit(sched_task_t *task);
+
+// Convenience: init + submit with no dependencies
+int sched_spawn(sched_task_t *task, sched_fn_t fn, void *arg);
+
+// Wait for a task (running other ready tasks meanwhile); returns its result
+int sched_join(sched_task_t *task);
+
+// Non-blocking completion check
+int sched_task_done(const sched_task_t *task);
+
+// Run at most one ready task on the calling core; returns 1 if one ran.
+// Lets other wait loops (the async executor) help instead of idling
+int sched_run_one(void);
+
+// Utilisation accounting
+const sched_core_stats_t *sched_get_core_stats(uint32_t core);
+uint64_t sched_get_window_us(void);     // Time since sched_init()
+
+#endif
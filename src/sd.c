@@ -1,263 +1,146 @@
-/* Complete SD Card and FAT Implementation */
+/* FAT Filesystem and Boot Disk Source */
 
 #include <stdint.h>
 #include "sd.h"
-#include "uart.h"
-#include "timer.h"
 #include "memory.h"
+#include "driver.h"
+#include "boot_source.h"
+#include "perfmon.h"
 
-// BCM2837 EMMC (SD Card) registers
-#define EMMC_BASE 0x3F300000
-
-#define EMMC_ARG2           ((volatile uint32_t*)(EMMC_BASE + 0x00))
-#define EMMC_BLKSIZECNT     ((volatile uint32_t*)(EMMC_BASE + 0x04))
-#define EMMC_ARG1           ((volatile uint32_t*)(EMMC_BASE + 0x08))
-#define EMMC_CMDTM          ((volatile uint32_t*)(EMMC_BASE + 0x0C))
-#define EMMC_RESP0          ((volatile uint32_t*)(EMMC_BASE + 0x10))
-#define EMMC_RESP1          ((volatile uint32_t*)(EMMC_BASE + 0x14))
-#define EMMC_RESP2          ((volatile uint32_t*)(EMMC_BASE + 0x18))
-#define EMMC_RESP3          ((volatile uint32_t*)(EMMC_BASE + 0x1C))
-#define EMMC_DATA           ((volatile uint32_t*)(EMMC_BASE + 0x20))
-#define EMMC_STATUS         ((volatile uint32_t*)(EMMC_BASE + 0x24))
-#define EMMC_CONTROL0       ((volatile uint32_t*)(EMMC_BASE + 0x28))
-#define EMMC_CONTROL1       ((volatile uint32_t*)(EMMC_BASE + 0x2C))
-#define EMMC_INTERRUPT      ((volatile uint32_t*)(EMMC_BASE + 0x30))
-#define EMMC_IRPT_MASK      ((volatile uint32_t*)(EMMC_BASE + 0x34))
-#define EMMC_IRPT_EN        ((volatile uint32_t*)(EMMC_BASE + 0x38))
-#define EMMC_CONTROL2       ((volatile uint32_t*)(EMMC_BASE + 0x3C))
-#define EMMC_SLOTISR_VER    ((volatile uint32_t*)(EMMC_BASE + 0xFC))
-
-// Command flags
-#define CMD_NEED_APP        0x80000000
-#define CMD_RSPNS_48        0x00020000
-#define CMD_ERRORS_MASK     0xFFF9C004
-#define CMD_RCA_MASK        0xFFFF0000
-
-// Status register flags
-#define SR_READ_AVAILABLE   0x00000800
-#define SR_DAT_INHIBIT      0x00000002
-#define SR_CMD_INHIBIT      0x00000001
-#define SR_APP_CMD          0x00000020
-
-// Interrupt flags
-#define INT_DATA_TIMEOUT    0x00100000
-#define INT_CMD_TIMEOUT     0x00010000
-#define INT_READ_RDY        0x00000020
-#define INT_CMD_DONE        0x00000001
-#define INT_ERROR_MASK      0x017E8000
-
-// SD Commands
-#define SD_CMD_GO_IDLE      0x00000000
-#define SD_CMD_ALL_SEND_CID 0x02000000
-#define SD_CMD_SEND_REL_ADDR 0x03020000
-#define SD_CMD_CARD_SELECT  0x07030000
-#define SD_CMD_SEND_IF_COND 0x08020000
-#define SD_CMD_STOP_TRANS   0x0C030000
-#define SD_CMD_READ_SINGLE  0x11220010
-#define SD_CMD_READ_MULTI   0x12220032
-#define SD_CMD_SET_BLOCKCNT 0x17020000
-#define SD_CMD_APP_CMD      0x37000000
-#define SD_CMD_SET_BUS_WIDTH 0x06020000
-#define SD_ACMD_SD_STATUS   0x0D220000
-#define SD_ACMD_SEND_OP_COND 0x29020000
-
-static uint8_t sd_initialized = 0;
-static uint32_t sd_rca = 0;
 static uint8_t sector_buffer[512] __attribute__((aligned(16)));
 
-// Wait for command/data to complete
-static int sd_wait_ready(void) {
-    uint32_t timeout = 1000;  // Reduced for QEMU compatibility
-    while (((*EMMC_STATUS) & (SR_CMD_INHIBIT | SR_DAT_INHIBIT)) && timeout--) {
-        // No delay - just check register
-    }
-    return timeout > 0 ? 0 : -1;
+// FAT filesystem state
+static fat_boot_sector_t *boot_sector = NULL;
+static uint32_t partition_lba = 0;
+static uint32_t volume_id = 0;
+static uint32_t fat_begin_sector = 0;
+static uint32_t cluster_begin_sector = 0;
+static uint32_t sectors_per_cluster = 0;
+static uint32_t root_dir_first_cluster = 0;
+
+// Discovery results from a previous boot (caller-owned, see fat_set_cache).
+// Until one is set, a private one still saves the second scan when a file
+// is peeked at and then loaded
+static fat_cache_t fat_boot_cache;
+static fat_cache_t *fat_cache = &fat_boot_cache;
+static uint32_t fat_cache_hits = 0;
+static uint32_t fat_cache_misses = 0;
+
+#define MBR_PARTITION_TABLE     0x1BE
+#define MBR_PARTITION_COUNT     4
+
+static void copy_bytes(void *dest, const void *src, uint32_t n) {
+    uint8_t *d = dest;
+    const uint8_t *s = src;
+    while (n--) *d++ = *s++;
 }
 
-// Send SD command
-static int sd_send_command(uint32_t command, uint32_t arg) {
-    // Wait for command line ready
-    if (sd_wait_ready() != 0) {
-        return -1;
-    }
+// Adopt the FAT volume whose boot sector is in 'sector' (read from 'lba')
+static int fat_mount(uint32_t lba, const uint8_t *sector) {
+    const fat_boot_sector_t *bs = (const fat_boot_sector_t*)sector;
 
-    // Clear interrupt flags
-    *EMMC_INTERRUPT = *EMMC_INTERRUPT;
-
-    // Send command
-    *EMMC_ARG1 = arg;
-    *EMMC_CMDTM = command;
-
-    // Wait for command complete
-    uint32_t timeout = 10000;  // Reduced for QEMU compatibility
-    uint32_t interrupt;
-    while (timeout--) {
-        interrupt = *EMMC_INTERRUPT;
-        if (interrupt & INT_CMD_DONE) break;
-        if (interrupt & INT_ERROR_MASK) return -1;
-        // No delay - just check register
+    if (sector[510] != 0x55 || sector[511] != 0xAA) return -1;
+    if (bs->bytes_per_sector != 512 || bs->sectors_per_cluster == 0 || bs->num_fats == 0) {
+        return -1;
     }
 
-    if (timeout == 0) return -1;
+    copy_bytes(boot_sector, sector, sizeof(fat_boot_sector_t));
 
-    // Clear interrupt
-    *EMMC_INTERRUPT = INT_CMD_DONE;
+    partition_lba = lba;
+    volume_id = boot_sector->volume_id;
+    fat_begin_sector = lba + boot_sector->reserved_sectors;
+    cluster_begin_sector = fat_begin_sector +
+        (boot_sector->num_fats * boot_sector->sectors_per_fat_32);
+    sectors_per_cluster = boot_sector->sectors_per_cluster;
+    root_dir_first_cluster = boot_sector->root_cluster;
 
     return 0;
 }
 
-// Send APP command (CMD55 + ACMD)
-static int sd_send_app_command(uint32_t command, uint32_t arg) {
-    if (sd_send_command(SD_CMD_APP_CMD, sd_rca) != 0) {
-        return -1;
-    }
-    return sd_send_command(command, arg);
-}
-
-int sd_init(void) {
-    // Reset controller
-    *EMMC_CONTROL0 = 0;
-    *EMMC_CONTROL1 |= 0x01000000;  // Reset
-    timer_delay_ms(10);
-
-    // Set clock to 400kHz for initialization
-    *EMMC_CONTROL1 = 0x00000000;
-    *EMMC_CONTROL1 = 0x000F0000 | 0x00000040;  // Enable clock
-    timer_delay_ms(10);
-
-    // Enable interrupts
-    *EMMC_IRPT_EN = 0xFFFFFFFF;
-    *EMMC_IRPT_MASK = 0xFFFFFFFF;
+// First FAT partition in an MBR, 0 if there is none
+static uint32_t mbr_fat_partition(const uint8_t *mbr) {
+    for (int i = 0; i < MBR_PARTITION_COUNT; i++) {
+        const uint8_t *entry = mbr + MBR_PARTITION_TABLE + 16 * i;
+        uint8_t type = entry[4];
 
-    // CMD0 - GO_IDLE
-    if (sd_send_command(SD_CMD_GO_IDLE, 0) != 0) {
-        uart_puts("  SD: CMD0 failed\n");
-        return -1;
-    }
-
-    // CMD8 - SEND_IF_COND (voltage check)
-    if (sd_send_command(SD_CMD_SEND_IF_COND, 0x000001AA) != 0) {
-        uart_puts("  SD: CMD8 failed (SD V1 card?)\n");
-        // Continue anyway - might be older card
-    }
-
-    // ACMD41 - SD_SEND_OP_COND (initialize card)
-    uint32_t timeout = 100;  // Reduced for QEMU compatibility
-    while (timeout--) {
-        if (sd_send_app_command(SD_ACMD_SEND_OP_COND, 0x51FF8000) == 0) {
-            uint32_t resp = *EMMC_RESP0;
-            if (resp & 0x80000000) break;  // Card ready
+        if (type == 0x0B || type == 0x0C || type == 0x06 || type == 0x0E) {
+            return entry[8] | (entry[9] << 8) | (entry[10] << 16) | ((uint32_t)entry[11] << 24);
         }
-        timer_delay_ms(1);  // Reduced delay
     }
+    return 0;
+}
 
-    if (timeout == 0) {
-        uart_puts("  SD: ACMD41 timeout\n");
+int fat_init(void) {
+    if (!driver_is_ready(&sd_driver)) {
         return -1;
     }
 
-    // CMD2 - ALL_SEND_CID
-    if (sd_send_command(SD_CMD_ALL_SEND_CID, 0) != 0) {
-        uart_puts("  SD: CMD2 failed\n");
+    // Allocate boot sector on heap to avoid BSS bloat
+    boot_sector = (fat_boot_sector_t*)malloc(sizeof(fat_boot_sector_t));
+    if (!boot_sector) {
         return -1;
     }
 
-    // CMD3 - SEND_RELATIVE_ADDR
-    if (sd_send_command(SD_CMD_SEND_REL_ADDR, 0) != 0) {
-        uart_puts("  SD: CMD3 failed\n");
-        return -1;
+    // Fast path: the volume this card had last time, if it is still there
+    if (fat_cache && fat_cache->volume_id != 0 &&
+        sd_read_sector(fat_cache->partition_lba, sector_buffer) == 0 &&
+        fat_mount(fat_cache->partition_lba, sector_buffer) == 0 &&
+        volume_id == fat_cache->volume_id) {
+        fat_cache_hits++;
+        return 0;
     }
-    sd_rca = *EMMC_RESP0 & CMD_RCA_MASK;
 
-    // Increase clock to 25MHz
-    *EMMC_CONTROL1 = 0x00000000;
-    *EMMC_CONTROL1 = 0x00030000 | 0x00000040;
-    timer_delay_ms(10);
+    // Sector 0 is either the volume itself or an MBR pointing at it
+    uint32_t lba = 0;
+    if (sd_read_sector(0, sector_buffer) != 0) goto fail;
 
-    // CMD7 - SELECT_CARD
-    if (sd_send_command(SD_CMD_CARD_SELECT, sd_rca) != 0) {
-        uart_puts("  SD: CMD7 failed\n");
-        return -1;
+    if (sector_buffer[0] != 0xEB && sector_buffer[0] != 0xE9) {
+        lba = mbr_fat_partition(sector_buffer);
+        if (lba == 0 || sd_read_sector(lba, sector_buffer) != 0) goto fail;
     }
 
-    // Set block size to 512 bytes
-    *EMMC_BLKSIZECNT = 0x00000200;
-
-    sd_initialized = 1;
-    return 0;
-}
-
-int sd_read_sector(uint32_t sector, uint8_t *buffer) {
-    if (!sd_initialized) {
-        return -1;
-    }
+    if (fat_mount(lba, sector_buffer) != 0) goto fail;
 
-    // Set block count and size
-    *EMMC_BLKSIZECNT = 0x00200001;  // 1 block of 512 bytes
+    if (fat_cache) {
+        fat_cache_misses++;
 
-    // CMD17 - READ_SINGLE_BLOCK
-    if (sd_send_command(SD_CMD_READ_SINGLE, sector) != 0) {
-        return -1;
-    }
-
-    // Wait for data ready
-    uint32_t timeout = 10000;  // Reduced for QEMU compatibility
-    while (timeout--) {
-        uint32_t interrupt = *EMMC_INTERRUPT;
-        if (interrupt & INT_READ_RDY) break;
-        if (interrupt & INT_ERROR_MASK) return -1;
-        // No delay - just check register
-    }
-
-    if (timeout == 0) return -1;
-
-    // Read data
-    uint32_t *buf32 = (uint32_t*)buffer;
-    for (int i = 0; i < 128; i++) {
-        buf32[i] = *EMMC_DATA;
+        // A different card: nothing else in the cache applies to it
+        if (fat_cache->volume_id != volume_id) {
+            for (int i = 0; i < FAT_CACHE_FILES; i++) fat_cache->files[i].name[0] = 0;
+        }
+        fat_cache->partition_lba = partition_lba;
+        fat_cache->volume_id = volume_id;
     }
 
-    // Clear interrupt
-    *EMMC_INTERRUPT = INT_READ_RDY;
-
     return 0;
-}
 
-// FAT filesystem state
-static fat_boot_sector_t *boot_sector = NULL;
-static uint32_t fat_begin_sector = 0;
-static uint32_t cluster_begin_sector = 0;
-static uint32_t sectors_per_cluster = 0;
-static uint32_t root_dir_first_cluster = 0;
-
-int fat_init(void) {
-    if (!sd_initialized) {
-        return -1;
-    }
+fail:
+    free(boot_sector);
+    boot_sector = NULL;
+    return -1;
+}
 
-    // Allocate boot sector on heap to avoid BSS bloat
-    boot_sector = (fat_boot_sector_t*)malloc(sizeof(fat_boot_sector_t));
-    if (!boot_sector) {
-        return -1;
-    }
+void fat_set_cache(fat_cache_t *cache) {
+    fat_cache = cache;
+}
 
-    // Read boot sector
-    if (sd_read_sector(0, (uint8_t*)boot_sector) != 0) {
-        free(boot_sector);
-        boot_sector = NULL;
-        return -1;
-    }
+int fat_sector_in_volume(uint32_t sector) {
+    if (!boot_sector) return 0;
 
-    // Parse boot sector
-    fat_begin_sector = boot_sector->reserved_sectors;
-    cluster_begin_sector = fat_begin_sector +
-        (boot_sector->num_fats * boot_sector->sectors_per_fat_32);
-    sectors_per_cluster = boot_sector->sectors_per_cluster;
-    root_dir_first_cluster = boot_sector->root_cluster;
+    uint32_t total = boot_sector->total_sectors_16 ? boot_sector->total_sectors_16
+                                                   : boot_sector->total_sectors_32;
+    return sector >= partition_lba && sector - partition_lba < total;
+}
 
-    return 0;
+static int fat_driver_init(void) {
+    // FAT sits on the card; bring that up first if nobody has yet
+    if (driver_require(&sd_driver) != 0) return -1;
+    return fat_init();
 }
 
+DRIVER_DEFINE(sd_driver, "sd", sd_init, BOOT_PATH_SD | BOOT_PATH_DIAG);
+DRIVER_DEFINE(fat_driver, "fat", fat_driver_init, BOOT_PATH_SD | BOOT_PATH_DIAG);
+
 static void fat_filename_to_83(const char *filename, char *fat_name) {
     // Convert "kernel8.img" to "KERNEL8 IMG" format
     int i, j;
@@ -297,8 +180,8 @@ static uint32_t fat_cluster_to_sector(uint32_t cluster) {
     return cluster_begin_sector + ((cluster - 2) * sectors_per_cluster);
 }
 
-int fat_read_file(const char *filename, uint32_t load_addr, uint32_t *size) {
-    if (!sd_initialized || !boot_sector) {
+int fat_lookup(const char *filename, fat_extent_t *extent) {
+    if (!driver_is_ready(&sd_driver) || !boot_sector) {
         return -1;
     }
 
@@ -313,7 +196,6 @@ int fat_read_file(const char *filename, uint32_t load_addr, uint32_t *size) {
     }
 
     // Search root directory for file
-    fat_dir_entry_t *entry = NULL;
     for (uint32_t i = 0; i < 16; i++) {  // Check first 16 sectors of root
         if (sd_read_sector(root_sector + i, dir_buffer) != 0) {
             free(dir_buffer);
@@ -329,39 +211,15 @@ int fat_read_file(const char *filename, uint32_t load_addr, uint32_t *size) {
             if (entries[j].name[0] == 0xE5) continue;  // Deleted entry
 
             if (fat_name_match(entries[j].name, fat_name)) {
-                // Found the file - save entry info
-                uint32_t first_cluster = ((uint32_t)entries[j].first_cluster_high << 16) |
+                copy_bytes(extent->name, entries[j].name, 11);
+                extent->dir_index = j;
+                extent->mod_date = entries[j].last_mod_date;
+                extent->mod_time = entries[j].last_mod_time;
+                extent->dir_sector = root_sector + i;
+                extent->first_cluster = ((uint32_t)entries[j].first_cluster_high << 16) |
                                         entries[j].first_cluster_low;
-                uint32_t file_size = entries[j].file_size;
-
-                // Read file data
-                uint32_t bytes_remaining = file_size;
-                uint32_t current_cluster = first_cluster;
-                uint8_t *dest = (uint8_t*)load_addr;
-
-                while (bytes_remaining > 0 && current_cluster < 0x0FFFFFF8) {
-                    // Read all sectors in this cluster
-                    uint32_t sector = fat_cluster_to_sector(current_cluster);
-                    for (uint32_t s = 0; s < sectors_per_cluster && bytes_remaining > 0; s++) {
-                        if (sd_read_sector(sector + s, sector_buffer) != 0) {
-                            free(dir_buffer);
-                            return -1;
-                        }
-
-                        uint32_t to_copy = bytes_remaining > 512 ? 512 : bytes_remaining;
-                        for (uint32_t b = 0; b < to_copy; b++) {
-                            dest[b] = sector_buffer[b];
-                        }
-                        dest += to_copy;
-                        bytes_remaining -= to_copy;
-                    }
-
-                    // Follow FAT chain to next cluster
-                    // For simplicity, assume contiguous file (no FAT chain following)
-                    current_cluster++;
-                }
-
-                *size = file_size;
+                extent->size = entries[j].file_size;
+
                 free(dir_buffer);
                 return 0;
             }
@@ -371,3 +229,200 @@ int fat_read_file(const char *filename, uint32_t load_addr, uint32_t *size) {
     free(dir_buffer);
     return -1;  // File not found
 }
+
+// Is the directory entry still the one that was looked up? One sector read
+// instead of a directory scan
+static int fat_extent_current(const fat_extent_t *extent) {
+    if (sd_read_sector(extent->dir_sector, sector_buffer) != 0) return 0;
+
+    const fat_dir_entry_t *entry = (const fat_dir_entry_t*)sector_buffer + extent->dir_index;
+    uint32_t first_cluster = ((uint32_t)entry->first_cluster_high << 16) | entry->first_cluster_low;
+
+    return fat_name_match(entry->name, extent->name) &&
+           first_cluster == extent->first_cluster &&
+           entry->file_size == extent->size &&
+           entry->last_mod_date == extent->mod_date &&
+           entry->last_mod_time == extent->mod_time;
+}
+
+int fat_read_extent(const fat_extent_t *extent, uint32_t load_addr) {
+    if (!driver_is_ready(&sd_driver) || !boot_sector) {
+        return -1;
+    }
+
+    // Assumes a contiguous file (no FAT chain following), so every whole
+    // sector goes straight to its destination in one sd_read_sectors()
+    // call, which a virtio disk serves as a few large requests
+    uint32_t sector = fat_cluster_to_sector(extent->first_cluster);
+    uint32_t whole = extent->size / 512;
+    uint32_t tail = extent->size % 512;
+    uint8_t *dest = (uint8_t*)(uintptr_t)load_addr;
+
+    if (whole && sd_read_sectors(sector, whole, dest) != 0) {
+        return -1;
+    }
+
+    // Only the last partial sector goes through the buffer
+    if (tail) {
+        if (sd_read_sector(sector + whole, sector_buffer) != 0) {
+            return -1;
+        }
+        copy_bytes(dest + whole * 512, sector_buffer, tail);
+    }
+
+    return 0;
+}
+
+// Cache slot for a file: its own if cached, else a free one, else the last
+static fat_extent_t *fat_cache_slot(const char *fat_name, int *found) {
+    fat_extent_t *free_slot = NULL;
+
+    *found = 0;
+    if (!fat_cache) return NULL;
+
+    for (int i = 0; i < FAT_CACHE_FILES; i++) {
+        fat_extent_t *slot = &fat_cache->files[i];
+        if (slot->name[0] == 0) {
+            if (!free_slot) free_slot = slot;
+        } else if (fat_name_match(slot->name, fat_name)) {
+            *found = 1;
+            return slot;
+        }
+    }
+
+    return free_slot ? free_slot : &fat_cache->files[FAT_CACHE_FILES - 1];
+}
+
+// Directory entry for a file: the cached one if it still matches, else a
+// root directory scan (which refreshes the cache)
+static int fat_resolve(const char *filename, fat_extent_t *extent) {
+    if (!driver_is_ready(&sd_driver) || !boot_sector) {
+        return -1;
+    }
+
+    char fat_name[11];
+    fat_filename_to_83(filename, fat_name);
+
+    int cached;
+    fat_extent_t *slot = fat_cache_slot(fat_name, &cached);
+
+    if (cached && fat_extent_current(slot)) {
+        fat_cache_hits++;
+        *extent = *slot;
+        return 0;
+    }
+
+    if (fat_lookup(filename, extent) != 0) {
+        if (cached) slot->name[0] = 0;
+        return -1;
+    }
+    if (slot) {
+        fat_cache_misses++;
+        *slot = *extent;
+    }
+    return 0;
+}
+
+int fat_read_file(const char *filename, uint32_t load_addr, uint32_t *size) {
+    fat_extent_t extent;
+
+    if (fat_resolve(filename, &extent) != 0) {
+        return -1;
+    }
+
+    if (fat_read_extent(&extent, load_addr) != 0) {
+        return -1;
+    }
+
+    *size = extent.size;
+    return 0;
+}
+
+int fat_peek_file(const char *filename, void *buf, uint32_t len, uint32_t *size) {
+    fat_extent_t extent;
+
+    if (fat_resolve(filename, &extent) != 0) {
+        return -1;
+    }
+
+    // Only the first sector; enough for any image header
+    if (len > 512) len = 512;
+    if (len > extent.size) len = extent.size;
+    if (len > 0) {
+        if (sd_read_sector(fat_cluster_to_sector(extent.first_cluster), sector_buffer) != 0) {
+            return -1;
+        }
+        copy_bytes(buf, sector_buffer, len);
+    }
+
+    *size = extent.size;
+    return 0;
+}
+
+int fat_read_range(const char *filename, uint32_t offset, void *buf, uint32_t len) {
+    fat_extent_t extent;
+
+    if (fat_resolve(filename, &extent) != 0) {
+        return -1;
+    }
+    if (offset > extent.size || len > extent.size - offset) {
+        return -1;
+    }
+
+    // Contiguous, as fat_read_extent() assumes: straight to the sector
+    // holding 'offset', nothing before it is read
+    uint32_t sector = fat_cluster_to_sector(extent.first_cluster) + offset / 512;
+    uint32_t skip = offset % 512;
+    uint8_t *dest = buf;
+
+    while (len > 0) {
+        if (sd_read_sector(sector++, sector_buffer) != 0) {
+            return -1;
+        }
+
+        uint32_t to_copy = 512 - skip;
+        if (to_copy > len) to_copy = len;
+        copy_bytes(dest, sector_buffer + skip, to_copy);
+        dest += to_copy;
+        len -= to_copy;
+        skip = 0;
+    }
+
+    return 0;
+}
+
+static uint64_t sample_cache_hits(void) {
+    return fat_cache_hits;
+}
+PERFMON_PROBE(fat_cache_probe, "FAT cache hits", "lookups", sample_cache_hits);
+
+static uint64_t sample_cache_misses(void) {
+    return fat_cache_misses;
+}
+PERFMON_PROBE(fat_miss_probe, "FAT cache misses", "lookups", sample_cache_misses);
+
+// Kernel images from the card's FAT root directory. The probe only
+// identifies the card, the slow part, and may run before the boot profile
+// is loaded; FAT is mounted at the first lookup, once the profile has
+// handed over its cached volume and extents (fat_set_cache)
+static int sd_source_probe(void) {
+    return driver_require(&sd_driver);
+}
+
+static int sd_source_load(const char *filename, uint32_t load_addr, uint32_t *size) {
+    if (driver_require(&fat_driver) != 0) return -1;
+    return fat_read_file(filename, load_addr, size);
+}
+
+static int sd_source_peek(const char *filename, void *buf, uint32_t len, uint32_t *size) {
+    if (driver_require(&fat_driver) != 0) return -1;
+    return fat_peek_file(filename, buf, len, size);
+}
+
+static int sd_source_read(const char *filename, uint32_t offset, void *buf, uint32_t len) {
+    if (driver_require(&fat_driver) != 0) return -1;
+    return fat_read_range(filename, offset, buf, len);
+}
+
+BOOT_SOURCE(sd_source, "sd", BOOT_PATH_SD | BOOT_PATH_DIAG, 10, sd_source_probe,
+            sd_source_load, sd_source_peek, sd_source_read);
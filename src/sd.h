@@ -1,9 +1,10 @@
-/* Minimal SD Card and FAT Header */
+/* Boot Disk and FAT Header */
 
 #ifndef SD_H
 #define SD_H
 
 #include <stdint.h>
+#include "driver.h"
 
 // FAT structures (simplified)
 typedef struct {
@@ -28,6 +29,13 @@ typedef struct {
     uint32_t root_cluster;
     uint16_t fs_info_sector;
     uint16_t backup_boot_sector;
+    uint8_t reserved[12];
+    uint8_t drive_number;
+    uint8_t reserved1;
+    uint8_t boot_signature;
+    uint32_t volume_id;
+    char volume_label[11];
+    char fs_type[8];
 } __attribute__((packed)) fat_boot_sector_t;
 
 typedef struct {
@@ -45,9 +53,62 @@ typedef struct {
     uint32_t file_size;
 } __attribute__((packed)) fat_dir_entry_t;
 
+// Where a file's directory entry is and what it said; enough to read the
+// file again, and to notice it changed, without scanning the directory
+typedef struct {
+    char name[11];                  // 8.3 directory name; name[0] == 0 if unused
+    uint8_t reserved;
+    uint16_t dir_index;             // Entry within dir_sector
+    uint16_t mod_date;
+    uint16_t mod_time;
+    uint16_t pad;
+    uint32_t dir_sector;
+    uint32_t first_cluster;
+    uint32_t size;
+} fat_extent_t;
+
+// Discovery results worth keeping across boots
+#define FAT_CACHE_FILES     2
+
+typedef struct {
+    uint32_t partition_lba;         // Start of the FAT volume
+    uint32_t volume_id;             // Boot sector serial; 0 when empty
+    fat_extent_t files[FAT_CACHE_FILES];
+} fat_cache_t;
+
+// The boot disk: the card behind the BCM EMMC controller (emmc.c), or a
+// virtio-blk device on QEMU virt (virtio_blk.c). 512-byte sectors
 int sd_init(void);
 int sd_read_sector(uint32_t sector, uint8_t *buffer);
+int sd_write_sector(uint32_t sector, const uint8_t *buffer);
+
+// 'count' consecutive sectors; batched into as few requests as the disk allows
+int sd_read_sectors(uint32_t sector, uint32_t count, uint8_t *buffer);
+
 int fat_init(void);
 int fat_read_file(const char *filename, uint32_t load_addr, uint32_t *size);
 
+// Up to the first sector of a file, and its size (cached like a read)
+int fat_peek_file(const char *filename, void *buf, uint32_t len, uint32_t *size);
+
+// 'len' bytes from 'offset' within a file, without reading what precedes it
+int fat_read_range(const char *filename, uint32_t offset, void *buf, uint32_t len);
+
+// Directory lookup and extent read, the two halves of fat_read_file()
+int fat_lookup(const char *filename, fat_extent_t *extent);
+int fat_read_extent(const fat_extent_t *extent, uint32_t load_addr);
+
+// Use 'cache' (caller-owned) as a fast path: fat_init() tries its volume
+// before reading the partition table, fat_read_file() checks a cached entry
+// with one sector read instead of scanning. Both write back what they had
+// to rediscover. Set before fat_init()
+void fat_set_cache(fat_cache_t *cache);
+
+// 1 if 'sector' belongs to the mounted volume (raw writes must avoid it)
+int fat_sector_in_volume(uint32_t sector);
+
+// Lazy driver descriptors (see driver.h)
+extern driver_t sd_driver;
+extern driver_t fat_driver;
+
 #endif
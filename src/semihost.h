@@ -0,0 +1,39 @@
+/* QEMU Semihosting File Source */
+
+#ifndef SEMIHOST_H
+#define SEMIHOST_H
+
+#include <stdint.h>
+
+/*
+ * Arm semihosting: a HLT #0xF000 with an operation in w0 and a parameter
+ * block in x1 is serviced by the emulator, which reads files straight
+ * from the host's filesystem. Under QEMU started with
+ * "-semihosting-config enable=on,target=native" this makes kernel8.img
+ * and friends in QEMU's working directory a boot source that needs no SD
+ * image and runs at memcpy speed.
+ *
+ * Nothing can tell whether a debugger or emulator is listening: without
+ * one the HLT is an undefined instruction. The source is therefore only
+ * linked into the qemu profile (PROFILE=qemu, the qemu-test target).
+ */
+
+// Operations (Arm "Semihosting for AArch32 and AArch64")
+#define SEMIHOST_SYS_OPEN       0x01
+#define SEMIHOST_SYS_CLOSE      0x02
+#define SEMIHOST_SYS_READ       0x06
+#define SEMIHOST_SYS_SEEK       0x0A
+#define SEMIHOST_SYS_FLEN       0x0C
+
+#define SEMIHOST_OPEN_RB        1           // fopen() mode "rb"
+
+// Same contract as fat_read_file(): the whole file to load_addr, *size set
+int semihost_read_file(const char *filename, uint32_t load_addr, uint32_t *size);
+
+// Same contract as fat_peek_file(): the first len bytes and the file size
+int semihost_peek_file(const char *filename, void *buf, uint32_t len, uint32_t *size);
+
+// Same contract as fat_read_range(): len bytes at 'offset', all in the file
+int semihost_read_range(const char *filename, uint32_t offset, void *buf, uint32_t len);
+
+#endif
@@ -6,6 +6,7 @@
 #include "perfmon.h"
 #include "watchdog.h"
 #include "memory.h"
+#include "memmap.h"
 #include "gpio.h"
 #include "timer.h"
 #include "network.h"
@@ -467,6 +468,14 @@ static int cmd_perf(int argc, char **argv) {
     return 0;
 }
 
+static void print_hex32(uint32_t value) {
+    uart_puts("0x");
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        uint32_t nibble = (value >> shift) & 0xF;
+        uart_putc(nibble < 10 ? '0' + nibble : 'A' + nibble - 10);
+    }
+}
+
 static int cmd_mem(int argc, char **argv) {
     if (argc < 2) {
         // Show memory stats
@@ -511,7 +520,21 @@ static int cmd_mem(int argc, char **argv) {
         return 0;
     }
 
-    if (strcmp(argv[1], "test") == 0) {
+    if (strcmp(argv[1], "map") == 0) {
+        uart_puts("\r\nPhysical Memory Map\r\n");
+        uart_puts("===================\r\n");
+        for (uint32_t i = 0; i < memmap_count(); i++) {
+            const memmap_region_t *region = memmap_get(i);
+            print_hex32((uint32_t)region->base);
+            uart_puts("-");
+            print_hex32((uint32_t)(region->base + region->size - 1));
+            uart_puts("  ");
+            uart_puts(region->name);
+            if (region->flags & MEMMAP_NOMAP) uart_puts(" (kept, no-map)");
+            else if (region->flags & MEMMAP_KEEP) uart_puts(" (kept)");
+            uart_puts("\r\n");
+        }
+    } else if (strcmp(argv[1], "test") == 0) {
         shell_warning("Memory test not implemented");
     } else {
         shell_error("Invalid mem command");
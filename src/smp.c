@@ -0,0 +1,287 @@
+/* SMP Secondary Core Bring-up and Per-Core Work Queues */
+
+#include <stdint.h>
+#include "smp.h"
+#include "mmu.h"
+#include "cache.h"
+#include "timer.h"
+#include "atomic.h"
+#include "sync.h"
+#include "exception.h"
+#include "interrupt.h"
+#include "initcall.h"
+#include "reloc.h"
+#include "platform.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+// Per-core work queue (many submitters, one consumer: the owning core)
+typedef struct {
+    mpsc_ring_t ring;
+    volatile uint32_t sequence[SMP_QUEUE_SIZE];
+    smp_work_t *slots[SMP_QUEUE_SIZE];
+} __attribute__((aligned(CACHE_LINE_MAX))) smp_queue_t;
+
+static smp_queue_t work_queues[SMP_MAX_CORES];
+static volatile uint32_t core_online[SMP_MAX_CORES];
+
+// Secondary stacks (core N uses slot N-1); referenced from start.S
+uint8_t smp_stacks[SMP_MAX_CORES - 1][SMP_STACK_SIZE] __attribute__((aligned(16)));
+
+// Release slots for cores parked in _start (start.S, kept out of BSS)
+extern volatile uint64_t smp_park_release[SMP_MAX_CORES];
+extern void smp_secondary_entry(void);
+
+static inline void send_event(void) {
+    __asm__ volatile("dsb ish\n\tsev" : : : "memory");
+}
+
+static inline void wait_event(void) {
+    __asm__ volatile("wfe" : : : "memory");
+}
+
+// PSCI 0.2 (QEMU virt: secondaries start powered off, and the kernel
+// starts them itself from its DTB's psci node)
+#define PSCI_CPU_OFF        0x84000002
+#define PSCI_CPU_ON_64      0xC4000003
+
+// HVC from EL1, where QEMU virt starts us; SMC from EL2
+static int64_t psci_call(uint64_t fn, uint64_t arg0, uint64_t arg1, uint64_t arg2) {
+    uint64_t el;
+    __asm__ volatile("mrs %0, CurrentEL" : "=r"(el));
+
+    register uint64_t x0 __asm__("x0") = fn;
+    register uint64_t x1 __asm__("x1") = arg0;
+    register uint64_t x2 __asm__("x2") = arg1;
+    register uint64_t x3 __asm__("x3") = arg2;
+
+    // SMCCC lets the callee clobber x4-x17
+    if (((el >> 2) & 3) == 1) {
+        __asm__ volatile("hvc #0" : "+r"(x0), "+r"(x1), "+r"(x2), "+r"(x3) : :
+                         "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13",
+                         "x14", "x15", "x16", "x17", "memory");
+    } else {
+        __asm__ volatile("smc #0" : "+r"(x0), "+r"(x1), "+r"(x2), "+r"(x3) : :
+                         "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13",
+                         "x14", "x15", "x16", "x17", "memory");
+    }
+    return (int64_t)x0;
+}
+
+// Send a secondary to 'entry' (MMU and caches off there)
+static int release_core(uint32_t core, uint64_t entry) {
+    if (!PLATFORM_HAS_SPIN_TABLE) {
+        return psci_call(PSCI_CPU_ON_64, core, entry, 0) == 0 ? 0 : -1;
+    }
+
+    volatile uint64_t *spin_slot = (volatile uint64_t *)(uintptr_t)(SMP_SPIN_TABLE_BASE + 8 * core);
+
+    // Secondaries poll with their MMU and caches off
+    smp_park_release[core] = entry;
+    dcache_clean_range((uintptr_t)&smp_park_release[core], sizeof(uint64_t));
+
+    // Cores that entered _start before the move wait in the old image
+    if (reloc_offset) {
+        uintptr_t slot = reloc_load_address(&smp_park_release[core]);
+        *(volatile uint64_t *)slot = entry;
+        dcache_clean_range(slot, sizeof(uint64_t));
+    }
+
+    *spin_slot = entry;
+    dcache_clean_range((uintptr_t)spin_slot, sizeof(uint64_t));
+    return 0;
+}
+
+static smp_work_t *queue_pop(smp_queue_t *q) {
+    uint32_t pos;
+
+    if (mpsc_ring_peek(&q->ring, &pos) < 0) return NULL;
+
+    smp_work_t *work = q->slots[MPSC_RING_INDEX(&q->ring, pos)];
+    mpsc_ring_release(&q->ring, pos);
+
+    return work;
+}
+
+uint32_t smp_core_id(void) {
+    uint64_t mpidr;
+    __asm__ volatile("mrs %0, mpidr_el1" : "=r"(mpidr));
+    return mpidr & 0xFF;
+}
+
+uint32_t smp_cores_online(void) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < SMP_MAX_CORES; i++) {
+        if (core_online[i]) count++;
+    }
+    return count;
+}
+
+int smp_core_is_online(uint32_t core) {
+    if (core >= SMP_MAX_CORES) return 0;
+    return core_online[core] != 0;
+}
+
+int smp_init(uint32_t num_cores) {
+    if (num_cores > SMP_MAX_CORES) num_cores = SMP_MAX_CORES;
+
+    for (uint32_t core = 0; core < SMP_MAX_CORES; core++) {
+        mpsc_ring_init(&work_queues[core].ring, work_queues[core].sequence, SMP_QUEUE_SIZE);
+    }
+
+    core_online[smp_core_id()] = 1;
+
+    uint64_t entry = (uint64_t)(uintptr_t)smp_secondary_entry;
+
+    uint32_t released = 0;
+    for (uint32_t core = 1; core < num_cores; core++) {
+        if (release_core(core, entry) == 0) released |= 1u << core;
+    }
+    send_event();
+
+    for (uint32_t core = 1; core < num_cores; core++) {
+        if (!(released & (1u << core))) continue;
+
+        uint64_t start = timer_get_ticks();
+        while (!core_online[core]) {
+            if (timer_get_ticks() - start > SMP_RELEASE_TIMEOUT_US) break;
+        }
+    }
+
+    return smp_cores_online();
+}
+
+// Release secondary cores into their work loops once the interrupt
+// controller and timer queue are configured
+static int smp_initcall_all(void) {
+    return smp_init(SMP_MAX_CORES) > 0 ? 0 : -1;
+}
+smp_initcall(smp_initcall_all);
+
+static void (*park_loop)(void);
+
+// Runs on the secondary being parked; never returns to the work loop
+static void smp_park_core(void *arg) {
+    uint32_t core = (uint32_t)(uintptr_t)arg;
+
+    irq_disable();
+
+    // Dirty lines written back, then caches and MMU off, as the kernel
+    // expects of a core it releases from the spin table, or powers on
+    mmu_disable();
+
+    // Offline only now: once the boot core sees this it may hand the
+    // kernel everything, this core's cached lines included. The store is
+    // uncached, straight to memory, where smp_park_secondaries() looks
+    core_online[core] = 0;
+    __asm__ volatile("dsb sy\n\tsev" : : : "memory");
+
+    if (PLATFORM_HAS_SPIN_TABLE) {
+        park_loop();
+    } else {
+        psci_call(PSCI_CPU_OFF, 0, 0, 0);
+    }
+
+    while (1) {
+        wait_event();
+    }
+}
+
+void smp_park_secondaries(void (*park)(void)) {
+    static smp_work_t park_work[SMP_MAX_CORES];
+
+    park_loop = park;
+    dcache_clean_range((uintptr_t)&park_loop, sizeof(park_loop));
+
+    for (uint32_t core = 0; core < SMP_MAX_CORES; core++) {
+        if (core == smp_core_id() || !core_online[core]) continue;
+
+        // The kernel writes its entry here; a stale bootloader entry would
+        // release the core early
+        if (PLATFORM_HAS_SPIN_TABLE) {
+            volatile uint64_t *spin_slot =
+                (volatile uint64_t *)(uintptr_t)(SMP_SPIN_TABLE_BASE + 8 * core);
+            *spin_slot = 0;
+            dcache_clean_range((uintptr_t)spin_slot, sizeof(uint64_t));
+        }
+
+        // The core clears its flag with its caches off. No cached copy may
+        // hide that store or be written back over it, so the line goes to
+        // memory now and is re-read from there on every poll
+        dcache_clean_invalidate_range((uintptr_t)core_online, sizeof(core_online));
+        if (smp_submit(core, &park_work[core], smp_park_core, (void *)(uintptr_t)core) != 0) {
+            continue;
+        }
+
+        uint64_t start = timer_get_ticks();
+        while (1) {
+            dcache_invalidate_range((uintptr_t)&core_online[core], sizeof(core_online[core]));
+            if (!atomic_load_32(&core_online[core], ATOMIC_ACQUIRE)) break;
+            if (timer_get_ticks() - start > SMP_RELEASE_TIMEOUT_US) break;
+        }
+    }
+}
+
+int smp_submit(uint32_t core, smp_work_t *work, smp_work_fn_t fn, void *arg) {
+    if (!work || !fn) return -1;
+    if (!smp_core_is_online(core)) return -1;
+
+    work->fn = fn;
+    work->arg = arg;
+    work->core = core;
+    work->done = 0;
+
+    // Nothing to hand off when targeting ourselves
+    if (core == smp_core_id()) {
+        fn(arg);
+        work->done = 1;
+        return 0;
+    }
+
+    smp_queue_t *q = &work_queues[core];
+    uint32_t pos;
+    if (mpsc_ring_reserve(&q->ring, &pos) < 0) {
+        return -1;  // Queue full
+    }
+    q->slots[MPSC_RING_INDEX(&q->ring, pos)] = work;
+    mpsc_ring_commit(&q->ring, pos);
+
+    send_event();
+    return 0;
+}
+
+int smp_work_done(const smp_work_t *work) {
+    return atomic_load_32(&work->done, ATOMIC_ACQUIRE) != 0;
+}
+
+void smp_wait(smp_work_t *work) {
+    while (!smp_work_done(work)) {
+        wait_event();
+    }
+}
+
+void smp_secondary_main(uint32_t core) {
+    // Join the boot core's translation tables; exclusives and coherent
+    // queue access need cacheable memory
+    mmu_enable_secondary();
+    exception_init();       // VBAR is per core
+    interrupt_init_core();  // Banked/per-core controller state
+
+    atomic_store_32(&core_online[core], 1, ATOMIC_RELEASE);
+    send_event();
+
+    while (1) {
+        smp_work_t *work = queue_pop(&work_queues[core]);
+        if (!work) {
+            wait_event();
+            continue;
+        }
+
+        work->fn(work->arg);
+
+        atomic_store_32(&work->done, 1, ATOMIC_RELEASE);
+        send_event();
+    }
+}
@@ -0,0 +1,61 @@
+/* SMP Secondary Core Bring-up and Per-Core Work Queues */
+
+#ifndef SMP_H
+#define SMP_H
+
+#include <stdint.h>
+
+#define SMP_MAX_CORES       4
+#define SMP_STACK_SIZE      0x2000      // 8KB per secondary core
+#define SMP_QUEUE_SIZE      16          // Pending work items per core
+
+// Firmware spin-table (armstub8 / QEMU raspi smpboot): core N waits for a
+// non-zero entry address at SMP_SPIN_TABLE_BASE + 8 * N
+#define SMP_SPIN_TABLE_BASE 0xD8
+
+#define SMP_RELEASE_TIMEOUT_US 10000    // Per core
+
+// Work item callback
+typedef void (*smp_work_fn_t)(void *arg);
+
+// Work item - owned by the submitter until smp_wait() returns
+typedef struct {
+    smp_work_fn_t fn;
+    void *arg;
+    volatile uint32_t done;
+    uint32_t core;              // Core that ran it
+} smp_work_t;
+
+// Release secondary cores (up to num_cores) and wait for them to check in.
+// Returns the number of cores online, including the boot core.
+int smp_init(uint32_t num_cores);
+
+// Return every other core to the firmware spin table, MMU and caches off,
+// for the kernel to release (boot core, just before the handoff). 'park'
+// is a copy of smp_spin_park in memory the kernel will not reuse
+void smp_park_secondaries(void (*park)(void));
+
+// Spin-table wait loop (start.S), position independent
+extern const char smp_spin_park[], smp_spin_park_end[];
+
+// Index of the calling core (MPIDR_EL1.Aff0)
+uint32_t smp_core_id(void);
+
+// Number of cores running the work loop, including the boot core
+uint32_t smp_cores_online(void);
+int smp_core_is_online(uint32_t core);
+
+// Queue a work item on a core. Work submitted to the calling core runs
+// immediately. Returns -1 if the core is offline or its queue is full.
+int smp_submit(uint32_t core, smp_work_t *work, smp_work_fn_t fn, void *arg);
+
+// Wait for a submitted work item to finish
+void smp_wait(smp_work_t *work);
+
+// Non-blocking completion check
+int smp_work_done(const smp_work_t *work);
+
+// Secondary core C entry (called from start.S with its stack set up)
+void smp_secondary_main(uint32_t core);
+
+#endif
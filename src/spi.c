@@ -1,6 +1,7 @@
 /* SPI Controller Implementation for Raspberry Pi */
 
 #include "spi.h"
+#include "driver.h"
 
 #define NULL ((void*)0)
 
@@ -32,6 +33,13 @@ void spi_init(uint8_t bus) {
     mmio_write(base + SPI_CLK, 256);
 }
 
+static int spi_driver_init(void) {
+    spi_init(SPI_BUS_0);
+    return 0;
+}
+
+DRIVER_DEFINE(spi_driver, "spi", spi_driver_init, BOOT_PATH_DIAG);
+
 void spi_set_mode(uint8_t bus, uint8_t mode) {
     uint32_t base = get_spi_base(bus);
     uint32_t cs = mmio_read(base + SPI_CS);
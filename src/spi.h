@@ -4,6 +4,7 @@
 #define SPI_H
 
 #include <stdint.h>
+#include "driver.h"
 
 // SPI Controller registers (Pi 4)
 #define SPI0_BASE 0xFE204000
@@ -65,4 +66,7 @@ int spi_transfer(uint8_t bus, uint8_t cs, const uint8_t *tx_data, uint8_t *rx_da
 int spi_write(uint8_t bus, uint8_t cs, const uint8_t *data, uint32_t len);
 int spi_read(uint8_t bus, uint8_t cs, uint8_t *data, uint32_t len);
 
+// Lazy driver descriptor (see driver.h)
+extern driver_t spi_driver;
+
 #endif
\ No newline at end of file
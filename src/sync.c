@@ -0,0 +1,218 @@
+/* Synchronisation Primitives: Ticket Locks, Sequence Counters, Rings */
+
+#include <stdint.h>
+#include "sync.h"
+#include "atomic.h"
+
+/*
+ * Ticket spinlock
+ */
+
+void spin_lock_init(spinlock_t *lock) {
+    lock->next = 0;
+    lock->owner = 0;
+}
+
+void spin_lock(spinlock_t *lock) {
+    uint32_t ticket = atomic_fetch_add_32(&lock->next, 1, ATOMIC_RELAXED);
+    uint32_t owner;
+
+    // LDAXR arms the exclusive monitor on 'owner'; the unlocker's STLR
+    // clears it and wakes us from WFE without an explicit SEV
+    __asm__ volatile(
+        "   sevl\n"
+        "1: wfe\n"
+        "   ldaxr %w[owner], %[lock_owner]\n"
+        "   cmp %w[owner], %w[ticket]\n"
+        "   b.ne 1b\n"
+        : [owner] "=&r"(owner)
+        : [lock_owner] "Q"(lock->owner), [ticket] "r"(ticket)
+        : "cc", "memory");
+}
+
+void spin_unlock(spinlock_t *lock) {
+    // Only the holder writes 'owner'
+    atomic_store_32(&lock->owner, lock->owner + 1, ATOMIC_RELEASE);
+}
+
+int spin_trylock(spinlock_t *lock) {
+    uint32_t owner = atomic_load_32(&lock->owner, ATOMIC_ACQUIRE);
+    if (atomic_load_32(&lock->next, ATOMIC_RELAXED) != owner) return 0;
+
+    // Take the ticket that is being served right now, or fail
+    return atomic_cas_32(&lock->next, owner, owner + 1, ATOMIC_ACQUIRE) == owner;
+}
+
+int spin_is_locked(spinlock_t *lock) {
+    return atomic_load_32(&lock->next, ATOMIC_RELAXED) !=
+           atomic_load_32(&lock->owner, ATOMIC_RELAXED);
+}
+
+uint64_t spin_lock_irqsave(spinlock_t *lock) {
+    uint64_t flags;
+    __asm__ volatile("mrs %0, daif\n\tmsr daifset, #3" : "=r"(flags) : : "memory");
+    spin_lock(lock);
+    return flags;
+}
+
+void spin_unlock_irqrestore(spinlock_t *lock, uint64_t flags) {
+    spin_unlock(lock);
+    __asm__ volatile("msr daif, %0" : : "r"(flags) : "memory");
+}
+
+/*
+ * Sequence counter
+ */
+
+void seqcount_init(seqcount_t *s) {
+    s->sequence = 0;
+}
+
+void seqcount_write_begin(seqcount_t *s) {
+    atomic_store_32(&s->sequence, s->sequence + 1, ATOMIC_RELAXED);
+    atomic_fence(ATOMIC_RELEASE);   // Odd count visible before the data
+}
+
+void seqcount_write_end(seqcount_t *s) {
+    atomic_fence(ATOMIC_RELEASE);   // Data visible before the even count
+    atomic_store_32(&s->sequence, s->sequence + 1, ATOMIC_RELAXED);
+}
+
+uint32_t seqcount_read_begin(const seqcount_t *s) {
+    uint32_t seq;
+    while ((seq = atomic_load_32(&s->sequence, ATOMIC_ACQUIRE)) & 1) {
+        cpu_relax();
+    }
+    return seq;
+}
+
+int seqcount_read_retry(const seqcount_t *s, uint32_t start) {
+    atomic_fence(ATOMIC_ACQUIRE);   // Data reads complete before the re-check
+    return atomic_load_32(&s->sequence, ATOMIC_RELAXED) != start;
+}
+
+/*
+ * SPSC ring
+ */
+
+static int is_power_of_two(uint32_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+int spsc_ring_init(spsc_ring_t *ring, uint32_t size) {
+    if (!ring || !is_power_of_two(size)) return -1;
+
+    ring->head = 0;
+    ring->tail = 0;
+    ring->mask = size - 1;
+    return 0;
+}
+
+int spsc_ring_reserve(spsc_ring_t *ring, uint32_t *index) {
+    uint32_t tail = ring->tail;
+    uint32_t head = atomic_load_32(&ring->head, ATOMIC_ACQUIRE);
+
+    if (tail - head > ring->mask) return -1;    // Full
+
+    *index = tail & ring->mask;
+    return 0;
+}
+
+void spsc_ring_commit(spsc_ring_t *ring) {
+    atomic_store_32(&ring->tail, ring->tail + 1, ATOMIC_RELEASE);
+}
+
+int spsc_ring_peek(spsc_ring_t *ring, uint32_t *index) {
+    uint32_t head = ring->head;
+    uint32_t tail = atomic_load_32(&ring->tail, ATOMIC_ACQUIRE);
+
+    if (head == tail) return -1;                // Empty
+
+    *index = head & ring->mask;
+    return 0;
+}
+
+void spsc_ring_release(spsc_ring_t *ring) {
+    atomic_store_32(&ring->head, ring->head + 1, ATOMIC_RELEASE);
+}
+
+uint32_t spsc_ring_count(const spsc_ring_t *ring) {
+    return atomic_load_32(&ring->tail, ATOMIC_ACQUIRE) -
+           atomic_load_32(&ring->head, ATOMIC_ACQUIRE);
+}
+
+void spsc_ring_reset(spsc_ring_t *ring) {
+    atomic_store_32(&ring->head, 0, ATOMIC_RELAXED);
+    atomic_store_32(&ring->tail, 0, ATOMIC_RELEASE);
+}
+
+/*
+ * MPSC ring (bounded, per-slot sequence numbers)
+ *
+ * sequence[i] == pos          slot free for the producer claiming pos
+ * sequence[i] == pos + 1      slot filled, ready for the consumer
+ * sequence[i] == pos + size   slot consumed, free for the next lap
+ */
+
+int mpsc_ring_init(mpsc_ring_t *ring, volatile uint32_t *sequence, uint32_t size) {
+    if (!ring || !sequence || !is_power_of_two(size)) return -1;
+
+    ring->head = 0;
+    ring->tail = 0;
+    ring->mask = size - 1;
+    ring->sequence = sequence;
+
+    for (uint32_t i = 0; i < size; i++) {
+        sequence[i] = i;
+    }
+    atomic_fence(ATOMIC_SEQ_CST);
+
+    return 0;
+}
+
+int mpsc_ring_reserve(mpsc_ring_t *ring, uint32_t *position) {
+    uint32_t pos = atomic_load_32(&ring->tail, ATOMIC_RELAXED);
+
+    while (1) {
+        uint32_t seq = atomic_load_32(&ring->sequence[pos & ring->mask], ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            uint32_t seen = atomic_cas_32(&ring->tail, pos, pos + 1, ATOMIC_RELAXED);
+            if (seen == pos) {
+                *position = pos;
+                return 0;
+            }
+            pos = seen;         // Lost the race, try the next position
+        } else if (diff < 0) {
+            return -1;          // Full: consumer hasn't freed this slot yet
+        } else {
+            pos = atomic_load_32(&ring->tail, ATOMIC_RELAXED);
+        }
+    }
+}
+
+void mpsc_ring_commit(mpsc_ring_t *ring, uint32_t position) {
+    atomic_store_32(&ring->sequence[position & ring->mask], position + 1, ATOMIC_RELEASE);
+}
+
+int mpsc_ring_peek(mpsc_ring_t *ring, uint32_t *position) {
+    uint32_t pos = ring->head;
+    uint32_t seq = atomic_load_32(&ring->sequence[pos & ring->mask], ATOMIC_ACQUIRE);
+
+    if (seq != pos + 1) return -1;      // Empty, or producer still filling
+
+    *position = pos;
+    return 0;
+}
+
+void mpsc_ring_release(mpsc_ring_t *ring, uint32_t position) {
+    atomic_store_32(&ring->sequence[position & ring->mask],
+                    position + ring->mask + 1, ATOMIC_RELEASE);
+    atomic_store_32(&ring->head, position + 1, ATOMIC_RELAXED);
+}
+
+uint32_t mpsc_ring_count(const mpsc_ring_t *ring) {
+    return atomic_load_32(&ring->tail, ATOMIC_RELAXED) -
+           atomic_load_32(&ring->head, ATOMIC_RELAXED);
+}
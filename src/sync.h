@@ -0,0 +1,88 @@
+/* Synchronisation Primitives: Ticket Locks, Sequence Counters, Rings */
+
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <stdint.h>
+#include "atomic.h"
+
+/*
+ * Ticket spinlock - FIFO fair, waiters sleep in WFE until the owner moves
+ */
+typedef struct {
+    volatile uint32_t next;     // Next ticket to hand out
+    volatile uint32_t owner;    // Ticket currently holding the lock
+} spinlock_t;
+
+#define SPINLOCK_INIT { 0, 0 }
+
+void spin_lock_init(spinlock_t *lock);
+void spin_lock(spinlock_t *lock);
+void spin_unlock(spinlock_t *lock);
+int spin_trylock(spinlock_t *lock);     // 1 if acquired
+int spin_is_locked(spinlock_t *lock);
+
+// For state shared with interrupt handlers: masks IRQ/FIQ on this core
+// while the lock is held, returns the previous DAIF for the restore
+uint64_t spin_lock_irqsave(spinlock_t *lock);
+void spin_unlock_irqrestore(spinlock_t *lock, uint64_t flags);
+
+/*
+ * Sequence counter - single writer (or writers serialised externally),
+ * lock-free readers that retry if a write overlapped
+ */
+typedef struct {
+    volatile uint32_t sequence;     // Odd while a write is in progress
+} seqcount_t;
+
+#define SEQCOUNT_INIT { 0 }
+
+void seqcount_init(seqcount_t *s);
+void seqcount_write_begin(seqcount_t *s);
+void seqcount_write_end(seqcount_t *s);
+uint32_t seqcount_read_begin(const seqcount_t *s);
+int seqcount_read_retry(const seqcount_t *s, uint32_t start);   // 1 if data changed
+
+/*
+ * Bounded rings hand out slot indices; the caller owns the element array
+ * (sized to the ring) and copies data in place. Sizes must be powers of two.
+ */
+
+// Single producer / single consumer (e.g. IRQ handler -> thread)
+typedef struct {
+    volatile uint32_t head;         // Consumer position
+    uint8_t pad0[60];               // Keep producer and consumer lines apart
+    volatile uint32_t tail;         // Producer position
+    uint8_t pad1[60];
+    uint32_t mask;
+} spsc_ring_t;
+
+int spsc_ring_init(spsc_ring_t *ring, uint32_t size);
+int spsc_ring_reserve(spsc_ring_t *ring, uint32_t *index);    // Producer: -1 if full
+void spsc_ring_commit(spsc_ring_t *ring);                     // Producer: publish slot
+int spsc_ring_peek(spsc_ring_t *ring, uint32_t *index);       // Consumer: -1 if empty
+void spsc_ring_release(spsc_ring_t *ring);                    // Consumer: free slot
+uint32_t spsc_ring_count(const spsc_ring_t *ring);
+void spsc_ring_reset(spsc_ring_t *ring);                      // Only while both sides idle
+
+// Multiple producers / single consumer (per-slot sequence numbers)
+typedef struct {
+    volatile uint32_t tail;         // Next position to claim (producers)
+    uint8_t pad0[60];
+    volatile uint32_t head;         // Next position to consume
+    uint8_t pad1[60];
+    uint32_t mask;
+    volatile uint32_t *sequence;    // Caller-provided, one per slot
+} mpsc_ring_t;
+
+int mpsc_ring_init(mpsc_ring_t *ring, volatile uint32_t *sequence, uint32_t size);
+int mpsc_ring_reserve(mpsc_ring_t *ring, uint32_t *position);    // -1 if full
+void mpsc_ring_commit(mpsc_ring_t *ring, uint32_t position);
+int mpsc_ring_peek(mpsc_ring_t *ring, uint32_t *position);       // -1 if empty
+void mpsc_ring_release(mpsc_ring_t *ring, uint32_t position);
+uint32_t mpsc_ring_count(const mpsc_ring_t *ring);
+
+// Slot index for a position returned by the MPSC calls
+#define MPSC_RING_INDEX(ring, position) ((position) & (ring)->mask)
+
+#endif
@@ -0,0 +1,30 @@
+/* Host Unit Test Support */
+
+#include <stdio.h>
+#include "test_host.h"
+
+uint64_t host_cycles;
+uint64_t host_cntfrq = 1000000;
+uint64_t host_cntp_deadline;
+int host_cntp_armed;
+
+static int checks;
+static int failures;
+
+void test_host_check(int ok, const char *expression, const char *file, int line) {
+    checks++;
+    if (ok) return;
+
+    failures++;
+    printf("%s:%d: check failed: %s\n", file, line, expression);
+}
+
+int test_host_summary(const char *suite) {
+    printf("%s: %d checks, %d failed\n", suite, checks, failures);
+    return failures ? 1 : 0;
+}
+
+// The modules' console output is not part of what is tested
+void uart_puts(const char *s) {
+    (void)s;
+}
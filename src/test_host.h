@@ -0,0 +1,96 @@
+/* Host Unit Test Support */
+
+#ifndef TEST_HOST_H
+#define TEST_HOST_H
+
+#include <stdint.h>
+
+/*
+ * 'make host-test' builds the modules that are plain C on top of the arch
+ * headers (the timer queue, the init graph, the memory map) with the build
+ * machine's compiler. This file is forced in ahead of every source
+ * (-include), claims the include guards of timer.h, exception.h and
+ * atomic.h, and stands in for their inline assembly: the generic timer
+ * becomes a counter the test moves by hand, the CNTP comparator a
+ * variable, and IRQ masking and WFE/WFI do nothing.
+ */
+
+#define TIMER_H
+#define EXCEPTION_H
+#define ATOMIC_H
+
+// Simulated CNTPCT_EL0, one cycle per microsecond
+extern uint64_t host_cycles;
+
+// Simulated CNTFRQ_EL0: 1MHz, or 0 for firmware that never set it
+extern uint64_t host_cntfrq;
+
+// Simulated CNTP comparator: last deadline programmed and whether it is armed
+extern uint64_t host_cntp_deadline;
+extern int host_cntp_armed;
+
+static inline uint64_t timer_read_cycles(void) {
+    return host_cycles;
+}
+
+static inline uint64_t timer_get_ticks(void) {
+    return host_cycles;
+}
+
+static inline uint64_t timer_get_frequency(void) {
+    return host_cntfrq;
+}
+
+static inline uint64_t timer_us_to_cycles(uint64_t microseconds) {
+    return microseconds;
+}
+
+static inline void timer_delay_us(uint32_t microseconds) {
+    host_cycles += microseconds;
+}
+
+static inline void timer_cntp_program(uint64_t deadline) {
+    host_cntp_deadline = deadline;
+    host_cntp_armed = 1;
+}
+
+static inline void timer_cntp_stop(void) {
+    host_cntp_armed = 0;
+}
+
+static inline void irq_enable(void) {
+}
+
+static inline void irq_disable(void) {
+}
+
+static inline uint64_t irq_save(void) {
+    return 0;
+}
+
+static inline void irq_restore(uint64_t flags) {
+    (void)flags;
+}
+
+static inline int irq_masked(void) {
+    return 0;
+}
+
+static inline void irq_wait(void) {
+}
+
+static inline void cpu_relax(void) {
+}
+
+static inline void cpu_wait_event(void) {
+}
+
+// Checks: a failure is reported and counted, and the test carries on
+#define CHECK(condition) test_host_check((condition), #condition, __FILE__, __LINE__)
+
+void test_host_check(int ok, const char *expression, const char *file, int line);
+
+// Print the tally; the exit status for main()
+int test_host_summary(const char *suite);
+
+#endif
@@ -0,0 +1,261 @@
+/* Init Graph Host Tests */
+
+#include <stdio.h>
+#include "test_host.h"
+#include "init_graph.h"
+
+// Single-core stand-in for the scheduler: the same dependency counting as
+// sched.c, with ready tasks run first in, first out by sched_run_one()
+static sched_task_t *ready[INIT_MAX_NODES];
+static uint32_t ready_head, ready_tail;
+
+static void make_ready(sched_task_t *task) {
+    task->state = SCHED_TASK_READY;
+    ready[ready_tail++ % INIT_MAX_NODES] = task;
+}
+
+void sched_task_init(sched_task_t *task, sched_fn_t fn, void *arg) {
+    task->fn = fn;
+    task->arg = arg;
+    task->result = 0;
+    task->state = SCHED_TASK_IDLE;
+    task->pending = 1;
+    task->dependent_count = 0;
+    task->start_us = 0;
+    task->end_us = 0;
+}
+
+int sched_task_depends_on(sched_task_t *task, sched_task_t *dependency) {
+    if (task == dependency || task->state != SCHED_TASK_IDLE) return -1;
+    if (dependency->state == SCHED_TASK_DONE) return 0;
+    if (dependency->dependent_count >= SCHED_MAX_DEPENDENTS) return -1;
+
+    task->pending++;
+    dependency->dependents[dependency->dependent_count++] = task;
+    return 0;
+}
+
+int sched_submit(sched_task_t *task) {
+    if (task->state != SCHED_TASK_IDLE) return -1;
+
+    task->state = SCHED_TASK_WAITING;
+    if (--task->pending == 0) make_ready(task);
+    return 0;
+}
+
+int sched_task_done(const sched_task_t *task) {
+    return task->state == SCHED_TASK_DONE;
+}
+
+int sched_run_one(void) {
+    if (ready_head == ready_tail) return 0;
+
+    sched_task_t *task = ready[ready_head++ % INIT_MAX_NODES];
+    task->state = SCHED_TASK_RUNNING;
+    task->start_us = host_cycles;
+    task->result = task->fn(task->arg);
+    task->end_us = host_cycles;
+    task->state = SCHED_TASK_DONE;
+
+    for (uint32_t i = 0; i < task->dependent_count; i++) {
+        if (--task->dependents[i]->pending == 0) make_ready(task->dependents[i]);
+    }
+    return 1;
+}
+
+// Node functions log their letter in run order and take 'cost' microseconds
+static char run_log[INIT_MAX_NODES + 1];
+static uint32_t run_len;
+
+static int ran(char tag, int result, uint64_t cost) {
+    run_log[run_len++] = tag;
+    run_log[run_len] = '\0';
+    host_cycles += cost;
+    return result;
+}
+
+static int node_a(void) { return ran('a', 0, 10); }
+static int node_b(void) { return ran('b', 0, 30); }
+static int node_c(void) { return ran('c', 0, 20); }
+static int node_d(void) { return ran('d', 0, 5); }
+static int node_e(void) { return ran('e', 0, 1); }
+static int node_fail(void) { return ran('f', -5, 1); }
+
+static int position(char tag) {
+    for (uint32_t i = 0; i < run_len; i++) {
+        if (run_log[i] == tag) return (int)i;
+    }
+    return -1;
+}
+
+// Phases the engine reported, in order
+static boot_state_t reported[8];
+static uint32_t report_count;
+
+static void report(boot_state_t state) {
+    if (report_count < 8) reported[report_count++] = state;
+}
+
+static void reset(void) {
+    ready_head = ready_tail = 0;
+    run_len = 0;
+    run_log[0] = '\0';
+    report_count = 0;
+    host_cycles = 0;
+}
+
+static void test_dependency_order(void) {
+    init_node_t nodes[] = {
+        { .name = "a", .fn = node_a, .phase = STATE_CORE_DRIVER_INIT },
+        { .name = "b", .fn = node_b, .deps = { "a" }, .phase = STATE_CORE_DRIVER_INIT },
+        { .name = "c", .fn = node_c, .deps = { "a" }, .phase = STATE_BSP_DRIVER_INIT },
+        { .name = "d", .fn = node_d, .deps = { "b", "c" }, .phase = STATE_BSP_DRIVER_INIT },
+    };
+    init_graph_t graph = { .nodes = nodes, .count = 4, .report = report };
+
+    reset();
+    CHECK(init_graph_run(&graph) == 0);
+    CHECK(run_len == 4);
+    CHECK(position('a') == 0);
+    CHECK(position('d') == 3);
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(nodes[i].result == 0);
+    }
+
+    // Phases in declaration order, each once
+    CHECK(report_count == 2);
+    CHECK(reported[0] == STATE_CORE_DRIVER_INIT);
+    CHECK(reported[1] == STATE_BSP_DRIVER_INIT);
+
+    // a, then the longer of b and c, then d
+    CHECK(init_graph_critical_path_us(&graph) == 10 + 30 + 5);
+    CHECK(init_graph_total_us(&graph) == 10 + 30 + 20 + 5);
+    CHECK(init_graph_find(&graph, "c") == &nodes[2]);
+    CHECK(init_graph_find(&graph, "z") == NULL);
+}
+
+static void test_cycles_rejected(void) {
+    init_node_t pair[] = {
+        { .name = "a", .fn = node_a, .deps = { "b" } },
+        { .name = "b", .fn = node_b, .deps = { "a" } },
+    };
+    init_node_t ring[] = {
+        { .name = "e", .fn = node_e },
+        { .name = "a", .fn = node_a, .deps = { "e", "c" } },
+        { .name = "b", .fn = node_b, .deps = { "a" } },
+        { .name = "c", .fn = node_c, .deps = { "b" } },
+    };
+    init_node_t self[] = {
+        { .name = "a", .fn = node_a, .deps = { "a" } },
+    };
+    init_graph_t graph;
+
+    // Rejected before anything is submitted, even the node outside the ring
+    reset();
+    graph = (init_graph_t){ .nodes = pair, .count = 2 };
+    CHECK(init_graph_start(&graph) == -1);
+
+    graph = (init_graph_t){ .nodes = ring, .count = 4 };
+    CHECK(init_graph_start(&graph) == -1);
+
+    graph = (init_graph_t){ .nodes = self, .count = 1 };
+    CHECK(init_graph_start(&graph) == -1);
+
+    CHECK(init_graph_run(&graph) == -1);
+    CHECK(ready_head == ready_tail);
+    CHECK(run_len == 0);
+}
+
+static void test_bad_declarations(void) {
+    init_node_t unknown[] = {
+        { .name = "a", .fn = node_a },
+        { .name = "b", .fn = node_b, .deps = { "typo" } },
+    };
+    init_node_t no_fn[] = {
+        { .name = "a", .fn = node_a },
+        { .name = "b" },
+    };
+    init_graph_t graph;
+
+    reset();
+    graph = (init_graph_t){ .nodes = unknown, .count = 2 };
+    CHECK(init_graph_start(&graph) == -1);
+
+    graph = (init_graph_t){ .nodes = no_fn, .count = 2 };
+    CHECK(init_graph_start(&graph) == -1);
+
+    graph = (init_graph_t){ .nodes = unknown, .count = 0 };
+    CHECK(init_graph_start(&graph) == -1);
+
+    graph = (init_graph_t){ .nodes = unknown, .count = INIT_MAX_NODES + 1 };
+    CHECK(init_graph_start(&graph) == -1);
+
+    CHECK(run_len == 0);
+}
+
+static void test_required_failure_skips(void) {
+    init_node_t nodes[] = {
+        { .name = "f", .fn = node_fail, .phase = STATE_CORE_DRIVER_INIT },
+        { .name = "b", .fn = node_b, .deps = { "f" }, .phase = STATE_CORE_DRIVER_INIT },
+        { .name = "c", .fn = node_c, .deps = { "b" }, .phase = STATE_CORE_DRIVER_INIT },
+        { .name = "e", .fn = node_e, .phase = STATE_CORE_DRIVER_INIT },
+    };
+    init_graph_t graph = { .nodes = nodes, .count = 4, .report = report };
+
+    reset();
+    CHECK(init_graph_run(&graph) == -1);
+
+    // The failure passes down the chain without running it; the
+    // independent node is unaffected
+    CHECK(nodes[0].result == -5);
+    CHECK(nodes[1].result == INIT_SKIPPED);
+    CHECK(nodes[2].result == INIT_SKIPPED);
+    CHECK(nodes[3].result == 0);
+    CHECK(position('b') < 0 && position('c') < 0);
+    CHECK(position('e') >= 0);
+
+    CHECK(report_count == 2);
+    CHECK(reported[report_count - 1] == STATE_FAILURE);
+}
+
+static void test_optional_failure_tolerated(void) {
+    init_node_t nodes[] = {
+        { .name = "f", .fn = node_fail, .flags = INIT_OPTIONAL },
+        { .name = "a", .fn = node_a },
+        { .name = "b", .fn = node_b, .deps = { "a", "f" } },
+    };
+    init_graph_t graph = { .nodes = nodes, .count = 3, .report = report };
+
+    reset();
+    CHECK(init_graph_run(&graph) == 0);
+    CHECK(nodes[0].result == -5);
+    CHECK(nodes[2].result == 0);
+    CHECK(position('b') == 2);
+
+    // Optional, but still a dependency: b waits for it
+    CHECK(position('f') < position('b'));
+    for (uint32_t i = 0; i < report_count; i++) {
+        CHECK(reported[i] != STATE_FAILURE);
+    }
+
+    // Being optional does not let a node run without a required dependency
+    init_node_t chain[] = {
+        { .name = "f", .fn = node_fail },
+        { .name = "a", .fn = node_a, .deps = { "f" }, .flags = INIT_OPTIONAL },
+    };
+    graph = (init_graph_t){ .nodes = chain, .count = 2 };
+
+    reset();
+    CHECK(init_graph_run(&graph) == -1);
+    CHECK(chain[1].result == INIT_SKIPPED);
+}
+
+int main(void) {
+    test_dependency_order();
+    test_cycles_rejected();
+    test_bad_declarations();
+    test_required_failure_skips();
+    test_optional_failure_tolerated();
+
+    return test_host_summary("init_graph");
+}
@@ -0,0 +1,165 @@
+/* Memory Map Host Tests */
+
+#include <stdio.h>
+#include "test_host.h"
+#include "memmap.h"
+
+// The layout the Makefile links in for the image, .noinit and heap symbols
+#define IMAGE_BASE      0x80000
+#define IMAGE_END       0xFF000
+#define NOINIT_BASE     0xFF000
+#define NOINIT_END      0x100000
+#define HEAP_BASE       0x100000
+#define HEAP_END        0x200000
+
+#define RAM_SIZE        0x40000000
+
+// start.S and mailbox.c stand-ins: no firmware DTB, RAM from the mailbox
+uint64_t firmware_dtb;
+static uint32_t mailbox_ram_size = RAM_SIZE;
+
+int mailbox_get_arm_memory(uint32_t *base, uint32_t *size) {
+    *base = 0;
+    *size = mailbox_ram_size;
+    return 0;
+}
+
+static void test_init_layout(void) {
+    const memmap_region_t *region;
+
+    CHECK(memmap_init() == 0);
+    CHECK(memmap_ram_base() == 0);
+    CHECK(memmap_ram_end() == RAM_SIZE);
+
+    // Spin table, image, warm-boot record, heap, in address order
+    CHECK(memmap_count() == 4);
+    region = memmap_get(0);
+    CHECK(region->base == 0 && region->type == MEMMAP_FIRMWARE);
+    CHECK(region->flags & MEMMAP_KEEP);
+    region = memmap_get(1);
+    CHECK(region->base == IMAGE_BASE && region->size == IMAGE_END - IMAGE_BASE);
+    CHECK(region->type == MEMMAP_BOOTLOADER);
+    CHECK(!(region->flags & MEMMAP_KEEP));
+    region = memmap_get(2);
+    CHECK(region->base == NOINIT_BASE && region->size == NOINIT_END - NOINIT_BASE);
+
+    // Kept from the kernel, so the record outlives it
+    CHECK(region->flags & MEMMAP_KEEP);
+    region = memmap_get(3);
+    CHECK(region->base == HEAP_BASE && region->size == HEAP_END - HEAP_BASE);
+    CHECK(memmap_get(4) == NULL);
+}
+
+static void test_init_image_outside_ram(void) {
+    uint64_t base;
+
+    // Nothing may be placed at all if the image itself cannot be reserved
+    mailbox_ram_size = IMAGE_BASE;
+    CHECK(memmap_init() == -1);
+    CHECK(memmap_count() == 0);
+    CHECK(memmap_alloc(0x1000, 0x1000, MEMMAP_SCRATCH, 0, "scratch", &base) == -1);
+    CHECK(memmap_reserve(0x1000, 0x1000, MEMMAP_SCRATCH, 0, "scratch") == -1);
+
+    mailbox_ram_size = RAM_SIZE;
+}
+
+static void test_reserve(void) {
+    memmap_init();
+
+    // Overlaps on either side of an existing region
+    CHECK(memmap_reserve(IMAGE_BASE - 0x1000, 0x2000, MEMMAP_KERNEL, 0, "k") == -1);
+    CHECK(memmap_reserve(HEAP_END - 0x1000, 0x2000, MEMMAP_KERNEL, 0, "k") == -1);
+    CHECK(memmap_reserve(IMAGE_BASE + 0x1000, 0x1000, MEMMAP_KERNEL, 0, "k") == -1);
+    CHECK(memmap_reserve(0, 0x10000000, MEMMAP_KERNEL, 0, "k") == -1);
+
+    // Touching is not overlapping
+    CHECK(memmap_reserve(IMAGE_BASE - 0x1000, 0x1000, MEMMAP_KERNEL, 0, "k") == 0);
+    CHECK(memmap_reserve(HEAP_END, 0x1000, MEMMAP_DTB, 0, "dtb") == 0);
+
+    // Outside RAM, wrapping, empty
+    CHECK(memmap_reserve(RAM_SIZE - 0x1000, 0x2000, MEMMAP_KERNEL, 0, "k") == -1);
+    CHECK(memmap_reserve(RAM_SIZE, 0x1000, MEMMAP_KERNEL, 0, "k") == -1);
+    CHECK(memmap_reserve(~0ULL - 0xFFF, 0x2000, MEMMAP_KERNEL, 0, "k") == -1);
+    CHECK(memmap_reserve(0x400000, 0, MEMMAP_KERNEL, 0, "k") == -1);
+    CHECK(memmap_count() == 6);
+
+    // Sorted by base whatever the insertion order
+    for (uint32_t i = 1; i < memmap_count(); i++) {
+        CHECK(memmap_get(i - 1)->base + memmap_get(i - 1)->size <= memmap_get(i)->base);
+    }
+
+    // The table is fixed size
+    for (uint32_t i = memmap_count(); i < MEMMAP_MAX_REGIONS; i++) {
+        CHECK(memmap_reserve(0x1000000 + i * 0x10000, 0x1000, MEMMAP_SCRATCH, 0, "s") == 0);
+    }
+    CHECK(memmap_reserve(0x2000000, 0x1000, MEMMAP_SCRATCH, 0, "s") == -1);
+}
+
+static void test_alloc(void) {
+    uint64_t base = 0;
+
+    memmap_init();
+
+    // Lowest fit first: the gap above the spin table, filled exactly
+    CHECK(memmap_alloc(0x1000, 0x1000, MEMMAP_SCRATCH, 0, "a", &base) == 0);
+    CHECK(base == 0x1000);
+    CHECK(memmap_alloc(IMAGE_BASE - 0x2000, 0x1000, MEMMAP_SCRATCH, 0, "b", &base) == 0);
+    CHECK(base == 0x2000);
+
+    // Then above the heap, at the requested alignment
+    CHECK(memmap_alloc(0x1000, 0x1000, MEMMAP_SCRATCH, 0, "c", &base) == 0);
+    CHECK(base == HEAP_END);
+    CHECK(memmap_alloc(0x1000, 0x200000, MEMMAP_KERNEL, 0, "d", &base) == 0);
+    CHECK(base == 0x400000);
+
+    // A gap too small for the size is passed over
+    CHECK(memmap_alloc(0x200000, 0x1000, MEMMAP_SCRATCH, 0, "e", &base) == 0);
+    CHECK(base == 0x401000);
+
+    // Bad sizes and alignments, and more than is left
+    CHECK(memmap_alloc(0, 0x1000, MEMMAP_SCRATCH, 0, "x", &base) == -1);
+    CHECK(memmap_alloc(0x1000, 0, MEMMAP_SCRATCH, 0, "x", &base) == -1);
+    CHECK(memmap_alloc(0x1000, 0x3000, MEMMAP_SCRATCH, 0, "x", &base) == -1);
+    CHECK(memmap_alloc(RAM_SIZE, 0x1000, MEMMAP_SCRATCH, 0, "x", &base) == -1);
+
+    // The rest of RAM, to the last byte
+    CHECK(memmap_alloc(RAM_SIZE - 0x601000, 0x1000, MEMMAP_SCRATCH, 0, "f", &base) == 0);
+    CHECK(base == 0x601000);
+    CHECK(memmap_alloc(0x200000, 0x1000, MEMMAP_SCRATCH, 0, "x", &base) == -1);
+
+    // Only the gap passed over above is left
+    CHECK(memmap_alloc(0x1000, 0x1000, MEMMAP_SCRATCH, 0, "g", &base) == 0);
+    CHECK(base == HEAP_END + 0x1000);
+}
+
+static void test_release(void) {
+    uint64_t first = 0, second = 0, again = 0;
+
+    memmap_init();
+    CHECK(memmap_alloc(0x1000, 0x1000, MEMMAP_SCRATCH, 0, "a", &first) == 0);
+    CHECK(memmap_alloc(0x1000, 0x1000, MEMMAP_SCRATCH, 0, "b", &second) == 0);
+    CHECK(memmap_count() == 6);
+
+    // Only a region's own base releases it
+    CHECK(memmap_release(first + 0x800) == -1);
+    CHECK(memmap_release(0x3000000) == -1);
+
+    CHECK(memmap_release(first) == 0);
+    CHECK(memmap_release(first) == -1);
+    CHECK(memmap_count() == 5);
+
+    // The hole is reused
+    CHECK(memmap_alloc(0x1000, 0x1000, MEMMAP_SCRATCH, 0, "c", &again) == 0);
+    CHECK(again == first);
+    CHECK(memmap_get(1)->base == first && memmap_get(2)->base == second);
+}
+
+int main(void) {
+    test_init_layout();
+    test_init_image_outside_ram();
+    test_reserve();
+    test_alloc();
+    test_release();
+
+    return test_host_summary("memmap");
+}
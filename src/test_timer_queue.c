@@ -0,0 +1,285 @@
+/* Timer Queue Host Tests */
+
+#include <stdio.h>
+#include "test_host.h"
+#include "timer_queue.h"
+#include "interrupt.h"
+
+#define TEST_IRQ    30
+
+// Interrupt controller and SMP stand-ins: the queue's handler is kept so
+// the tests can raise the timer interrupt themselves
+static interrupt_handler_t queue_handler;
+static void *queue_context;
+static uint32_t current_core;
+
+uint32_t interrupt_local_irq(uint32_t source) {
+    return source == INTERRUPT_LOCAL_CNTPNS ? TEST_IRQ : INTERRUPT_NONE;
+}
+
+int interrupt_register_handler(uint32_t irq, interrupt_handler_t handler, void *context) {
+    if (irq != TEST_IRQ || queue_handler) return -1;
+    queue_handler = handler;
+    queue_context = context;
+    return 0;
+}
+
+void interrupt_unregister_handler(uint32_t irq) {
+    (void)irq;
+    queue_handler = NULL;
+}
+
+void interrupt_set_priority(uint32_t irq, uint8_t priority) {
+    (void)irq;
+    (void)priority;
+}
+
+void interrupt_enable(uint32_t irq) {
+    (void)irq;
+}
+
+void interrupt_disable(uint32_t irq) {
+    (void)irq;
+}
+
+uint32_t smp_core_id(void) {
+    return current_core;
+}
+
+// Move the clock and take the CNTP interrupt, as the hardware would
+static void fire_at(uint64_t now) {
+    host_cycles = now;
+    queue_handler(queue_context);
+}
+
+// Callbacks append their tag here, in the order they ran
+static char fired_log[64];
+static uint32_t fired_len;
+
+static void log_tag(void *arg) {
+    if (fired_len + 1 < sizeof(fired_log)) {
+        fired_log[fired_len++] = *(const char *)arg;
+        fired_log[fired_len] = '\0';
+    }
+}
+
+static int log_is(const char *expected) {
+    for (uint32_t i = 0; i <= fired_len; i++) {
+        if (fired_log[i] != expected[i]) return 0;
+    }
+    return 1;
+}
+
+static void log_reset(void) {
+    fired_len = 0;
+    fired_log[0] = '\0';
+}
+
+static void setup(void) {
+    host_cycles = 1000;
+    log_reset();
+    CHECK(timer_queue_init() == 0);
+}
+
+static void test_deadline_order(void) {
+    timer_event_t a, b, c;
+
+    setup();
+    timer_event_init(&a, log_tag, "A");
+    timer_event_init(&b, log_tag, "B");
+    timer_event_init(&c, log_tag, "C");
+
+    CHECK(timer_event_schedule(&a, 300) == 0);
+    CHECK(timer_event_schedule(&b, 100) == 0);
+    CHECK(timer_event_schedule(&c, 200) == 0);
+    CHECK(timer_queue_count() == 3);
+
+    // The comparator always holds the earliest deadline
+    CHECK(host_cntp_armed && host_cntp_deadline == 1100);
+
+    fire_at(1150);
+    CHECK(log_is("B"));
+    CHECK(!timer_event_pending(&b) && b.fired == 1);
+    CHECK(host_cntp_armed && host_cntp_deadline == 1200);
+
+    // Everything that is due runs in one interrupt, earliest first
+    fire_at(5000);
+    CHECK(log_is("BCA"));
+    CHECK(timer_queue_count() == 0);
+    CHECK(!host_cntp_armed);
+
+    timer_queue_stop();
+}
+
+static void test_cancel_and_rearm(void) {
+    timer_event_t a, b, c;
+
+    setup();
+    timer_event_init(&a, log_tag, "A");
+    timer_event_init(&b, log_tag, "B");
+    timer_event_init(&c, log_tag, "C");
+
+    timer_event_schedule(&a, 100);
+    timer_event_schedule(&b, 200);
+    timer_event_schedule(&c, 300);
+
+    // Cancelling the earliest moves the comparator on
+    CHECK(timer_event_cancel(&a) == 1);
+    CHECK(timer_event_cancel(&a) == 0);
+    CHECK(!timer_event_pending(&a));
+    CHECK(host_cntp_deadline == 1200);
+
+    // Re-arming a pending event moves it instead of adding it twice
+    CHECK(timer_event_schedule(&b, 400) == 0);
+    CHECK(timer_queue_count() == 2);
+
+    // The comparator may be left early; the interrupt then only re-aims it
+    fire_at(1200);
+    CHECK(log_is(""));
+    CHECK(host_cntp_deadline == 1300);
+
+    fire_at(1350);
+    CHECK(log_is("C"));
+    fire_at(1450);
+    CHECK(log_is("CB"));
+    CHECK(a.fired == 0);
+
+    timer_queue_stop();
+}
+
+static void test_periodic(void) {
+    timer_event_t tick;
+
+    setup();
+    timer_event_init(&tick, log_tag, "T");
+    CHECK(timer_event_schedule_periodic(&tick, 0) != 0);
+    CHECK(timer_event_schedule_periodic(&tick, 100) == 0);
+
+    fire_at(1100);
+    CHECK(tick.fired == 1 && timer_event_pending(&tick));
+    CHECK(host_cntp_deadline == 1200);
+
+    // Missed periods are skipped, not fired as a burst
+    fire_at(1750);
+    CHECK(tick.fired == 2);
+    CHECK(host_cntp_deadline == 1850);
+
+    CHECK(timer_event_cancel(&tick) == 1);
+    CHECK(!host_cntp_armed);
+
+    timer_queue_stop();
+}
+
+static void test_limits(void) {
+    timer_event_t events[TIMER_QUEUE_SIZE + 1];
+    timer_event_t unset;
+
+    setup();
+    for (uint32_t i = 0; i <= TIMER_QUEUE_SIZE; i++) {
+        timer_event_init(&events[i], log_tag, "x");
+    }
+    for (uint32_t i = 0; i < TIMER_QUEUE_SIZE; i++) {
+        CHECK(timer_event_schedule(&events[i], 10 + i) == 0);
+    }
+    CHECK(timer_event_schedule(&events[TIMER_QUEUE_SIZE], 10) != 0);
+    CHECK(!timer_event_pending(&events[TIMER_QUEUE_SIZE]));
+
+    // No callback, or called away from the queue's core
+    timer_event_init(&unset, NULL, NULL);
+    CHECK(timer_event_schedule(&unset, 10) != 0);
+    current_core = 1;
+    CHECK(timer_event_schedule(&events[0], 10) != 0);
+    CHECK(timer_event_cancel(&events[0]) == 0);
+    current_core = 0;
+
+    // Stopping drops everything pending
+    timer_queue_stop();
+    CHECK(!timer_queue_running());
+    CHECK(timer_queue_count() == 0);
+    CHECK(!timer_event_pending(&events[0]));
+    CHECK(timer_event_schedule(&events[0], 10) != 0);
+}
+
+static void test_no_frequency(void) {
+    timer_event_t a;
+
+    // Firmware left CNTFRQ at 0: the queue stays down rather than firing
+    // everything at once, and the timer interrupt is not claimed
+    host_cntfrq = 0;
+    CHECK(timer_queue_init() != 0);
+    CHECK(!timer_queue_running());
+    CHECK(queue_handler == NULL);
+
+    timer_event_init(&a, log_tag, "A");
+    CHECK(timer_event_schedule(&a, 100) != 0);
+    CHECK(!timer_event_pending(&a));
+
+    host_cntfrq = 1000000;
+}
+
+// Deadlines seen by record_deadline, which must never go backwards
+static uint64_t last_deadline;
+static uint32_t out_of_order;
+static uint32_t fired_total;
+
+static void record_deadline(void *arg) {
+    timer_event_t *event = arg;
+
+    if (event->deadline < last_deadline) out_of_order++;
+    last_deadline = event->deadline;
+    fired_total++;
+}
+
+// Mixed inserts, re-arms and cancels from arbitrary heap positions; the
+// heap has to hand the survivors back in deadline order every time
+static void test_heap_stress(void) {
+    timer_event_t events[TIMER_QUEUE_SIZE];
+    uint32_t seed = 12345;
+
+    setup();
+    for (uint32_t round = 0; round < 50; round++) {
+        uint32_t cancelled = 0;
+
+        for (uint32_t i = 0; i < TIMER_QUEUE_SIZE; i++) {
+            timer_event_init(&events[i], record_deadline, &events[i]);
+        }
+        for (uint32_t i = 0; i < TIMER_QUEUE_SIZE; i++) {
+            seed = seed * 1103515245 + 12345;
+            CHECK(timer_event_schedule(&events[i], 1 + (seed >> 16) % 1000) == 0);
+        }
+        for (uint32_t i = 0; i < TIMER_QUEUE_SIZE; i++) {
+            seed = seed * 1103515245 + 12345;
+            uint32_t action = (seed >> 16) % 4;
+
+            if (action == 0) {
+                CHECK(timer_event_cancel(&events[i]) == 1);
+                cancelled++;
+            } else if (action == 1) {
+                CHECK(timer_event_schedule(&events[i], 1 + (seed >> 20) % 1000) == 0);
+            }
+        }
+        CHECK(timer_queue_count() == TIMER_QUEUE_SIZE - cancelled);
+
+        last_deadline = 0;
+        out_of_order = 0;
+        fired_total = 0;
+        fire_at(host_cycles + 2000);
+
+        CHECK(out_of_order == 0);
+        CHECK(fired_total == TIMER_QUEUE_SIZE - cancelled);
+        CHECK(timer_queue_count() == 0);
+    }
+
+    timer_queue_stop();
+}
+
+int main(void) {
+    test_deadline_order();
+    test_cancel_and_rearm();
+    test_periodic();
+    test_limits();
+    test_no_frequency();
+    test_heap_stress();
+
+    return test_host_summary("timer_queue");
+}
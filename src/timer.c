@@ -2,25 +2,31 @@
 
 #include <stdint.h>
 #include "timer.h"
+#include "platform.h"
 
-// BCM2837 System Timer (QEMU raspi3b)
-#define TIMER_BASE 0x3F003000
+// BCM System Timer (platform.h)
+#define TIMER_BASE PLATFORM_TIMER_BASE
 
 #define TIMER_CS  (TIMER_BASE + 0x00)  // Control/Status
 #define TIMER_CLO (TIMER_BASE + 0x04)  // Counter Lower 32 bits
 #define TIMER_CHI (TIMER_BASE + 0x08)  // Counter Higher 32 bits
 
+// cycles -> us as (cycles * us_mult) >> 32, so the hot path is one UMULH
+// instead of a 64-bit divide
+static uint64_t cntfrq;
+static uint64_t us_mult;
+
 static inline uint32_t mmio_read(uint32_t reg) {
-    return *(volatile uint32_t*)reg;
+    return *(volatile uint32_t*)(uintptr_t)reg;
 }
 
-void timer_init(void) {
-    // System timer is always running on Pi, no init needed
-    // Just verify we can read it
-    (void)mmio_read(TIMER_CLO);
+static inline uint64_t read_cntfrq(void) {
+    uint64_t freq;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+    return freq & 0xFFFFFFFF;
 }
 
-uint64_t timer_get_ticks(void) {
+static uint64_t system_timer_read(void) {
     uint32_t hi, lo;
 
     // Read high, then low, then high again to handle rollover
@@ -32,17 +38,61 @@ uint64_t timer_get_ticks(void) {
     return ((uint64_t)hi << 32) | lo;
 }
 
+void timer_init(void) {
+    // The System Timer is always running on Pi; the generic timer needs
+    // CNTFRQ_EL0 from the firmware (armstub) or QEMU to be usable
+    cntfrq = read_cntfrq();
+    us_mult = cntfrq ? (1000000ULL << 32) / cntfrq : 0;
+
+    if (!cntfrq) {
+        (void)mmio_read(TIMER_CLO);
+    }
+}
+
+uint64_t timer_get_ticks(void) {
+    if (us_mult) {
+        return timer_cycles_to_us(timer_read_cycles());
+    }
+    return system_timer_read();
+}
+
+uint64_t timer_get_counter(void) {
+    return timer_get_ticks();
+}
+
+uint64_t timer_get_frequency(void) {
+    return cntfrq;
+}
+
+uint64_t timer_cycles_to_us(uint64_t cycles) {
+    return (uint64_t)(((unsigned __int128)cycles * us_mult) >> 32);
+}
+
+// Split into whole seconds and remainder so nothing overflows 64 bits
+// (CNTFRQ is 32 bits) and no 128-bit divide helper is needed
+uint64_t timer_cycles_to_ns(uint64_t cycles) {
+    if (!cntfrq) return 0;
+    return (cycles / cntfrq) * 1000000000ULL +
+           ((cycles % cntfrq) * 1000000000ULL) / cntfrq;
+}
+
+uint64_t timer_us_to_cycles(uint64_t microseconds) {
+    return (microseconds / 1000000ULL) * cntfrq +
+           ((microseconds % 1000000ULL) * cntfrq) / 1000000ULL;
+}
+
 void timer_delay_us(uint32_t microseconds) {
-    uint64_t start = timer_get_ticks();
-    uint64_t end = start + microseconds;
-
-    // Handle 64-bit rollover (very unlikely but safe)
-    if (end < start) {
-        while (timer_get_ticks() >= start);  // Wait for rollover
-        while (timer_get_ticks() < end);     // Wait for target
-    } else {
-        while (timer_get_ticks() < end);     // Normal case
+    if (us_mult) {
+        // 64-bit counter: no rollover in practice, and the subtraction
+        // form stays correct even if it did
+        uint64_t start = timer_read_cycles();
+        uint64_t wait = timer_us_to_cycles(microseconds);
+        while (timer_read_cycles() - start < wait);
+        return;
     }
+
+    uint64_t start = system_timer_read();
+    while (system_timer_read() - start < microseconds);
 }
 
 void timer_delay_ms(uint32_t milliseconds) {
@@ -6,8 +6,42 @@
 #include <stdint.h>
 
 void timer_init(void);
+
+// Microseconds since power-on. Backed by the ARM generic timer when the
+// firmware has programmed CNTFRQ_EL0, else by the MMIO System Timer
 uint64_t timer_get_ticks(void);
+uint64_t timer_get_counter(void);       // Same as timer_get_ticks()
+
 void timer_delay_us(uint32_t microseconds);
 void timer_delay_ms(uint32_t milliseconds);
 
+// Generic timer (CNTPCT_EL0) - raw cycles for cheap instrumentation
+uint64_t timer_get_frequency(void);     // CNTFRQ_EL0 in Hz, 0 if unset
+uint64_t timer_cycles_to_us(uint64_t cycles);
+uint64_t timer_cycles_to_ns(uint64_t cycles);
+uint64_t timer_us_to_cycles(uint64_t microseconds);
+
+// ISB keeps the read from being hoisted above earlier instructions
+static inline uint64_t timer_read_cycles(void) {
+    uint64_t cycles;
+    __asm__ volatile("isb\n\tmrs %0, cntpct_el0" : "=r"(cycles) : : "memory");
+    return cycles;
+}
+
+#define TIMER_CNTP_ENABLE   (1 << 0)
+#define TIMER_CNTP_IMASK    (1 << 1)
+
+// Physical timer comparator (CNTP): interrupt once CNTPCT_EL0 reaches
+// 'deadline', or mask it
+static inline void timer_cntp_program(uint64_t deadline) {
+    __asm__ volatile("msr cntp_cval_el0, %0" : : "r"(deadline));
+    __asm__ volatile("msr cntp_ctl_el0, %0" : : "r"((uint64_t)TIMER_CNTP_ENABLE));
+    __asm__ volatile("isb");
+}
+
+static inline void timer_cntp_stop(void) {
+    __asm__ volatile("msr cntp_ctl_el0, %0" : : "r"((uint64_t)TIMER_CNTP_IMASK));
+    __asm__ volatile("isb");
+}
+
 #endif
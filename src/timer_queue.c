@@ -0,0 +1,257 @@
+/* Deadline-Ordered Software Timer Queue */
+
+#include <stdint.h>
+#include "timer_queue.h"
+#include "timer.h"
+#include "interrupt.h"
+#include "exception.h"
+#include "smp.h"
+#include "initcall.h"
+#include "perfmon.h"
+
+#ifndef NULL
+#define NULL ((void *)0)
+#endif
+
+// Binary min-heap on deadline; every event records its own index so cancel
+// and re-arm are O(log n) without a search
+static timer_event_t *heap[TIMER_QUEUE_SIZE];
+static uint32_t heap_count;
+static uint32_t owner_core;
+static uint32_t queue_irq = INTERRUPT_NONE;
+
+static void heap_set(uint32_t index, timer_event_t *event) {
+    heap[index] = event;
+    event->slot = (int32_t)index;
+}
+
+static void sift_up(uint32_t index) {
+    timer_event_t *event = heap[index];
+
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (heap[parent]->deadline <= event->deadline) break;
+        heap_set(index, heap[parent]);
+        index = parent;
+    }
+    heap_set(index, event);
+}
+
+static void sift_down(uint32_t index) {
+    timer_event_t *event = heap[index];
+
+    while (1) {
+        uint32_t child = index * 2 + 1;
+        if (child >= heap_count) break;
+        if (child + 1 < heap_count && heap[child + 1]->deadline < heap[child]->deadline) {
+            child++;
+        }
+        if (event->deadline <= heap[child]->deadline) break;
+        heap_set(index, heap[child]);
+        index = child;
+    }
+    heap_set(index, event);
+}
+
+static int heap_insert(timer_event_t *event) {
+    if (heap_count >= TIMER_QUEUE_SIZE) return -1;
+    heap_set(heap_count, event);
+    sift_up(heap_count++);
+    return 0;
+}
+
+static void heap_remove(timer_event_t *event) {
+    uint32_t index = (uint32_t)event->slot;
+    timer_event_t *last = heap[--heap_count];
+
+    event->slot = -1;
+    if (index == heap_count) return;
+
+    heap_set(index, last);
+    if (index > 0 && heap[(index - 1) / 2]->deadline > last->deadline) {
+        sift_up(index);
+    } else {
+        sift_down(index);
+    }
+}
+
+// One hardware comparator serves the whole queue: always the earliest deadline
+static void reprogram(void) {
+    if (heap_count) {
+        timer_cntp_program(heap[0]->deadline);
+    } else {
+        timer_cntp_stop();
+    }
+}
+
+static void timer_queue_irq(void *context) {
+    (void)context;
+
+    uint64_t flags = irq_save();
+    uint64_t now = timer_read_cycles();
+
+    while (heap_count && heap[0]->deadline <= now) {
+        timer_event_t *event = heap[0];
+        heap_remove(event);
+
+        if (event->period) {
+            // Skip missed periods rather than firing a burst to catch up
+            event->deadline += event->period;
+            if (event->deadline <= now) {
+                event->deadline = now + event->period;
+            }
+            heap_insert(event);
+        }
+
+        // Callbacks may schedule or cancel, including themselves
+        event->fired++;
+        irq_restore(flags);
+        event->fn(event->arg);
+        flags = irq_save();
+        now = timer_read_cycles();
+    }
+
+    reprogram();
+    irq_restore(flags);
+}
+
+int timer_queue_init(void) {
+    heap_count = 0;
+    owner_core = smp_core_id();
+    timer_cntp_stop();
+
+    // Delays would all convert to zero cycles and fire at once
+    if (!timer_get_frequency()) return -1;
+
+    queue_irq = interrupt_local_irq(INTERRUPT_LOCAL_CNTPNS);
+    if (queue_irq == INTERRUPT_NONE) return -1;
+
+    if (interrupt_register_handler(queue_irq, timer_queue_irq, NULL) != 0) {
+        queue_irq = INTERRUPT_NONE;
+        return -1;
+    }
+    interrupt_set_priority(queue_irq, INTERRUPT_PRIORITY_HIGH);
+    interrupt_enable(queue_irq);
+
+    return 0;
+}
+subsys_initcall(timer_queue_init);
+
+void timer_queue_stop(void) {
+    if (queue_irq == INTERRUPT_NONE) return;
+
+    timer_cntp_stop();
+    interrupt_disable(queue_irq);
+    interrupt_unregister_handler(queue_irq);
+    queue_irq = INTERRUPT_NONE;
+
+    for (uint32_t i = 0; i < heap_count; i++) {
+        heap[i]->slot = -1;
+    }
+    heap_count = 0;
+}
+
+int timer_queue_running(void) {
+    return queue_irq != INTERRUPT_NONE;
+}
+
+void timer_event_init(timer_event_t *event, timer_event_fn_t fn, void *arg) {
+    if (!event) return;
+
+    event->fn = fn;
+    event->arg = arg;
+    event->deadline = 0;
+    event->period = 0;
+    event->slot = -1;
+    event->fired = 0;
+}
+
+static int arm_event(timer_event_t *event, uint64_t delay_us, uint64_t period_us) {
+    if (!event || !event->fn) return -1;
+    if (queue_irq == INTERRUPT_NONE || smp_core_id() != owner_core) return -1;
+
+    uint64_t flags = irq_save();
+
+    if (event->slot >= 0) {
+        heap_remove(event);
+    }
+
+    event->deadline = timer_read_cycles() + timer_us_to_cycles(delay_us);
+    event->period = timer_us_to_cycles(period_us);
+
+    int result = heap_insert(event);
+    if (result == 0 && heap[0] == event) {
+        reprogram();
+    }
+
+    irq_restore(flags);
+    return result;
+}
+
+int timer_event_schedule(timer_event_t *event, uint64_t delay_us) {
+    return arm_event(event, delay_us, 0);
+}
+
+int timer_event_schedule_periodic(timer_event_t *event, uint64_t period_us) {
+    if (period_us == 0) return -1;
+    return arm_event(event, period_us, period_us);
+}
+
+int timer_event_cancel(timer_event_t *event) {
+    if (!event || smp_core_id() != owner_core) return 0;
+
+    uint64_t flags = irq_save();
+    int was_pending = event->slot >= 0;
+
+    if (was_pending) {
+        int was_first = heap[0] == event;
+        heap_remove(event);
+        if (was_first) reprogram();
+    }
+
+    irq_restore(flags);
+    return was_pending;
+}
+
+int timer_event_pending(const timer_event_t *event) {
+    return event && event->slot >= 0;
+}
+
+static void wake_flag(void *arg) {
+    *(volatile uint32_t *)arg = 1;
+}
+
+void timer_queue_sleep_us(uint64_t microseconds) {
+    volatile uint32_t woken = 0;
+    timer_event_t event;
+
+    if (queue_irq == INTERRUPT_NONE || irq_masked() || smp_core_id() != owner_core) {
+        timer_delay_us((uint32_t)microseconds);
+        return;
+    }
+
+    timer_event_init(&event, wake_flag, (void *)&woken);
+    if (timer_event_schedule(&event, microseconds) != 0) {
+        timer_delay_us((uint32_t)microseconds);
+        return;
+    }
+
+    // Check with IRQs masked so the wakeup can't slip in between the test
+    // and the WFI; a pending IRQ still ends the WFI and is taken on unmask
+    while (1) {
+        irq_disable();
+        if (woken) break;
+        irq_wait();
+        irq_enable();
+    }
+    irq_enable();
+}
+
+uint32_t timer_queue_count(void) {
+    return heap_count;
+}
+
+static uint64_t sample_pending(void) {
+    return timer_queue_count();
+}
+PERFMON_PROBE(timer_queue_probe, "Timer events", "pending", sample_pending);
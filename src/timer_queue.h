@@ -0,0 +1,51 @@
+/* Deadline-Ordered Software Timer Queue */
+
+#ifndef TIMER_QUEUE_H
+#define TIMER_QUEUE_H
+
+#include <stdint.h>
+
+#define TIMER_QUEUE_SIZE    32      // Events that may be pending at once
+
+typedef void (*timer_event_fn_t)(void *arg);
+
+// Event - owned by the caller, must stay valid while pending
+typedef struct {
+    timer_event_fn_t fn;
+    void *arg;
+    uint64_t deadline;              // CNTPCT_EL0 cycles
+    uint64_t period;                // Cycles between firings, 0 for one-shot
+    int32_t slot;                   // Heap index, -1 when not pending
+    uint32_t fired;                 // Times the callback has run
+} timer_event_t;
+
+// Take over the calling core's physical timer (CNTP) interrupt. The queue
+// is serviced on that core and callbacks run there in IRQ context; call
+// after interrupt_init(). Registered as a subsystem initcall. Fails, and
+// callers fall back to spinning, if CNTFRQ was never set: every deadline
+// would then be 'now'
+int timer_queue_init(void);
+int timer_queue_running(void);
+
+// Give the physical timer back (pending events are dropped); boot core
+void timer_queue_stop(void);
+
+// Prepare an event (not pending)
+void timer_event_init(timer_event_t *event, timer_event_fn_t fn, void *arg);
+
+// Arm an event. Re-arming a pending event moves its deadline. Must be
+// called on the queue's core (callbacks qualify)
+int timer_event_schedule(timer_event_t *event, uint64_t delay_us);
+int timer_event_schedule_periodic(timer_event_t *event, uint64_t period_us);
+
+// Disarm; returns 1 if the event was pending
+int timer_event_cancel(timer_event_t *event);
+int timer_event_pending(const timer_event_t *event);
+
+// Wait on the queue instead of spinning; falls back to timer_delay_us()
+// when the queue is not running or IRQs are masked
+void timer_queue_sleep_us(uint64_t microseconds);
+
+uint32_t timer_queue_count(void);
+
+#endif
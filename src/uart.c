@@ -2,9 +2,10 @@
 
 #include <stdint.h>
 #include "uart.h"
+#include "platform.h"
 
-// Hardcoded for QEMU raspi3b (BCM2837)
-#define UART_BASE 0x3F201000
+// PL011: BCM2837 UART0, or the virt board's (platform.h)
+#define UART_BASE PLATFORM_UART_BASE
 
 #define UART_DR     (UART_BASE + 0x00)
 #define UART_FR     (UART_BASE + 0x18)
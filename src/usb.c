@@ -2,6 +2,8 @@
 
 #include "usb.h"
 #include "timer.h"
+#include "driver.h"
+#include "boot_source.h"
 
 #ifndef NULL
 #define NULL ((void *)0)
@@ -60,6 +62,13 @@ void usb_init(void) {
     usb_start_controller();
 }
 
+static int usb_driver_init(void) {
+    usb_init();
+    return 0;
+}
+
+DRIVER_DEFINE(usb_driver, "usb", usb_driver_init, BOOT_PATH_USB | BOOT_PATH_DIAG);
+
 int usb_reset_controller(void) {
     // Issue host controller reset
     mmio_write(USB_USBCMD, USB_CMD_HCRST);
@@ -392,10 +401,10 @@ int usb_msc_get_capacity(uint8_t address, uint32_t *sectors, uint32_t *sector_si
 
 // USB boot functions
 int usb_boot_init(void) {
-    usb_init();
+    if (driver_require(&usb_driver) != 0) return -1;
 
-    // Enumerate devices on both ports
-    for (uint8_t port = 1; port <= 2; port++) {
+    // Enumerate devices on both ports, unless another boot source won
+    for (uint8_t port = 1; port <= 2 && !boot_source_probe_cancelled(); port++) {
         int address = usb_enumerate_device(port);
         if (address > 0) {
             usb_device_t *device = &usb_devices[address];
@@ -414,4 +423,31 @@ int usb_boot_load_file(const char *filename, void *buffer, uint32_t max_size) {
     // For bootloader, we'll simulate loading from USB
     // In a real implementation, this would parse FAT filesystem on USB drive
     return -1; // Not implemented for simulation
-}
\ No newline at end of file
+}
+
+// Boot source: probed alongside the others (boot_source_probe_start), so a
+// missing stick costs only its own enumeration time
+#define USB_BOOT_MAX_FILE   0x04000000
+
+static int usb_boot_device;            // Mass-storage address, 0 until found
+
+static int usb_source_probe(void) {
+    if (usb_boot_device > 0) return 0;
+
+    int address = usb_boot_init();
+    if (address <= 0) return -1;
+
+    usb_boot_device = address;
+    return 0;
+}
+
+static int usb_source_load(const char *filename, uint32_t load_addr, uint32_t *size) {
+    int read = usb_boot_load_file(filename, (void *)(uintptr_t)load_addr, USB_BOOT_MAX_FILE);
+    if (read < 0) return -1;
+
+    *size = read;
+    return 0;
+}
+
+BOOT_SOURCE(usb_source, "usb", BOOT_PATH_USB | BOOT_PATH_DIAG, 20, usb_source_probe,
+            usb_source_load, NULL, NULL);
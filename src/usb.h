@@ -4,6 +4,7 @@
 #define USB_H
 
 #include <stdint.h>
+#include "driver.h"
 
 // USB xHCI Controller registers (Pi 4)
 #define USB_BASE 0xFE9C0000
@@ -228,4 +229,7 @@ int usb_msc_get_capacity(uint8_t address, uint32_t *sectors, uint32_t *sector_si
 int usb_boot_init(void);
 int usb_boot_load_file(const char *filename, void *buffer, uint32_t max_size);
 
+// Lazy driver descriptor (see driver.h)
+extern driver_t usb_driver;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,216 @@
+/* virtio-mmio Transport and Split Virtqueues */
+
+#include <stdint.h>
+#include "virtio.h"
+#include "platform.h"
+
+static inline void mmio_write(uintptr_t reg, uint32_t data) {
+    *(volatile uint32_t*)reg = data;
+}
+
+static inline uint32_t mmio_read(uintptr_t reg) {
+    return *(volatile uint32_t*)reg;
+}
+
+// Ring updates must be visible before the index that publishes them, and
+// the index before the notify
+static inline void wmb(void) {
+    __asm__ volatile("dmb ishst" : : : "memory");
+}
+
+static inline void rmb(void) {
+    __asm__ volatile("dmb ishld" : : : "memory");
+}
+
+static inline void mb(void) {
+    __asm__ volatile("dsb sy" : : : "memory");
+}
+
+static void clear_bytes(void *dest, uint32_t n) {
+    uint8_t *d = dest;
+    while (n--) *d++ = 0;
+}
+
+int virtio_find(uint32_t device_id, int start, virtio_device_t *dev) {
+    for (int slot = start + 1; slot < PLATFORM_VIRTIO_SLOTS; slot++) {
+        uintptr_t base = PLATFORM_VIRTIO_BASE + (uintptr_t)slot * PLATFORM_VIRTIO_STRIDE;
+        uint32_t version = mmio_read(base + VIRTIO_MMIO_VERSION);
+
+        if (mmio_read(base + VIRTIO_MMIO_MAGIC) != VIRTIO_MMIO_MAGIC_VALUE) continue;
+        if (version != 1 && version != 2) continue;
+        if (mmio_read(base + VIRTIO_MMIO_DEVICE_ID) != device_id) continue;
+
+        dev->base = base;
+        dev->version = version;
+        dev->device_id = device_id;
+        return slot;
+    }
+    return -1;
+}
+
+int virtio_begin(virtio_device_t *dev, uint64_t wanted, uint64_t *accepted) {
+    uintptr_t base = dev->base;
+
+    mmio_write(base + VIRTIO_MMIO_STATUS, 0);
+    mmio_write(base + VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE);
+    mmio_write(base + VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER);
+
+    mmio_write(base + VIRTIO_MMIO_DEVICE_FEATURES_SEL, 0);
+    uint64_t offered = mmio_read(base + VIRTIO_MMIO_DEVICE_FEATURES);
+    mmio_write(base + VIRTIO_MMIO_DEVICE_FEATURES_SEL, 1);
+    offered |= (uint64_t)mmio_read(base + VIRTIO_MMIO_DEVICE_FEATURES) << 32;
+
+    // A modern transport must agree on VERSION_1
+    if (dev->version == 2) wanted |= VIRTIO_F_VERSION_1;
+    uint64_t features = offered & wanted;
+    if (dev->version == 2 && !(features & VIRTIO_F_VERSION_1)) goto fail;
+
+    mmio_write(base + VIRTIO_MMIO_DRIVER_FEATURES_SEL, 0);
+    mmio_write(base + VIRTIO_MMIO_DRIVER_FEATURES, (uint32_t)features);
+    mmio_write(base + VIRTIO_MMIO_DRIVER_FEATURES_SEL, 1);
+    mmio_write(base + VIRTIO_MMIO_DRIVER_FEATURES, (uint32_t)(features >> 32));
+
+    if (dev->version == 2) {
+        mmio_write(base + VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER |
+                                              VIRTIO_STATUS_FEATURES_OK);
+        if (!(mmio_read(base + VIRTIO_MMIO_STATUS) & VIRTIO_STATUS_FEATURES_OK)) goto fail;
+    } else {
+        mmio_write(base + VIRTIO_MMIO_GUEST_PAGE_SIZE, VIRTQ_PAGE);
+    }
+
+    *accepted = features;
+    return 0;
+
+fail:
+    mmio_write(base + VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+    return -1;
+}
+
+int virtio_queue_setup(virtio_device_t *dev, virtqueue_t *vq, uint32_t index,
+                       virtq_ring_t *ring) {
+    uintptr_t base = dev->base;
+
+    mmio_write(base + VIRTIO_MMIO_QUEUE_SEL, index);
+
+    uint32_t max = mmio_read(base + VIRTIO_MMIO_QUEUE_NUM_MAX);
+    if (max == 0) return -1;
+    if (dev->version == 2 && mmio_read(base + VIRTIO_MMIO_QUEUE_READY)) return -1;
+
+    // Legacy rings are laid out for exactly this size, modern ones would
+    // allow less but never need it
+    if (max < VIRTQ_SIZE) return -1;
+
+    clear_bytes(ring, sizeof(*ring));
+    for (uint16_t i = 0; i < VIRTQ_SIZE; i++) {
+        ring->desc[i].next = (uint16_t)(i + 1);
+    }
+
+    vq->ring = ring;
+    vq->index = index;
+    vq->size = VIRTQ_SIZE;
+    vq->free_head = 0;
+    vq->num_free = VIRTQ_SIZE;
+    vq->avail_idx = 0;
+    vq->last_used = 0;
+
+    mmio_write(base + VIRTIO_MMIO_QUEUE_NUM, VIRTQ_SIZE);
+
+    if (dev->version == 2) {
+        uint64_t desc = (uintptr_t)ring->desc;
+        uint64_t avail = (uintptr_t)&ring->avail;
+        uint64_t used = (uintptr_t)&ring->used;
+
+        mmio_write(base + VIRTIO_MMIO_QUEUE_DESC_LOW, (uint32_t)desc);
+        mmio_write(base + VIRTIO_MMIO_QUEUE_DESC_HIGH, (uint32_t)(desc >> 32));
+        mmio_write(base + VIRTIO_MMIO_QUEUE_AVAIL_LOW, (uint32_t)avail);
+        mmio_write(base + VIRTIO_MMIO_QUEUE_AVAIL_HIGH, (uint32_t)(avail >> 32));
+        mmio_write(base + VIRTIO_MMIO_QUEUE_USED_LOW, (uint32_t)used);
+        mmio_write(base + VIRTIO_MMIO_QUEUE_USED_HIGH, (uint32_t)(used >> 32));
+        mmio_write(base + VIRTIO_MMIO_QUEUE_READY, 1);
+    } else {
+        mmio_write(base + VIRTIO_MMIO_QUEUE_ALIGN, VIRTQ_PAGE);
+        mmio_write(base + VIRTIO_MMIO_QUEUE_PFN, (uint32_t)((uintptr_t)ring / VIRTQ_PAGE));
+    }
+
+    return 0;
+}
+
+void virtio_driver_ok(virtio_device_t *dev) {
+    uint32_t status = mmio_read(dev->base + VIRTIO_MMIO_STATUS);
+    mmio_write(dev->base + VIRTIO_MMIO_STATUS, status | VIRTIO_STATUS_DRIVER_OK);
+}
+
+uint8_t virtio_config_read8(const virtio_device_t *dev, uint32_t offset) {
+    return *(volatile uint8_t*)(dev->base + VIRTIO_MMIO_CONFIG + offset);
+}
+
+uint32_t virtio_config_read32(const virtio_device_t *dev, uint32_t offset) {
+    return mmio_read(dev->base + VIRTIO_MMIO_CONFIG + offset);
+}
+
+// Two halves; the generation counter is not worth it for values read once
+uint64_t virtio_config_read64(const virtio_device_t *dev, uint32_t offset) {
+    return virtio_config_read32(dev, offset) |
+           ((uint64_t)virtio_config_read32(dev, offset + 4) << 32);
+}
+
+void virtio_config_write8(const virtio_device_t *dev, uint32_t offset, uint8_t value) {
+    *(volatile uint8_t*)(dev->base + VIRTIO_MMIO_CONFIG + offset) = value;
+}
+
+int virtq_add(virtqueue_t *vq, const virtq_buf_t *bufs, uint32_t count) {
+    if (count == 0 || count > vq->num_free) return -1;
+
+    virtq_desc_t *desc = vq->ring->desc;
+    uint16_t head = vq->free_head;
+    uint16_t i = head;
+
+    for (uint32_t n = 0; n < count; n++) {
+        desc[i].addr = (uintptr_t)bufs[n].addr;
+        desc[i].len = bufs[n].len;
+        desc[i].flags = (bufs[n].write ? VIRTQ_DESC_F_WRITE : 0) |
+                        (n + 1 < count ? VIRTQ_DESC_F_NEXT : 0);
+        if (n + 1 < count) i = desc[i].next;
+    }
+
+    // The chain's last 'next' still links the free list on
+    vq->free_head = desc[i].next;
+    vq->num_free -= count;
+
+    vq->ring->avail.ring[vq->avail_idx % vq->size] = head;
+    vq->avail_idx++;
+    return head;
+}
+
+void virtq_kick(virtio_device_t *dev, virtqueue_t *vq) {
+    if (vq->ring->avail.idx == vq->avail_idx) return;
+
+    wmb();
+    vq->ring->avail.idx = vq->avail_idx;
+    mb();
+    mmio_write(dev->base + VIRTIO_MMIO_QUEUE_NOTIFY, vq->index);
+}
+
+int virtq_get_used(virtqueue_t *vq, uint16_t *head, uint32_t *len) {
+    if (*(volatile uint16_t*)&vq->ring->used.idx == vq->last_used) return -1;
+    rmb();
+
+    const virtq_used_elem_t *elem = &vq->ring->used.ring[vq->last_used % vq->size];
+    uint16_t id = (uint16_t)elem->id;
+    *head = id;
+    *len = elem->len;
+    vq->last_used++;
+
+    // Return the chain to the free list
+    virtq_desc_t *desc = vq->ring->desc;
+    uint16_t i = id;
+    uint16_t count = 1;
+    while (desc[i].flags & VIRTQ_DESC_F_NEXT) {
+        i = desc[i].next;
+        count++;
+    }
+    desc[i].next = vq->free_head;
+    vq->free_head = id;
+    vq->num_free += count;
+    return 0;
+}
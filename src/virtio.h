@@ -0,0 +1,160 @@
+/* virtio-mmio Transport and Split Virtqueues */
+
+#ifndef VIRTIO_H
+#define VIRTIO_H
+
+#include <stdint.h>
+
+/*
+ * virtio 1.x over MMIO, as QEMU's virt board provides it: a row of
+ * register slots (platform.h), each empty or holding one device. Both
+ * transport versions are driven: legacy (1, QEMU's default) places a
+ * queue by page frame number, modern (2, virtio-mmio.force-legacy=false)
+ * by the three ring addresses. Queues live in one page-aligned block
+ * laid out the legacy way, so either works.
+ *
+ * Requests are batched: virtq_add() only fills descriptors and the
+ * available ring, and virtq_kick() publishes everything added since the
+ * last kick with one barrier and one notify. The device runs the whole
+ * batch before the driver polls the used ring. The hypervisor reads guest
+ * memory directly, so there is no cache maintenance, only ordering.
+ */
+
+// Register offsets
+#define VIRTIO_MMIO_MAGIC               0x000   // "virt"
+#define VIRTIO_MMIO_VERSION             0x004   // 1 legacy, 2 modern
+#define VIRTIO_MMIO_DEVICE_ID           0x008   // 0 for an empty slot
+#define VIRTIO_MMIO_DEVICE_FEATURES     0x010
+#define VIRTIO_MMIO_DEVICE_FEATURES_SEL 0x014
+#define VIRTIO_MMIO_DRIVER_FEATURES     0x020
+#define VIRTIO_MMIO_DRIVER_FEATURES_SEL 0x024
+#define VIRTIO_MMIO_GUEST_PAGE_SIZE     0x028   // Legacy
+#define VIRTIO_MMIO_QUEUE_SEL           0x030
+#define VIRTIO_MMIO_QUEUE_NUM_MAX       0x034
+#define VIRTIO_MMIO_QUEUE_NUM           0x038
+#define VIRTIO_MMIO_QUEUE_ALIGN         0x03C   // Legacy
+#define VIRTIO_MMIO_QUEUE_PFN           0x040   // Legacy
+#define VIRTIO_MMIO_QUEUE_READY         0x044   // Modern
+#define VIRTIO_MMIO_QUEUE_NOTIFY        0x050
+#define VIRTIO_MMIO_STATUS              0x070
+#define VIRTIO_MMIO_QUEUE_DESC_LOW      0x080   // Modern, from here
+#define VIRTIO_MMIO_QUEUE_DESC_HIGH     0x084
+#define VIRTIO_MMIO_QUEUE_AVAIL_LOW     0x090
+#define VIRTIO_MMIO_QUEUE_AVAIL_HIGH    0x094
+#define VIRTIO_MMIO_QUEUE_USED_LOW      0x0A0
+#define VIRTIO_MMIO_QUEUE_USED_HIGH     0x0A4
+#define VIRTIO_MMIO_CONFIG              0x100   // Device-specific
+
+#define VIRTIO_MMIO_MAGIC_VALUE         0x74726976
+
+// Device IDs
+#define VIRTIO_ID_NET                   1
+#define VIRTIO_ID_BLOCK                 2
+
+// Device status
+#define VIRTIO_STATUS_ACKNOWLEDGE       (1 << 0)
+#define VIRTIO_STATUS_DRIVER            (1 << 1)
+#define VIRTIO_STATUS_DRIVER_OK         (1 << 2)
+#define VIRTIO_STATUS_FEATURES_OK       (1 << 3)
+#define VIRTIO_STATUS_FAILED            (1 << 7)
+
+// Transport features
+#define VIRTIO_F_ANY_LAYOUT             (1ULL << 27)
+#define VIRTIO_F_VERSION_1              (1ULL << 32)
+
+#define VIRTQ_DESC_F_NEXT               1
+#define VIRTQ_DESC_F_WRITE              2       // Device writes this buffer
+
+#define VIRTQ_SIZE                      64      // Descriptors per queue
+#define VIRTQ_PAGE                      4096    // Legacy alignment of the used ring
+
+typedef struct {
+    uint64_t addr;
+    uint32_t len;
+    uint16_t flags;
+    uint16_t next;
+} virtq_desc_t;
+
+typedef struct {
+    uint16_t flags;
+    uint16_t idx;
+    uint16_t ring[VIRTQ_SIZE];
+    uint16_t used_event;
+} virtq_avail_t;
+
+typedef struct {
+    uint32_t id;                    // Head descriptor of the chain
+    uint32_t len;                   // Bytes the device wrote
+} virtq_used_elem_t;
+
+typedef struct {
+    uint16_t flags;
+    uint16_t idx;
+    virtq_used_elem_t ring[VIRTQ_SIZE];
+    uint16_t avail_event;
+} virtq_used_t;
+
+// Legacy layout: descriptors and available ring, used ring on the next page
+typedef struct {
+    virtq_desc_t desc[VIRTQ_SIZE];
+    virtq_avail_t avail;
+    uint8_t pad[VIRTQ_PAGE - sizeof(virtq_desc_t) * VIRTQ_SIZE - sizeof(virtq_avail_t)];
+    virtq_used_t used;
+} __attribute__((aligned(VIRTQ_PAGE))) virtq_ring_t;
+
+typedef struct {
+    uintptr_t base;                 // Register slot
+    uint32_t version;
+    uint32_t device_id;
+} virtio_device_t;
+
+typedef struct {
+    virtq_ring_t *ring;
+    uint32_t index;                 // Queue number on the device
+    uint16_t size;                  // Descriptors in use (<= VIRTQ_SIZE)
+    uint16_t free_head;             // Free descriptors, linked through 'next'
+    uint16_t num_free;
+    uint16_t avail_idx;             // Added so far; published by virtq_kick()
+    uint16_t last_used;             // Used entries already reaped
+} virtqueue_t;
+
+// One buffer of a chain: device-readable (out) or device-writable (in)
+typedef struct {
+    void *addr;
+    uint32_t len;
+    uint32_t write;                 // 1 for device-writable
+} virtq_buf_t;
+
+// Next slot holding 'device_id' after 'start' (-1 for the first); fills
+// 'dev' and returns its slot number, or -1 if there is none
+int virtio_find(uint32_t device_id, int start, virtio_device_t *dev);
+
+// Reset and negotiate: offer 'wanted' (VERSION_1 added on modern
+// transports), keep what the device has. 0 and *accepted on success
+int virtio_begin(virtio_device_t *dev, uint64_t wanted, uint64_t *accepted);
+
+// Give queue 'index' its ring (zeroed here). 0 on success
+int virtio_queue_setup(virtio_device_t *dev, virtqueue_t *vq, uint32_t index,
+                       virtq_ring_t *ring);
+
+// Negotiation and queues done: the device may start
+void virtio_driver_ok(virtio_device_t *dev);
+
+// Device-specific configuration space
+uint8_t virtio_config_read8(const virtio_device_t *dev, uint32_t offset);
+uint32_t virtio_config_read32(const virtio_device_t *dev, uint32_t offset);
+uint64_t virtio_config_read64(const virtio_device_t *dev, uint32_t offset);
+void virtio_config_write8(const virtio_device_t *dev, uint32_t offset, uint8_t value);
+
+// Queue a chain of 'count' buffers, not yet visible to the device. Returns
+// the head descriptor, or -1 if the queue has too few free descriptors
+int virtq_add(virtqueue_t *vq, const virtq_buf_t *bufs, uint32_t count);
+
+// Publish everything added since the last kick and notify once
+void virtq_kick(virtio_device_t *dev, virtqueue_t *vq);
+
+// Reap one completed chain: its head and the bytes written, and free its
+// descriptors. 0 if there was one, -1 if the device has not finished any
+int virtq_get_used(virtqueue_t *vq, uint16_t *head, uint32_t *len);
+
+#endif
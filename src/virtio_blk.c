@@ -0,0 +1,122 @@
+/* virtio-blk Boot Disk */
+
+#include <stdint.h>
+#include "sd.h"
+#include "virtio.h"
+#include "timer.h"
+
+/*
+ * The QEMU virt counterpart of emmc.c, behind the same sd.h calls. Each
+ * request is a three-descriptor chain (header, data, status byte); a
+ * multi-sector read fills the queue with as many as fit, kicks once and
+ * waits for the lot, so a kernel read costs a handful of exits instead
+ * of one per sector.
+ */
+
+#define VIRTIO_BLK_T_IN         0
+#define VIRTIO_BLK_T_OUT        1
+
+#define VIRTIO_BLK_S_OK         0
+
+#define BLK_CONFIG_CAPACITY     0       // 512-byte sectors, 64-bit
+
+#define BLK_SECTOR_SIZE         512
+#define BLK_MAX_SECTORS         2048    // 1MB per request
+#define BLK_BATCH               (VIRTQ_SIZE / 3)
+#define BLK_TIMEOUT_US          1000000
+
+typedef struct {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t sector;
+} virtio_blk_req_t;
+
+static virtio_device_t blk_dev;
+static virtqueue_t blk_vq;
+static virtq_ring_t blk_ring;
+static uint64_t blk_capacity;
+static uint8_t blk_ready = 0;
+
+// One header and status byte per request in flight
+static virtio_blk_req_t blk_headers[BLK_BATCH];
+static volatile uint8_t blk_status[BLK_BATCH];
+
+int sd_init(void) {
+    uint64_t features;
+
+    if (virtio_find(VIRTIO_ID_BLOCK, -1, &blk_dev) < 0) return -1;
+    if (virtio_begin(&blk_dev, 0, &features) != 0) return -1;
+    if (virtio_queue_setup(&blk_dev, &blk_vq, 0, &blk_ring) != 0) return -1;
+    virtio_driver_ok(&blk_dev);
+
+    blk_capacity = virtio_config_read64(&blk_dev, BLK_CONFIG_CAPACITY);
+    blk_ready = 1;
+    return 0;
+}
+
+// 'count' sectors at 'sector' in requests of up to BLK_MAX_SECTORS, a
+// queue-full at a time. A batch that times out is abandoned with the
+// device still owning it, so the disk is given up on
+static int blk_transfer(uint32_t type, uint64_t sector, uint32_t count, uint8_t *buffer) {
+    if (!blk_ready) return -1;
+    if (sector + count > blk_capacity) return -1;
+
+    while (count) {
+        uint32_t batch = 0;
+
+        while (count && batch < BLK_BATCH) {
+            uint32_t n = count < BLK_MAX_SECTORS ? count : BLK_MAX_SECTORS;
+            virtq_buf_t bufs[3] = {
+                { &blk_headers[batch], sizeof(virtio_blk_req_t), 0 },
+                { buffer, n * BLK_SECTOR_SIZE, type == VIRTIO_BLK_T_IN },
+                { (void *)&blk_status[batch], 1, 1 },
+            };
+
+            blk_headers[batch].type = type;
+            blk_headers[batch].reserved = 0;
+            blk_headers[batch].sector = sector;
+            blk_status[batch] = 0xFF;
+
+            if (virtq_add(&blk_vq, bufs, 3) < 0) break;
+
+            sector += n;
+            buffer += n * BLK_SECTOR_SIZE;
+            count -= n;
+            batch++;
+        }
+
+        virtq_kick(&blk_dev, &blk_vq);
+
+        uint64_t start = timer_get_ticks();
+        for (uint32_t done = 0; done < batch; ) {
+            uint16_t head;
+            uint32_t len;
+
+            if (virtq_get_used(&blk_vq, &head, &len) == 0) {
+                done++;
+            } else if (timer_get_ticks() - start > BLK_TIMEOUT_US) {
+                blk_ready = 0;
+                return -1;
+            }
+        }
+
+        for (uint32_t i = 0; i < batch; i++) {
+            if (blk_status[i] != VIRTIO_BLK_S_OK) return -1;
+        }
+    }
+
+    return 0;
+}
+
+int sd_read_sector(uint32_t sector, uint8_t *buffer) {
+    return blk_transfer(VIRTIO_BLK_T_IN, sector, 1, buffer);
+}
+
+int sd_read_sectors(uint32_t sector, uint32_t count, uint8_t *buffer) {
+    return blk_transfer(VIRTIO_BLK_T_IN, sector, count, buffer);
+}
+
+int sd_write_sector(uint32_t sector, const uint8_t *buffer) {
+    // Device-readable; the cast only satisfies the shared transfer path
+    return blk_transfer(VIRTIO_BLK_T_OUT, sector, 1, (uint8_t *)buffer);
+}
@@ -0,0 +1,203 @@
+/* virtio-net Ethernet for QEMU virt */
+
+#include <stdint.h>
+#include "ethernet.h"
+#include "virtio.h"
+#include "driver.h"
+
+/*
+ * The ethernet.h frame API over virtio-net, so the network stack runs
+ * unchanged on QEMU virt. Queue 0 receives, queue 1 transmits. Every
+ * frame travels as two descriptors, virtio-net header then frame, which
+ * every device accepts without ANY_LAYOUT. Receive buffers stay posted
+ * and are handed back in batches of half the ring; transmitted buffers
+ * are reclaimed lazily, when the next send needs one.
+ */
+
+#define VIRTIO_NET_F_MAC        (1ULL << 5)
+#define VIRTIO_NET_F_STATUS     (1ULL << 16)
+
+#define NET_CONFIG_MAC          0
+#define NET_CONFIG_STATUS       6
+#define NET_STATUS_LINK_UP      1
+
+#define NET_QUEUE_RX            0
+#define NET_QUEUE_TX            1
+
+// Legacy devices leave out num_buffers unless MRG_RXBUF is negotiated
+#define NET_HDR_LEN_LEGACY      10
+#define NET_HDR_LEN_MODERN      12
+
+#define RX_BUFFERS              16
+#define RX_REFILL_BATCH         (RX_BUFFERS / 2)
+#define TX_BUFFERS              8
+#define NET_BUFFER_SIZE         1536
+
+// Local memcpy for freestanding environment
+static void *memcpy(void *dest, const void *src, uint32_t n) {
+    unsigned char *d = dest;
+    const unsigned char *s = src;
+    while (n--) *d++ = *s++;
+    return dest;
+}
+
+static virtio_device_t net_dev;
+static virtqueue_t rx_vq;
+static virtqueue_t tx_vq;
+static virtq_ring_t rx_ring;
+static virtq_ring_t tx_ring;
+static uint64_t net_features;
+static uint32_t net_hdr_len;
+static uint8_t net_ready = 0;
+static uint8_t net_enabled = 0;
+
+// Headers are only ever zero on transmit; received ones are ignored
+static uint8_t rx_headers[RX_BUFFERS][NET_HDR_LEN_MODERN];
+static uint8_t rx_buffers[RX_BUFFERS][NET_BUFFER_SIZE];
+static uint8_t tx_headers[TX_BUFFERS][NET_HDR_LEN_MODERN];
+static uint8_t tx_buffers[TX_BUFFERS][NET_BUFFER_SIZE];
+
+// Which buffer each chain head carries
+static uint8_t rx_slot[VIRTQ_SIZE];
+static uint8_t tx_slot[VIRTQ_SIZE];
+static uint8_t tx_busy[TX_BUFFERS];
+static uint32_t rx_pending = 0;     // Reposted but not yet kicked
+
+static int rx_post(uint32_t slot) {
+    virtq_buf_t bufs[2] = {
+        { rx_headers[slot], net_hdr_len, 1 },
+        { rx_buffers[slot], NET_BUFFER_SIZE, 1 },
+    };
+    int head = virtq_add(&rx_vq, bufs, 2);
+
+    if (head < 0) return -1;
+    rx_slot[head] = (uint8_t)slot;
+    return 0;
+}
+
+static int virtio_net_init(void) {
+    if (virtio_find(VIRTIO_ID_NET, -1, &net_dev) < 0) return -1;
+    if (virtio_begin(&net_dev, VIRTIO_NET_F_MAC | VIRTIO_NET_F_STATUS, &net_features) != 0) {
+        return -1;
+    }
+    net_hdr_len = net_dev.version == 2 ? NET_HDR_LEN_MODERN : NET_HDR_LEN_LEGACY;
+
+    if (virtio_queue_setup(&net_dev, &rx_vq, NET_QUEUE_RX, &rx_ring) != 0) return -1;
+    if (virtio_queue_setup(&net_dev, &tx_vq, NET_QUEUE_TX, &tx_ring) != 0) return -1;
+
+    for (uint32_t i = 0; i < RX_BUFFERS; i++) {
+        if (rx_post(i) != 0) return -1;
+    }
+    for (uint32_t i = 0; i < TX_BUFFERS; i++) {
+        tx_busy[i] = 0;
+    }
+
+    virtio_driver_ok(&net_dev);
+    virtq_kick(&net_dev, &rx_vq);
+
+    net_ready = 1;
+    net_enabled = 1;
+    return 0;
+}
+
+void ethernet_init(void) {
+    virtio_net_init();
+}
+
+static int ethernet_driver_init(void) {
+    return virtio_net_init();
+}
+
+DRIVER_DEFINE(ethernet_driver, "ethernet", ethernet_driver_init, BOOT_PATH_NETWORK | BOOT_PATH_DIAG);
+
+// Only a legacy device takes the address through its config space; a
+// modern one keeps its own and, in QEMU, receives promiscuously anyway
+void ethernet_set_mac_address(const uint8_t *mac) {
+    if (!net_ready || net_dev.version != 1) return;
+
+    for (uint32_t i = 0; i < 6; i++) {
+        virtio_config_write8(&net_dev, NET_CONFIG_MAC + i, mac[i]);
+    }
+}
+
+static void tx_reclaim(void) {
+    uint16_t head;
+    uint32_t len;
+
+    while (virtq_get_used(&tx_vq, &head, &len) == 0) {
+        tx_busy[tx_slot[head]] = 0;
+    }
+}
+
+int ethernet_send_frame(const ethernet_frame_t *frame, uint16_t length) {
+    if (!net_ready || !net_enabled || length > NET_BUFFER_SIZE) return -1;
+
+    tx_reclaim();
+
+    uint32_t slot = 0;
+    while (slot < TX_BUFFERS && tx_busy[slot]) slot++;
+    if (slot == TX_BUFFERS) return -1;  // Ring full
+
+    for (uint32_t i = 0; i < net_hdr_len; i++) {
+        tx_headers[slot][i] = 0;
+    }
+    memcpy(tx_buffers[slot], frame, length);
+
+    virtq_buf_t bufs[2] = {
+        { tx_headers[slot], net_hdr_len, 0 },
+        { tx_buffers[slot], length, 0 },
+    };
+    int head = virtq_add(&tx_vq, bufs, 2);
+    if (head < 0) return -1;
+
+    tx_slot[head] = (uint8_t)slot;
+    tx_busy[slot] = 1;
+    virtq_kick(&net_dev, &tx_vq);
+    return 0;
+}
+
+int ethernet_receive_frame(ethernet_frame_t *frame, uint16_t *length) {
+    uint16_t head;
+    uint32_t len;
+
+    if (!net_ready || !net_enabled) return -1;
+    if (virtq_get_used(&rx_vq, &head, &len) != 0) return -1;   // No data
+
+    uint32_t slot = rx_slot[head];
+    int ok = len > net_hdr_len && len - net_hdr_len <= sizeof(ethernet_frame_t);
+
+    if (ok) {
+        *length = (uint16_t)(len - net_hdr_len);
+        memcpy(frame, rx_buffers[slot], *length);
+    }
+
+    // Back to the device, which hears about it once half the ring is waiting
+    rx_post(slot);
+    if (++rx_pending >= RX_REFILL_BATCH) {
+        virtq_kick(&net_dev, &rx_vq);
+        rx_pending = 0;
+    }
+
+    return ok ? 0 : -1;
+}
+
+uint32_t ethernet_get_status(void) {
+    if (!net_ready) return 0;
+
+    // Without the STATUS feature the link is always up
+    if (!(net_features & VIRTIO_NET_F_STATUS)) return ETH_STATUS_LINK_UP;
+
+    uint8_t status = virtio_config_read8(&net_dev, NET_CONFIG_STATUS);
+    return (status & NET_STATUS_LINK_UP) ? ETH_STATUS_LINK_UP : 0;
+}
+
+int ethernet_enable(void) {
+    if (!net_ready) return -1;
+    net_enabled = 1;
+    return 0;
+}
+
+int ethernet_disable(void) {
+    net_enabled = 0;
+    return 0;
+}
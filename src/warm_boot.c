@@ -0,0 +1,169 @@
+/* Warm Reset Detection and Hardware State Hand-Over */
+
+#include <stdint.h>
+#include "warm_boot.h"
+#include "hardware.h"
+#include "platform.h"
+#include "cache.h"
+#include "initcall.h"
+
+#define PM_RSTS_OFFSET      0x20
+
+// PM_RSTS "had reset" flags
+#define PM_RSTS_HADPOR      0x00001000  // Power-on reset
+#define PM_RSTS_HADSR       0x00000700  // Software reset (hard/full/quick)
+#define PM_RSTS_HADWR       0x00000070  // Watchdog reset (hard/full/quick)
+
+#define WARM_MAGIC          0x4D524157  // "WARM"
+
+// Carried across resets; lives in .noinit, which start.S leaves alone and
+// memmap.c keeps from the kernel
+typedef struct {
+    uint32_t magic;
+    uint32_t checksum;              // Over everything after this field
+    uint32_t boot_count;
+    uint32_t sd_rca;                // 0 when no card is known to be selected
+    uint32_t lease_valid;
+    uint8_t  lease_ip[4];
+    uint8_t  lease_netmask[4];
+    uint8_t  lease_gateway[4];
+    uint8_t  lease_server[4];
+    uint64_t resident_base;         // Store of kept images, 0 if none
+    uint64_t resident_size;
+} warm_state_t;
+
+static warm_state_t warm_state __attribute__((section(".noinit"), aligned(64)));
+
+static reset_cause_t reset_cause = RESET_CAUSE_UNKNOWN;
+static int warm;
+
+static uint32_t mmio_read(uint32_t reg) {
+    return *(volatile uint32_t*)(uintptr_t)reg;
+}
+
+static void copy_bytes(void *dest, const void *src, uint32_t n) {
+    uint8_t *d = dest;
+    const uint8_t *s = src;
+    while (n--) *d++ = *s++;
+}
+
+static uint32_t state_checksum(const warm_state_t *state) {
+    const uint8_t *bytes = (const uint8_t *)state + 8;
+    uint32_t sum = 0x811C9DC5;
+
+    // FNV-1a: cheap, and no table needed in the minimal image
+    for (uint32_t i = 0; i < sizeof(warm_state_t) - 8; i++) {
+        sum = (sum ^ bytes[i]) * 0x01000193;
+    }
+    return sum;
+}
+
+// Seal and push to memory: a watchdog reset discards the D-cache
+static void state_commit(void) {
+    warm_state.magic = WARM_MAGIC;
+    warm_state.checksum = state_checksum(&warm_state);
+    dcache_clean_range((uintptr_t)&warm_state, sizeof(warm_state));
+}
+
+static reset_cause_t read_reset_cause(void) {
+    // Only the BCM PM block records why the board reset
+    if (!PLATFORM_HAS_VIDEOCORE) return RESET_CAUSE_UNKNOWN;
+
+    uint32_t rsts = mmio_read(PLATFORM_PM_BASE + PM_RSTS_OFFSET);
+
+    if (rsts & PM_RSTS_HADWR) return RESET_CAUSE_WATCHDOG;
+    if (rsts & PM_RSTS_HADSR) return RESET_CAUSE_SOFTWARE;
+    if (rsts & PM_RSTS_HADPOR) return RESET_CAUSE_POWER_ON;
+    return RESET_CAUSE_UNKNOWN;
+}
+
+int warm_boot_init(void) {
+    reset_cause = read_reset_cause();
+
+    // The record is the real test: if DRAM kept it, what it describes
+    // survived too. Power-on alone means its contents are noise
+    warm = warm_state.magic == WARM_MAGIC &&
+           warm_state.checksum == state_checksum(&warm_state) &&
+           reset_cause != RESET_CAUSE_POWER_ON;
+
+    if (warm) {
+        warm_state.boot_count++;
+    } else {
+        uint8_t *bytes = (uint8_t *)&warm_state;
+        for (uint32_t i = 0; i < sizeof(warm_state); i++) bytes[i] = 0;
+    }
+    state_commit();
+
+    return 0;
+}
+subsys_initcall(warm_boot_init);
+
+int warm_boot_is_warm(void) {
+    return warm;
+}
+
+reset_cause_t warm_boot_reset_cause(void) {
+    return reset_cause;
+}
+
+const char *warm_boot_cause_name(reset_cause_t cause) {
+    switch (cause) {
+        case RESET_CAUSE_POWER_ON: return "power-on";
+        case RESET_CAUSE_WATCHDOG: return "watchdog";
+        case RESET_CAUSE_SOFTWARE: return "software";
+        default:                   return "unknown";
+    }
+}
+
+uint32_t warm_boot_count(void) {
+    return warm_state.boot_count;
+}
+
+int warm_boot_get_sd(uint32_t *rca) {
+    if (!warm || warm_state.sd_rca == 0) return -1;
+    *rca = warm_state.sd_rca;
+    return 0;
+}
+
+void warm_boot_set_sd(uint32_t rca) {
+    warm_state.sd_rca = rca;
+    state_commit();
+}
+
+int warm_boot_get_lease(uint8_t ip[4], uint8_t netmask[4], uint8_t gateway[4], uint8_t server[4]) {
+    if (!warm || !warm_state.lease_valid) return -1;
+
+    copy_bytes(ip, warm_state.lease_ip, 4);
+    copy_bytes(netmask, warm_state.lease_netmask, 4);
+    copy_bytes(gateway, warm_state.lease_gateway, 4);
+    copy_bytes(server, warm_state.lease_server, 4);
+    return 0;
+}
+
+void warm_boot_set_lease(const uint8_t ip[4], const uint8_t netmask[4],
+                         const uint8_t gateway[4], const uint8_t server[4]) {
+    copy_bytes(warm_state.lease_ip, ip, 4);
+    copy_bytes(warm_state.lease_netmask, netmask, 4);
+    copy_bytes(warm_state.lease_gateway, gateway, 4);
+    copy_bytes(warm_state.lease_server, server, 4);
+    warm_state.lease_valid = 1;
+    state_commit();
+}
+
+void warm_boot_clear_lease(void) {
+    warm_state.lease_valid = 0;
+    state_commit();
+}
+
+int warm_boot_get_resident(uint64_t *base, uint64_t *size) {
+    if (!warm || warm_state.resident_size == 0) return -1;
+    *base = warm_state.resident_base;
+    *size = warm_state.resident_size;
+    return 0;
+}
+
+void warm_boot_set_resident(uint64_t base, uint64_t size) {
+    warm_state.resident_base = size ? base : 0;
+    warm_state.resident_size = size;
+    state_commit();
+}
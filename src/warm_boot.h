@@ -0,0 +1,53 @@
+/* Warm Reset Detection and Hardware State Hand-Over */
+
+#ifndef WARM_BOOT_H
+#define WARM_BOOT_H
+
+#include <stdint.h>
+
+/*
+ * After a watchdog or software reset DRAM keeps its contents and the SD
+ * card stays powered, so what the previous boot set up is often still
+ * valid. A small record outside .bss (not zeroed by start.S, not part of
+ * the loaded image) carries it across the reset; drivers try a fast
+ * re-attach from it and fall back to the cold path if that fails.
+ *
+ * The record's page is reserved in the DTB (memmap.c), so it also outlives
+ * a kernel: after Linux reboots, the card address and DHCP lease are still
+ * there. Whether they still hold is another matter, since the kernel
+ * re-initialises the card and may have renewed or released the lease; the
+ * CMD13 check and the DHCP REQUEST catch that. A power cycle loses it all.
+ */
+
+typedef enum {
+    RESET_CAUSE_UNKNOWN = 0,
+    RESET_CAUSE_POWER_ON,
+    RESET_CAUSE_WATCHDOG,           // Includes reboots through the PM watchdog
+    RESET_CAUSE_SOFTWARE
+} reset_cause_t;
+
+// Classify the reset (PM reset status) and validate the carried-over state.
+// Registered as a subsystem initcall (needs the board model for the PM base)
+int warm_boot_init(void);
+
+int warm_boot_is_warm(void);
+reset_cause_t warm_boot_reset_cause(void);
+const char *warm_boot_cause_name(reset_cause_t cause);
+uint32_t warm_boot_count(void);     // Warm boots since the last cold one
+
+// SD card left selected by the previous boot; -1 if unknown. Clear with 0
+int warm_boot_get_sd(uint32_t *rca);
+void warm_boot_set_sd(uint32_t rca);
+
+// DHCP lease of the previous boot; -1 if there is none
+int warm_boot_get_lease(uint8_t ip[4], uint8_t netmask[4], uint8_t gateway[4], uint8_t server[4]);
+void warm_boot_set_lease(const uint8_t ip[4], const uint8_t netmask[4],
+                         const uint8_t gateway[4], const uint8_t server[4]);
+void warm_boot_clear_lease(void);
+
+// Images kept in RAM for the next boot (resident.h); -1 if there are none.
+// A size of 0 forgets them
+int warm_boot_get_resident(uint64_t *base, uint64_t *size);
+void warm_boot_set_resident(uint64_t base, uint64_t size);
+
+#endif
@@ -4,9 +4,10 @@
 #include "timer.h"
 #include "interrupt.h"
 #include "log.h"
+#include "platform.h"
 
-// BCM2711 PM Watchdog registers
-#define PM_BASE         0xFE100000  // Power Management base (Pi 4/5)
+// BCM PM Watchdog registers (platform.h)
+#define PM_BASE         PLATFORM_PM_BASE
 #define PM_RSTC         (PM_BASE + 0x1C)  // Reset Control
 #define PM_RSTS         (PM_BASE + 0x20)  // Reset Status
 #define PM_WDOG         (PM_BASE + 0x24)  // Watchdog